@@ -0,0 +1,217 @@
+#include "arena.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Arena
+////////////////////////////////////////////////////////////////////////////////
+static size_t arena_align(size_t size) {
+	return (size + (ARENA_ALIGNMENT - 1)) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static char *arena_block_data(struct arena_block *block) {
+	return (char *)block + arena_align(sizeof(struct arena_block));
+}
+
+static struct arena_block *arena_block_create(size_t capacity) {
+	struct arena_block *block = malloc(arena_align(sizeof(struct arena_block)) + capacity);
+	assert(block != NULL);
+	
+	block->next = NULL;
+	block->capacity = capacity;
+	block->used = 0;
+	return block;
+}
+
+struct arena arena_create(size_t block_size) {
+	assert(block_size > 0);
+	
+	struct arena arena;
+	arena.first = NULL;
+	arena.current = NULL;
+	arena.block_size = arena_align(block_size);
+	arena.last_allocation = NULL;
+	return arena;
+}
+
+void arena_destroy(struct arena *arena) {
+	assert(arena != NULL);
+	
+	struct arena_block *block = arena->first;
+	while (block != NULL) {
+		struct arena_block *next = block->next;
+		free(block);
+		block = next;
+	}
+	
+	arena->first = NULL;
+	arena->current = NULL;
+	arena->last_allocation = NULL;
+}
+
+// Keeps the blocks for the next use, so a rig streamed in after a reset does
+// not go back to the system allocator.
+void arena_reset(struct arena *arena) {
+	assert(arena != NULL);
+	
+	for (struct arena_block *block = arena->first; block != NULL; block = block->next) {
+		block->used = 0;
+	}
+	
+	arena->current = arena->first;
+	arena->last_allocation = NULL;
+}
+
+void *arena_alloc(struct arena *arena, size_t size) {
+	assert(arena != NULL);
+	
+	size = arena_align(size);
+	
+	struct arena_block *block = arena->current;
+	while ((block != NULL) && (block->used + size > block->capacity)) {
+		block = block->next;
+	}
+	
+	if (block == NULL) {
+		block = arena_block_create(size > arena->block_size ? size : arena->block_size);
+		
+		if (arena->current == NULL) {
+			block->next = arena->first;
+			arena->first = block;
+		} else {
+			block->next = arena->current->next;
+			arena->current->next = block;
+		}
+	}
+	
+	// Blocks skipped over stay partly unused until the next reset.
+	arena->current = block;
+	
+	void *ptr = arena_block_data(block) + block->used;
+	block->used += size;
+	arena->last_allocation = ptr;
+	
+	memset(ptr, 0, size);
+	return ptr;
+}
+
+void *arena_realloc(struct arena *arena, void *ptr, size_t old_size, size_t new_size) {
+	assert(arena != NULL);
+	
+	if (ptr == NULL) {
+		return arena_alloc(arena, new_size);
+	}
+	
+	// The most recent allocation can grow in place while its block has room.
+	if (ptr == arena->last_allocation) {
+		struct arena_block *block = arena->current;
+		size_t offset = (char *)ptr - arena_block_data(block);
+		size_t aligned_size = arena_align(new_size);
+		
+		if (offset + aligned_size <= block->capacity) {
+			size_t old_used = block->used;
+			block->used = offset + aligned_size;
+			if (block->used > old_used) {
+				memset(arena_block_data(block) + old_used, 0, block->used - old_used);
+			}
+			return ptr;
+		}
+	}
+	
+	// Anywhere else a shrink keeps the allocation; the tail is reclaimed on reset.
+	if (new_size <= old_size) {
+		return ptr;
+	}
+	
+	void *new_ptr = arena_alloc(arena, new_size);
+	memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+	return new_ptr;
+}
+
+// Moves every block of `other` into `arena`, which then releases them; `other`
+// is left empty. This is how a part of a rig built on another thread joins the
+// rig's arena. The blocks go after the current one and keep their contents
+// until the next reset.
+void arena_adopt(struct arena *arena, struct arena *other) {
+	assert(arena != NULL);
+	assert(other != NULL);
+	assert(arena != other);
+	
+	if (other->first == NULL) return;
+	
+	struct arena_block *last = other->first;
+	while (last->next != NULL) {
+		last = last->next;
+	}
+	
+	if (arena->current == NULL) {
+		last->next = arena->first;
+		arena->first = other->first;
+	} else {
+		last->next = arena->current->next;
+		arena->current->next = other->first;
+	}
+	
+	other->first = NULL;
+	other->current = NULL;
+	other->last_allocation = NULL;
+}
+
+size_t arena_used(struct arena *arena) {
+	assert(arena != NULL);
+	
+	size_t used = 0;
+	for (struct arena_block *block = arena->first; block != NULL; block = block->next) {
+		used += block->used;
+	}
+	return used;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Memory
+////////////////////////////////////////////////////////////////////////////////
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_THREADS__)
+#define MEMORY_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define MEMORY_THREAD_LOCAL __declspec(thread)
+#else
+#define MEMORY_THREAD_LOCAL __thread
+#endif
+
+static MEMORY_THREAD_LOCAL struct memory_counters *memory_counters_bound = NULL;
+
+struct memory_counters *memory_counters_bind(struct memory_counters *counters) {
+	struct memory_counters *previous = memory_counters_bound;
+	memory_counters_bound = counters;
+	return previous;
+}
+
+void *memory_alloc(struct arena *arena, size_t size) {
+	if (memory_counters_bound != NULL) {
+		memory_counters_bound->allocations++;
+		memory_counters_bound->bytes += (long)size;
+	}
+	
+	if (arena != NULL) {
+		return arena_alloc(arena, size);
+	}
+	
+	return calloc(1, size);
+}
+
+void *memory_realloc(struct arena *arena, void *ptr, size_t old_size, size_t new_size) {
+	if ((memory_counters_bound != NULL) && (new_size > old_size)) {
+		memory_counters_bound->allocations++;
+		memory_counters_bound->bytes += (long)(new_size - old_size);
+	}
+	
+	if (arena != NULL) {
+		return arena_realloc(arena, ptr, old_size, new_size);
+	}
+	
+	return realloc(ptr, new_size);
+}
+
+void memory_free(struct arena *arena, void *ptr) {
+	if (arena != NULL) return;
+	
+	free(ptr);
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Arena
+////////////////////////////////////////////////////////////////////////////////
+#define ARENA_ALIGNMENT 16
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+struct arena_block {
+	struct arena_block *next;
+	size_t capacity;
+	size_t used;
+};
+
+struct arena {
+	struct arena_block *first;
+	struct arena_block *current;
+	size_t block_size;
+	void *last_allocation; // may be grown in place by arena_realloc
+};
+
+struct arena arena_create(size_t block_size);
+void arena_destroy(struct arena *arena);
+void arena_reset(struct arena *arena);
+void *arena_alloc(struct arena *arena, size_t size);
+void *arena_realloc(struct arena *arena, void *ptr, size_t old_size, size_t new_size);
+void arena_adopt(struct arena *arena, struct arena *other);
+size_t arena_used(struct arena *arena);
+
+////////////////////////////////////////////////////////////////////////////////
+// Memory
+////////////////////////////////////////////////////////////////////////////////
+// Tags, lists and strings are allocated through these. A NULL arena means the
+// heap; memory taken from an arena is released by resetting the arena.
+//
+// While a thread has memory_counters bound, its memory_alloc and
+// memory_realloc calls are counted there. Binding returns the previous
+// counters so that it can be restored.
+struct memory_counters {
+	long allocations;
+	long bytes;
+};
+
+struct memory_counters *memory_counters_bind(struct memory_counters *counters);
+void *memory_alloc(struct arena *arena, size_t size);
+void *memory_realloc(struct arena *arena, void *ptr, size_t old_size, size_t new_size);
+void memory_free(struct arena *arena, void *ptr);
\ No newline at end of file
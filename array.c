@@ -0,0 +1,50 @@
+#include "array.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Array
+////////////////////////////////////////////////////////////////////////////////
+void *array_reserve(void *items, int length, int *capacity, int needed, size_t item_size, struct arena *arena) {
+	assert(capacity != NULL);
+	assert(length >= 0);
+	assert(length <= *capacity);
+	
+	if (needed <= *capacity) return items;
+	
+	int new_capacity = (*capacity < ARRAY_MIN_CAPACITY) ? ARRAY_MIN_CAPACITY : *capacity;
+	while (new_capacity < needed) {
+		new_capacity *= 2;
+	}
+	
+	items = memory_realloc(arena, items, (size_t)*capacity * item_size, (size_t)new_capacity * item_size);
+	assert(items != NULL);
+	
+	*capacity = new_capacity;
+	return items;
+}
+
+void *array_grow(void *items, int length, int *capacity, size_t item_size, struct arena *arena) {
+	assert(capacity != NULL);
+	
+	if (length < *capacity) return items;
+	
+	return array_reserve(items, length, capacity, length + 1, item_size, arena);
+}
+
+void *array_shrink_to_fit(void *items, int length, int *capacity, size_t item_size, struct arena *arena) {
+	assert(capacity != NULL);
+	assert(length <= *capacity);
+	
+	if (length == *capacity) return items;
+	
+	if (length == 0) {
+		memory_free(arena, items);
+		*capacity = 0;
+		return NULL;
+	}
+	
+	items = memory_realloc(arena, items, (size_t)*capacity * item_size, (size_t)length * item_size);
+	assert(items != NULL);
+	
+	*capacity = length;
+	return items;
+}
\ No newline at end of file
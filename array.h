@@ -0,0 +1,21 @@
+#pragma once
+
+#include "arena.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Array
+////////////////////////////////////////////////////////////////////////////////
+// Storage behind every *_list. Lists keep their own typed `items` pointer,
+// length and capacity and hand them to these; the returned pointer replaces
+// `items`. Capacity doubles, so appending n items copies O(n) in total.
+#define ARRAY_MIN_CAPACITY 4
+
+void *array_reserve(void *items, int length, int *capacity, int needed, size_t item_size, struct arena *arena);
+void *array_grow(void *items, int length, int *capacity, size_t item_size, struct arena *arena);
+void *array_shrink_to_fit(void *items, int length, int *capacity, size_t item_size, struct arena *arena);
\ No newline at end of file
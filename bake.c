@@ -0,0 +1,1345 @@
+#include "bake.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 							Baked animations
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Baked animation
+////////////////////////////////////////////////////////////////////////////////
+static struct baked_ref baked_ref_create(int parent, int timeline, int key, int z_index) {
+	struct baked_ref baked_ref;
+	baked_ref.parent = parent;
+	baked_ref.timeline = timeline;
+	baked_ref.key = key;
+	baked_ref.z_index = z_index;
+	return baked_ref;
+}
+
+static void baked_animation_set_channels(struct baked_animation *baked_animation, int key, float x, float y, float angle, float scale_x, float scale_y, float a) {
+	baked_animation->channels[transform_channel_x][key] = x;
+	baked_animation->channels[transform_channel_y][key] = y;
+	baked_animation->channels[transform_channel_angle][key] = angle;
+	baked_animation->channels[transform_channel_scale_x][key] = scale_x;
+	baked_animation->channels[transform_channel_scale_y][key] = scale_y;
+	baked_animation->channels[transform_channel_a][key] = a;
+}
+
+// Same rule as the tree sampler: the last key of a looping animation blends
+// into the first one at the end of the animation, and a key that does not move
+// forward in time holds.
+static void baked_animation_link_keys(struct baked_animation *baked_animation, int timeline) {
+	int first = baked_animation->timeline_keys[timeline];
+	int end = baked_animation->timeline_keys[timeline + 1];
+	
+	for (int key = first; key < end; key++) {
+		int next = key + 1;
+		float next_time = 0.0f;
+		
+		if (next < end) {
+			next_time = (float)baked_animation->key_times[next];
+		} else if (!baked_animation->looping) {
+			next = key;
+		} else {
+			next = first;
+			next_time = (float)(baked_animation->length + baked_animation->key_times[first]);
+		}
+		
+		float duration = next_time - (float)baked_animation->key_times[key];
+		if ((next == key) || (duration <= 0.0f)) {
+			next = key;
+			duration = 0.0f;
+		}
+		
+		baked_animation->key_next[key] = next;
+		baked_animation->key_durations[key] = duration;
+	}
+}
+
+struct baked_animation baked_animation_create(struct animation *animation, struct arena *arena) {
+	assert(animation != NULL);
+	
+	struct baked_animation baked_animation;
+	baked_animation.length = animation->length;
+	baked_animation.looping = animation->looping;
+	baked_animation.arena = arena;
+	
+	struct timeline_list *timelines = &animation->timeline_list;
+	struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+	
+	baked_animation.timeline_count = timelines->length;
+	baked_animation.key_count = 0;
+	for (int i = 0; i < timelines->length; i++) {
+		baked_animation.key_count += timelines->items[i].timeline_key_list.length;
+	}
+	
+	baked_animation.mainline_key_count = mainline_keys->length;
+	baked_animation.bone_ref_count = 0;
+	baked_animation.object_ref_count = 0;
+	for (int i = 0; i < mainline_keys->length; i++) {
+		baked_animation.bone_ref_count += mainline_keys->items[i].bone_ref_list.length;
+		baked_animation.object_ref_count += mainline_keys->items[i].object_ref_list.length;
+	}
+	
+	int key_count = baked_animation.key_count;
+	baked_animation.timeline_keys = memory_alloc(arena, sizeof(int) * (baked_animation.timeline_count + 1));
+	baked_animation.key_times = memory_alloc(arena, sizeof(int) * key_count);
+	baked_animation.key_spins = memory_alloc(arena, sizeof(int) * key_count);
+	baked_animation.key_next = memory_alloc(arena, sizeof(int) * key_count);
+	baked_animation.key_durations = memory_alloc(arena, sizeof(float) * key_count);
+	baked_animation.key_folders = memory_alloc(arena, sizeof(int) * key_count);
+	baked_animation.key_files = memory_alloc(arena, sizeof(int) * key_count);
+	for (int c = 0; c < transform_channel_count; c++) {
+		baked_animation.channels[c] = memory_alloc(arena, sizeof(float) * key_count);
+	}
+	
+	baked_animation.mainline_times = memory_alloc(arena, sizeof(int) * baked_animation.mainline_key_count);
+	baked_animation.mainline_bone_refs = memory_alloc(arena, sizeof(int) * (baked_animation.mainline_key_count + 1));
+	baked_animation.mainline_object_refs = memory_alloc(arena, sizeof(int) * (baked_animation.mainline_key_count + 1));
+	baked_animation.bone_refs = memory_alloc(arena, sizeof(struct baked_ref) * baked_animation.bone_ref_count);
+	baked_animation.object_refs = memory_alloc(arena, sizeof(struct baked_ref) * baked_animation.object_ref_count);
+	
+	int key = 0;
+	for (int i = 0; i < timelines->length; i++) {
+		struct timeline_key_list *timeline_keys = &timelines->items[i].timeline_key_list;
+		baked_animation.timeline_keys[i] = key;
+		
+		for (int j = 0; j < timeline_keys->length; j++, key++) {
+			struct timeline_key *timeline_key = &timeline_keys->items[j];
+			baked_animation.key_times[key] = timeline_key->time;
+			baked_animation.key_spins[key] = timeline_key->spin;
+			baked_animation.key_folders[key] = -1;
+			baked_animation.key_files[key] = -1;
+			
+			if (timeline_key->bone_list.length > 0) {
+				struct bone *bone = &timeline_key->bone_list.items[0];
+				baked_animation_set_channels(&baked_animation, key, bone->x, bone->y, bone->angle, bone->scale_x, bone->scale_y, bone->a);
+			} else if (timeline_key->object_list.length > 0) {
+				struct object *object = &timeline_key->object_list.items[0];
+				baked_animation_set_channels(&baked_animation, key, object->x, object->y, object->angle, object->scale_x, object->scale_y, object->a);
+				baked_animation.key_folders[key] = object->folder;
+				baked_animation.key_files[key] = object->file;
+			} else {
+				baked_animation_set_channels(&baked_animation, key, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+			}
+		}
+	}
+	baked_animation.timeline_keys[timelines->length] = key;
+	
+	for (int i = 0; i < timelines->length; i++) {
+		baked_animation_link_keys(&baked_animation, i);
+	}
+	
+	int bone_ref = 0;
+	int object_ref = 0;
+	for (int i = 0; i < mainline_keys->length; i++) {
+		struct mainline_key *mainline_key = &mainline_keys->items[i];
+		baked_animation.mainline_times[i] = mainline_key->time;
+		baked_animation.mainline_bone_refs[i] = bone_ref;
+		baked_animation.mainline_object_refs[i] = object_ref;
+		
+		for (int j = 0; j < mainline_key->bone_ref_list.length; j++) {
+			struct bone_ref *ref = &mainline_key->bone_ref_list.items[mainline_key_bone_ref_at(mainline_key, j)];
+			assert((ref->timeline >= 0) && (ref->timeline < timelines->length));
+			assert((ref->key >= 0) && (ref->key < timelines->items[ref->timeline].timeline_key_list.length));
+			
+			int first_key = baked_animation.timeline_keys[ref->timeline];
+			baked_animation.bone_refs[bone_ref++] = baked_ref_create(mainline_key_bone_parent(mainline_key, j), ref->timeline, first_key + ref->key, 0);
+		}
+		
+		for (int j = 0; j < mainline_key->object_ref_list.length; j++) {
+			struct object_ref *ref = &mainline_key->object_ref_list.items[j];
+			assert((ref->timeline >= 0) && (ref->timeline < timelines->length));
+			assert((ref->key >= 0) && (ref->key < timelines->items[ref->timeline].timeline_key_list.length));
+			
+			int first_key = baked_animation.timeline_keys[ref->timeline];
+			baked_animation.object_refs[object_ref++] = baked_ref_create(mainline_key_object_parent(mainline_key, j), ref->timeline, first_key + ref->key, ref->z_index);
+		}
+	}
+	baked_animation.mainline_bone_refs[mainline_keys->length] = bone_ref;
+	baked_animation.mainline_object_refs[mainline_keys->length] = object_ref;
+	
+	return baked_animation;
+}
+
+void baked_animation_destroy(struct baked_animation *baked_animation) {
+	assert(baked_animation != NULL);
+	
+	if (baked_animation->arena != NULL) return; // released with the arena
+	
+	struct arena *arena = baked_animation->arena;
+	memory_free(arena, baked_animation->timeline_keys);
+	memory_free(arena, baked_animation->key_times);
+	memory_free(arena, baked_animation->key_spins);
+	memory_free(arena, baked_animation->key_next);
+	memory_free(arena, baked_animation->key_durations);
+	memory_free(arena, baked_animation->key_folders);
+	memory_free(arena, baked_animation->key_files);
+	for (int c = 0; c < transform_channel_count; c++) {
+		memory_free(arena, baked_animation->channels[c]);
+	}
+	memory_free(arena, baked_animation->mainline_times);
+	memory_free(arena, baked_animation->mainline_bone_refs);
+	memory_free(arena, baked_animation->mainline_object_refs);
+	memory_free(arena, baked_animation->bone_refs);
+	memory_free(arena, baked_animation->object_refs);
+}
+
+static float baked_animation_wrap_time(struct baked_animation *baked_animation, float time) {
+	if (baked_animation->length <= 0) return 0.0f;
+	
+	float length = (float)baked_animation->length;
+	if (!baked_animation->looping) {
+		if (time < 0.0f) return 0.0f;
+		if (time > length) return length;
+		return time;
+	}
+	
+	time = fmodf(time, length);
+	if (time < 0.0f) time += length;
+	return time;
+}
+
+// Index of the last mainline key in [first, mainline_key_count) at or before
+// `time`, or `first` when there is none.
+static int baked_animation_search_mainline_keys(struct baked_animation *baked_animation, int first, float time) {
+	int low = first + 1;
+	int high = baked_animation->mainline_key_count;
+	
+	while (low < high) {
+		int middle = low + (high - low) / 2;
+		if ((float)baked_animation->mainline_times[middle] > time) {
+			high = middle;
+		} else {
+			low = middle + 1;
+		}
+	}
+	
+	return low - 1;
+}
+
+// Index of the last mainline key at or before `time`, which must already be
+// wrapped.
+int baked_animation_find_mainline_key(struct baked_animation *baked_animation, float time) {
+	assert(baked_animation != NULL);
+	
+	return baked_animation_search_mainline_keys(baked_animation, 0, time);
+}
+
+// Same walk as animation_cursor_find_mainline_key.
+int baked_animation_cursor_find_mainline_key(struct animation_cursor *cursor, struct baked_animation *baked_animation, float time) {
+	assert(cursor != NULL);
+	assert(baked_animation != NULL);
+	
+	int *mainline_times = baked_animation->mainline_times;
+	int found = cursor->mainline_key;
+	
+	if ((found < 0) || (found >= baked_animation->mainline_key_count) || ((float)mainline_times[found] > time)) {
+		found = baked_animation_search_mainline_keys(baked_animation, 0, time);
+	} else {
+		int steps = 0;
+		while ((found + 1 < baked_animation->mainline_key_count) && ((float)mainline_times[found + 1] <= time)) {
+			if (++steps > ANIMATION_CURSOR_STEPS) {
+				found = baked_animation_search_mainline_keys(baked_animation, found, time);
+				break;
+			}
+			found++;
+		}
+	}
+	
+	cursor->mainline_key = found;
+	return found;
+}
+
+static struct transform baked_animation_sample_key(struct baked_animation *baked_animation, int key, float time) {
+	int next = baked_animation->key_next[key];
+	float duration = baked_animation->key_durations[key];
+	
+	float t = 0.0f;
+	if (duration > 0.0f) {
+		t = (time - (float)baked_animation->key_times[key]) / duration;
+		if (t < 0.0f) t = 0.0f;
+		if (t > 1.0f) t = 1.0f;
+	}
+	
+	float **channels = baked_animation->channels;
+	struct transform from = transform_create(channels[transform_channel_x][key], channels[transform_channel_y][key],
+		channels[transform_channel_angle][key], channels[transform_channel_scale_x][key],
+		channels[transform_channel_scale_y][key], channels[transform_channel_a][key]);
+	struct transform to = transform_create(channels[transform_channel_x][next], channels[transform_channel_y][next],
+		channels[transform_channel_angle][next], channels[transform_channel_scale_x][next],
+		channels[transform_channel_scale_y][next], channels[transform_channel_a][next]);
+	
+	return transform_lerp(from, to, t, baked_animation->key_spins[key]);
+}
+
+// `time` is already wrapped and `mainline_key` is active at it.
+static void baked_animation_sample_mainline_key(struct baked_animation *baked_animation, int mainline_key, float time, struct pose *pose) {
+	int first_bone = baked_animation->mainline_bone_refs[mainline_key];
+	int bone_count = baked_animation->mainline_bone_refs[mainline_key + 1] - first_bone;
+	int first_object = baked_animation->mainline_object_refs[mainline_key];
+	int object_count = baked_animation->mainline_object_refs[mainline_key + 1] - first_object;
+	
+	assert(bone_count <= pose->bone_capacity);
+	assert(object_count <= pose->object_capacity);
+	
+	for (int i = 0; i < bone_count; i++) {
+		struct baked_ref *ref = &baked_animation->bone_refs[first_bone + i];
+		
+		struct pose_bone *bone = &pose->bones[i];
+		bone->local = baked_animation_sample_key(baked_animation, ref->key, time);
+		bone->parent = ref->parent;
+		bone->timeline = ref->timeline;
+	}
+	pose->bone_count = bone_count;
+	
+	for (int i = 0; i < object_count; i++) {
+		struct baked_ref *ref = &baked_animation->object_refs[first_object + i];
+		
+		struct pose_object *object = &pose->objects[i];
+		object->local = baked_animation_sample_key(baked_animation, ref->key, time);
+		object->parent = ref->parent;
+		object->timeline = ref->timeline;
+		object->folder = baked_animation->key_folders[ref->key];
+		object->file = baked_animation->key_files[ref->key];
+		object->z_index = ref->z_index;
+	}
+	pose->object_count = object_count;
+}
+
+// Produces the same pose as animation_sample_pose on the animation it was
+// baked from.
+void baked_animation_sample_pose(struct baked_animation *baked_animation, float time, struct pose *pose) {
+	assert(baked_animation != NULL);
+	assert(pose != NULL);
+	
+	pose->bone_count = 0;
+	pose->object_count = 0;
+	
+	if (baked_animation->mainline_key_count == 0) return;
+	
+	time = baked_animation_wrap_time(baked_animation, time);
+	baked_animation_sample_mainline_key(baked_animation, baked_animation_find_mainline_key(baked_animation, time), time, pose);
+}
+
+void baked_animation_sample_pose_with_cursor(struct baked_animation *baked_animation, float time, struct animation_cursor *cursor, struct pose *pose) {
+	assert(baked_animation != NULL);
+	assert(cursor != NULL);
+	assert(pose != NULL);
+	
+	pose->bone_count = 0;
+	pose->object_count = 0;
+	
+	if (baked_animation->mainline_key_count == 0) return;
+	
+	time = baked_animation_wrap_time(baked_animation, time);
+	int mainline_key = baked_animation_cursor_find_mainline_key(cursor, baked_animation, time);
+	baked_animation_sample_mainline_key(baked_animation, mainline_key, time, pose);
+}
+
+// Samples the bones of `count` instances, instance i at times[i], into a
+// pose_batch. Each row is filled block by block: the keys, blend and spin of
+// each lane are resolved from the mainline refs, then the block is
+// interpolated straight from the channel arrays. Instances whose mainline key has fewer
+// bones than the largest one get identity transforms with parent -1 in the
+// missing rows. Gives the same transforms as baked_animation_sample_pose.
+void baked_animation_sample_batch(struct baked_animation *baked_animation, const float *times, int count, struct pose_batch *batch) {
+	assert(baked_animation != NULL);
+	assert(batch != NULL);
+	assert(count <= batch->instance_capacity);
+	
+	batch->instance_count = count;
+	batch->bone_count = 0;
+	if (baked_animation->mainline_key_count == 0) return;
+	
+	int *mainline_bone_refs = baked_animation->mainline_bone_refs;
+	for (int i = 0; i < baked_animation->mainline_key_count; i++) {
+		int bone_count = mainline_bone_refs[i + 1] - mainline_bone_refs[i];
+		if (bone_count > batch->bone_count) batch->bone_count = bone_count;
+	}
+	assert(batch->bone_count <= batch->bone_capacity);
+	
+	for (int i = 0; i < count; i++) {
+		batch->times[i] = baked_animation_wrap_time(baked_animation, times[i]);
+		batch->mainline_keys[i] = baked_animation_find_mainline_key(baked_animation, batch->times[i]);
+	}
+	
+	// Locals rather than fields, so the stores into the batch do not force
+	// the compiler to reload them for every lane.
+	struct baked_ref *bone_refs = baked_animation->bone_refs;
+	int *key_times = baked_animation->key_times;
+	int *key_spins = baked_animation->key_spins;
+	int *key_next = baked_animation->key_next;
+	float *key_durations = baked_animation->key_durations;
+	int *keys = batch->keys;
+	int *next_keys = batch->next_keys;
+	float *blends = batch->t;
+	float *spins = batch->spin;
+	int *parents = batch->parents;
+	float *lane_times = batch->times;
+	int *mainline_keys = batch->mainline_keys;
+	int bone_count = batch->bone_count;
+	int stride = batch->stride;
+	
+	struct transform identity = transform_create(0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+	
+	// Row by row, so each row is written front to back; rows are a stride
+	// apart and walking down them block by block thrashes the cache.
+	for (int b = 0; b < bone_count; b++) {
+		for (int start = 0; start < count; start += POSE_BATCH_BLOCK) {
+			int end = start + POSE_BATCH_BLOCK;
+			if (end > count) end = count;
+			int lane_count = end - start;
+			int row = b * stride + start;
+			bool missing = false;
+			
+			for (int lane = 0; lane < lane_count; lane++) {
+				int mainline_key = mainline_keys[start + lane];
+				int ref_index = mainline_bone_refs[mainline_key] + b;
+				
+				if (ref_index >= mainline_bone_refs[mainline_key + 1]) {
+					keys[lane] = 0; // any valid key, overwritten below
+					next_keys[lane] = 0;
+					blends[lane] = 0.0f;
+					spins[lane] = 0.0f;
+					parents[row + lane] = -1;
+					missing = true;
+					continue;
+				}
+				
+				struct baked_ref *ref = &bone_refs[ref_index];
+				int key = ref->key;
+				float duration = key_durations[key];
+				
+				float t = 0.0f;
+				if (duration > 0.0f) {
+					t = (lane_times[start + lane] - (float)key_times[key]) / duration;
+					if (t < 0.0f) t = 0.0f;
+					if (t > 1.0f) t = 1.0f;
+				}
+				
+				keys[lane] = key;
+				next_keys[lane] = key_next[key];
+				blends[lane] = t;
+				spins[lane] = (float)key_spins[key];
+				parents[row + lane] = ref->parent;
+			}
+			
+			pose_batch_interpolate(batch, baked_animation->channels, row, lane_count);
+			
+			if (!missing) continue;
+			for (int lane = 0; lane < lane_count; lane++) {
+				int mainline_key = mainline_keys[start + lane];
+				if (mainline_bone_refs[mainline_key] + b < mainline_bone_refs[mainline_key + 1]) continue;
+				
+				batch->channels[transform_channel_x][row + lane] = identity.x;
+				batch->channels[transform_channel_y][row + lane] = identity.y;
+				batch->channels[transform_channel_angle][row + lane] = identity.angle;
+				batch->channels[transform_channel_scale_x][row + lane] = identity.scale_x;
+				batch->channels[transform_channel_scale_y][row + lane] = identity.scale_y;
+				batch->channels[transform_channel_a][row + lane] = identity.a;
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Baked data
+////////////////////////////////////////////////////////////////////////////////
+// Bakes every animation of every entity. The spriter_data is only read and
+// can be destroyed afterwards.
+struct baked_data baked_data_create(struct spriter_data *spriter_data, struct arena *arena) {
+	assert(spriter_data != NULL);
+	
+	struct baked_data baked_data;
+	baked_data.entity_count = spriter_data->entity_list.length;
+	baked_data.entities = memory_alloc(arena, sizeof(struct baked_entity) * baked_data.entity_count);
+	baked_data.arena = arena;
+	
+	for (int i = 0; i < baked_data.entity_count; i++) {
+		struct entity *entity = &spriter_data->entity_list.items[i];
+		struct baked_entity *baked_entity = &baked_data.entities[i];
+		
+		baked_entity->animation_count = entity->animation_list.length;
+		baked_entity->animations = memory_alloc(arena, sizeof(struct baked_animation) * baked_entity->animation_count);
+		baked_entity->bone_capacity = 0;
+		baked_entity->object_capacity = 0;
+		
+		for (int j = 0; j < baked_entity->animation_count; j++) {
+			struct baked_animation *baked_animation = &baked_entity->animations[j];
+			*baked_animation = baked_animation_create(&entity->animation_list.items[j], arena);
+			
+			for (int k = 0; k < baked_animation->mainline_key_count; k++) {
+				int bone_count = baked_animation->mainline_bone_refs[k + 1] - baked_animation->mainline_bone_refs[k];
+				int object_count = baked_animation->mainline_object_refs[k + 1] - baked_animation->mainline_object_refs[k];
+				if (bone_count > baked_entity->bone_capacity) baked_entity->bone_capacity = bone_count;
+				if (object_count > baked_entity->object_capacity) baked_entity->object_capacity = object_count;
+			}
+		}
+	}
+	
+	return baked_data;
+}
+
+void baked_data_destroy(struct baked_data *baked_data) {
+	assert(baked_data != NULL);
+	
+	if (baked_data->arena != NULL) return; // released with the arena
+	
+	for (int i = 0; i < baked_data->entity_count; i++) {
+		struct baked_entity *baked_entity = &baked_data->entities[i];
+		
+		for (int j = 0; j < baked_entity->animation_count; j++) {
+			baked_animation_destroy(&baked_entity->animations[j]);
+		}
+		memory_free(baked_data->arena, baked_entity->animations);
+	}
+	memory_free(baked_data->arena, baked_data->entities);
+}
+
+size_t baked_data_memory(struct baked_data *baked_data) {
+	assert(baked_data != NULL);
+	
+	size_t memory = sizeof(struct baked_entity) * baked_data->entity_count;
+	for (int i = 0; i < baked_data->entity_count; i++) {
+		struct baked_entity *baked_entity = &baked_data->entities[i];
+		memory += sizeof(struct baked_animation) * baked_entity->animation_count;
+		
+		for (int j = 0; j < baked_entity->animation_count; j++) {
+			struct baked_animation *baked_animation = &baked_entity->animations[j];
+			memory += sizeof(int) * (baked_animation->timeline_count + 1);
+			memory += (sizeof(int) * 5 + sizeof(float) * (1 + transform_channel_count)) * baked_animation->key_count;
+			memory += sizeof(int) * (3 * baked_animation->mainline_key_count + 2);
+			memory += sizeof(struct baked_ref) * (baked_animation->bone_ref_count + baked_animation->object_ref_count);
+		}
+	}
+	
+	return memory;
+}
+
+void baked_entity_sample_pose(struct baked_entity *baked_entity, int animation_index, float time, struct pose *pose) {
+	assert(baked_entity != NULL);
+	assert(animation_index >= 0);
+	assert(animation_index < baked_entity->animation_count);
+	
+	baked_animation_sample_pose(&baked_entity->animations[animation_index], time, pose);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Pose table
+////////////////////////////////////////////////////////////////////////////////
+// Frames of a looping animation cover [0, length) and the last one blends into
+// the first; the others get one more frame at `length` itself to hold.
+static int pose_table_frame_count(struct animation *animation, float frame_interval) {
+	if (animation->length <= 0) return 1;
+	
+	int frame_count = (int)ceilf((float)animation->length / frame_interval);
+	if (frame_count < 1) frame_count = 1;
+	return animation->looping ? frame_count : frame_count + 1;
+}
+
+static float pose_table_frame_time(struct pose_table *pose_table, int frame) {
+	float time = (float)frame * pose_table->frame_interval;
+	return (time > (float)pose_table->length) ? (float)pose_table->length : time;
+}
+
+// Wraps and clamps `time` like animation_sample_pose and returns the frame at
+// or before it. With `blends`, `t` is how far `time` is towards the next
+// frame, or 0 when the frame does not blend.
+static int pose_table_find_frame(int length, bool looping, float frame_interval, int frame_count, const bool *blends, float time, float *t) {
+	float end = (float)length;
+	if (end <= 0.0f) {
+		time = 0.0f;
+	} else if (looping) {
+		time = fmodf(time, end);
+		if (time < 0.0f) time += end;
+	} else {
+		if (time < 0.0f) time = 0.0f;
+		if (time > end) time = end;
+	}
+	
+	// A time computed as f * frame_interval must land on frame f, not just
+	// short of it.
+	int frame = (int)(time / frame_interval + 1e-4f);
+	if (frame > frame_count - 1) frame = frame_count - 1;
+	
+	*t = 0.0f;
+	if ((blends != NULL) && blends[frame]) {
+		float frame_time = (float)frame * frame_interval;
+		float next_time = (frame + 1 < frame_count) ? (float)(frame + 1) * frame_interval : end;
+		if (next_time > end) next_time = end;
+		
+		*t = (time - frame_time) / (next_time - frame_time);
+		if (*t < 0.0f) *t = 0.0f;
+	}
+	
+	return frame;
+}
+
+static float pose_table_resolve_interval(struct animation *animation, float frame_interval) {
+	if (frame_interval <= 0.0f) frame_interval = (float)animation->interval;
+	assert(frame_interval > 0.0f);
+	return frame_interval;
+}
+
+static void pose_table_capacities(struct animation *animation, int *bone_capacity, int *object_capacity) {
+	struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+	*bone_capacity = 0;
+	*object_capacity = 0;
+	
+	for (int i = 0; i < mainline_keys->length; i++) {
+		struct mainline_key *mainline_key = &mainline_keys->items[i];
+		if (mainline_key->bone_ref_list.length > *bone_capacity) *bone_capacity = mainline_key->bone_ref_list.length;
+		if (mainline_key->object_ref_list.length > *object_capacity) *object_capacity = mainline_key->object_ref_list.length;
+	}
+}
+
+// Bytes pose_table_create will allocate for the same arguments. A frame
+// interval of 0 or less means the animation's own interval.
+size_t pose_table_memory(struct animation *animation, float frame_interval) {
+	assert(animation != NULL);
+	
+	frame_interval = pose_table_resolve_interval(animation, frame_interval);
+	
+	int bone_capacity = 0;
+	int object_capacity = 0;
+	pose_table_capacities(animation, &bone_capacity, &object_capacity);
+	
+	size_t frame = sizeof(int) * 2 + sizeof(bool) + sizeof(struct pose_table_bone) * bone_capacity + sizeof(struct pose_table_object) * object_capacity;
+	return frame * pose_table_frame_count(animation, frame_interval);
+}
+
+// Two frames blend only when they hold the same bones and objects; across a
+// change of mainline key the earlier frame is held instead.
+static bool pose_table_frames_match(struct pose_table *pose_table, int frame, int next) {
+	if (pose_table->bone_counts[frame] != pose_table->bone_counts[next]) return false;
+	if (pose_table->object_counts[frame] != pose_table->object_counts[next]) return false;
+	
+	struct pose_table_bone *bones = &pose_table->bones[frame * pose_table->bone_capacity];
+	struct pose_table_bone *next_bones = &pose_table->bones[next * pose_table->bone_capacity];
+	for (int i = 0; i < pose_table->bone_counts[frame]; i++) {
+		if ((bones[i].timeline != next_bones[i].timeline) || (bones[i].parent != next_bones[i].parent)) return false;
+	}
+	
+	struct pose_table_object *objects = &pose_table->objects[frame * pose_table->object_capacity];
+	struct pose_table_object *next_objects = &pose_table->objects[next * pose_table->object_capacity];
+	for (int i = 0; i < pose_table->object_counts[frame]; i++) {
+		if (objects[i].timeline != next_objects[i].timeline) return false;
+	}
+	
+	return true;
+}
+
+static float pose_table_angle_distance(float a, float b) {
+	float distance = fmodf(fabsf(a - b), 360.0f);
+	return (distance > 180.0f) ? 360.0f - distance : distance;
+}
+
+// Of the two ways from `from` to `to`, the one that passes closest to the
+// angle sampled halfway between the frames.
+static float pose_table_turn(float from, float to, float middle) {
+	float counter_clockwise = fmodf(to - from, 360.0f);
+	if (counter_clockwise < 0.0f) counter_clockwise += 360.0f;
+	if (counter_clockwise == 0.0f) return 0.0f;
+	
+	float clockwise = counter_clockwise - 360.0f;
+	float counter_clockwise_error = pose_table_angle_distance(from + counter_clockwise * 0.5f, middle);
+	float clockwise_error = pose_table_angle_distance(from + clockwise * 0.5f, middle);
+	return (counter_clockwise_error <= clockwise_error) ? counter_clockwise : clockwise;
+}
+
+// Decides for each frame whether it blends into the next one and which way
+// its angles turn, sampling the animation halfway between the two.
+static void pose_table_link_frames(struct pose_table *pose_table, struct pose *middle) {
+	for (int f = 0; f < pose_table->frame_count; f++) {
+		float time = pose_table_frame_time(pose_table, f);
+		int next = f + 1;
+		float next_time = 0.0f;
+		
+		if (next < pose_table->frame_count) {
+			next_time = pose_table_frame_time(pose_table, next);
+		} else if (pose_table->looping) {
+			next = 0;
+			next_time = (float)pose_table->length;
+		} else {
+			next = f;
+		}
+		
+		pose_table->blends[f] = (next != f) && (next_time > time) && pose_table_frames_match(pose_table, f, next);
+		if (!pose_table->blends[f]) continue;
+		
+		animation_sample_pose(pose_table->animation, (time + next_time) * 0.5f, middle);
+		bool middle_matches = (middle->bone_count == pose_table->bone_counts[f]) && (middle->object_count == pose_table->object_counts[f]);
+		
+		struct pose_table_bone *bones = &pose_table->bones[f * pose_table->bone_capacity];
+		struct pose_table_bone *next_bones = &pose_table->bones[next * pose_table->bone_capacity];
+		for (int i = 0; i < pose_table->bone_counts[f]; i++) {
+			float from = bones[i].local.angle;
+			float to = next_bones[i].local.angle;
+			bool same = middle_matches && (middle->bones[i].timeline == bones[i].timeline);
+			bones[i].turn = pose_table_turn(from, to, same ? middle->bones[i].local.angle : from);
+		}
+		
+		struct pose_table_object *objects = &pose_table->objects[f * pose_table->object_capacity];
+		struct pose_table_object *next_objects = &pose_table->objects[next * pose_table->object_capacity];
+		for (int i = 0; i < pose_table->object_counts[f]; i++) {
+			float from = objects[i].local.angle;
+			float to = next_objects[i].local.angle;
+			bool same = middle_matches && (middle->objects[i].timeline == objects[i].timeline);
+			objects[i].turn = pose_table_turn(from, to, same ? middle->objects[i].local.angle : from);
+		}
+	}
+}
+
+struct pose_table pose_table_create(struct animation *animation, float frame_interval, struct arena *arena) {
+	assert(animation != NULL);
+	
+	struct pose_table pose_table;
+	pose_table.animation = animation;
+	pose_table.length = animation->length;
+	pose_table.looping = animation->looping;
+	pose_table.frame_interval = pose_table_resolve_interval(animation, frame_interval);
+	pose_table.frame_count = pose_table_frame_count(animation, pose_table.frame_interval);
+	pose_table.arena = arena;
+	
+	pose_table_capacities(animation, &pose_table.bone_capacity, &pose_table.object_capacity);
+	
+	int frame_count = pose_table.frame_count;
+	pose_table.bone_counts = memory_alloc(arena, sizeof(int) * frame_count);
+	pose_table.object_counts = memory_alloc(arena, sizeof(int) * frame_count);
+	pose_table.blends = memory_alloc(arena, sizeof(bool) * frame_count);
+	pose_table.bones = memory_alloc(arena, sizeof(struct pose_table_bone) * frame_count * pose_table.bone_capacity);
+	pose_table.objects = memory_alloc(arena, sizeof(struct pose_table_object) * frame_count * pose_table.object_capacity);
+	
+	struct pose pose = pose_create(pose_table.bone_capacity, pose_table.object_capacity, NULL);
+	
+	for (int f = 0; f < frame_count; f++) {
+		animation_sample_pose(animation, pose_table_frame_time(&pose_table, f), &pose);
+		
+		struct pose_table_bone *bones = &pose_table.bones[f * pose_table.bone_capacity];
+		for (int i = 0; i < pose.bone_count; i++) {
+			bones[i].local = pose.bones[i].local;
+			bones[i].parent = pose.bones[i].parent;
+			bones[i].timeline = pose.bones[i].timeline;
+		}
+		
+		struct pose_table_object *objects = &pose_table.objects[f * pose_table.object_capacity];
+		for (int i = 0; i < pose.object_count; i++) {
+			objects[i].local = pose.objects[i].local;
+			objects[i].parent = pose.objects[i].parent;
+			objects[i].timeline = pose.objects[i].timeline;
+			objects[i].folder = pose.objects[i].folder;
+			objects[i].file = pose.objects[i].file;
+			objects[i].z_index = pose.objects[i].z_index;
+		}
+		
+		pose_table.bone_counts[f] = pose.bone_count;
+		pose_table.object_counts[f] = pose.object_count;
+	}
+	
+	pose_table_link_frames(&pose_table, &pose);
+	
+	pose_destroy(&pose);
+	return pose_table;
+}
+
+void pose_table_destroy(struct pose_table *pose_table) {
+	assert(pose_table != NULL);
+	
+	if (pose_table->arena != NULL) return; // released with the arena
+	
+	memory_free(pose_table->arena, pose_table->bone_counts);
+	memory_free(pose_table->arena, pose_table->object_counts);
+	memory_free(pose_table->arena, pose_table->blends);
+	memory_free(pose_table->arena, pose_table->bones);
+	memory_free(pose_table->arena, pose_table->objects);
+}
+
+static struct transform pose_table_lerp(struct transform from, struct transform to, float turn, float t) {
+	struct transform transform = transform_lerp(from, to, t, 0);
+	transform.angle = from.angle + turn * t;
+	return transform;
+}
+
+// Wraps and clamps `time` like animation_sample_pose. Without `interpolate`
+// the pose is the frame at or before `time`.
+void pose_table_sample_pose(struct pose_table *pose_table, float time, bool interpolate, struct pose *pose) {
+	assert(pose_table != NULL);
+	assert(pose != NULL);
+	assert(pose_table->bone_capacity <= pose->bone_capacity);
+	assert(pose_table->object_capacity <= pose->object_capacity);
+	
+	float t = 0.0f;
+	int frame = pose_table_find_frame(pose_table->length, pose_table->looping, pose_table->frame_interval, pose_table->frame_count,
+		interpolate ? pose_table->blends : NULL, time, &t);
+	
+	int next = frame;
+	if (t > 0.0f) next = (frame + 1 < pose_table->frame_count) ? frame + 1 : 0;
+	
+	struct pose_table_bone *bones = &pose_table->bones[frame * pose_table->bone_capacity];
+	struct pose_table_bone *next_bones = &pose_table->bones[next * pose_table->bone_capacity];
+	pose->bone_count = pose_table->bone_counts[frame];
+	for (int i = 0; i < pose->bone_count; i++) {
+		struct pose_bone *bone = &pose->bones[i];
+		bone->local = (next == frame) ? bones[i].local : pose_table_lerp(bones[i].local, next_bones[i].local, bones[i].turn, t);
+		bone->parent = bones[i].parent;
+		bone->timeline = bones[i].timeline;
+	}
+	
+	struct pose_table_object *objects = &pose_table->objects[frame * pose_table->object_capacity];
+	struct pose_table_object *next_objects = &pose_table->objects[next * pose_table->object_capacity];
+	pose->object_count = pose_table->object_counts[frame];
+	for (int i = 0; i < pose->object_count; i++) {
+		struct pose_object *object = &pose->objects[i];
+		object->local = (next == frame) ? objects[i].local : pose_table_lerp(objects[i].local, next_objects[i].local, objects[i].turn, t);
+		object->parent = objects[i].parent;
+		object->timeline = objects[i].timeline;
+		object->folder = objects[i].folder;
+		object->file = objects[i].file;
+		object->z_index = objects[i].z_index;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Compressed pose table
+////////////////////////////////////////////////////////////////////////////////
+static float transform_channel(struct transform *transform, int channel) {
+	switch (channel) {
+		case transform_channel_x: return transform->x;
+		case transform_channel_y: return transform->y;
+		case transform_channel_angle: return transform->angle;
+		case transform_channel_scale_x: return transform->scale_x;
+		case transform_channel_scale_y: return transform->scale_y;
+		default: return transform->a;
+	}
+}
+
+static void transform_set_channel(struct transform *transform, int channel, float value) {
+	switch (channel) {
+		case transform_channel_x: transform->x = value; break;
+		case transform_channel_y: transform->y = value; break;
+		case transform_channel_angle: transform->angle = value; break;
+		case transform_channel_scale_x: transform->scale_x = value; break;
+		case transform_channel_scale_y: transform->scale_y = value; break;
+		default: transform->a = value; break;
+	}
+}
+
+// Slots are numbered bones first, then objects.
+static bool pose_table_slot(struct pose_table *pose_table, int frame, int slot, struct transform *local, float *turn) {
+	if (slot < pose_table->bone_capacity) {
+		if (slot >= pose_table->bone_counts[frame]) return false;
+		
+		struct pose_table_bone *bone = &pose_table->bones[frame * pose_table->bone_capacity + slot];
+		*local = bone->local;
+		*turn = bone->turn;
+		return true;
+	}
+	
+	int object_index = slot - pose_table->bone_capacity;
+	if (object_index >= pose_table->object_counts[frame]) return false;
+	
+	struct pose_table_object *object = &pose_table->objects[frame * pose_table->object_capacity + object_index];
+	*local = object->local;
+	*turn = object->turn;
+	return true;
+}
+
+static struct compressed_pose_slot compressed_pose_slot_create(int parent, int timeline, int folder, int file, int z_index) {
+	struct compressed_pose_slot slot;
+	slot.parent = parent;
+	slot.timeline = timeline;
+	slot.folder = folder;
+	slot.file = file;
+	slot.z_index = z_index;
+	return slot;
+}
+
+static bool pose_table_same_layout(struct pose_table *pose_table, int frame, int other) {
+	if (pose_table->bone_counts[frame] != pose_table->bone_counts[other]) return false;
+	if (pose_table->object_counts[frame] != pose_table->object_counts[other]) return false;
+	
+	for (int i = 0; i < pose_table->bone_counts[frame]; i++) {
+		struct pose_table_bone *a = &pose_table->bones[frame * pose_table->bone_capacity + i];
+		struct pose_table_bone *b = &pose_table->bones[other * pose_table->bone_capacity + i];
+		if ((a->parent != b->parent) || (a->timeline != b->timeline)) return false;
+	}
+	
+	for (int i = 0; i < pose_table->object_counts[frame]; i++) {
+		struct pose_table_object *a = &pose_table->objects[frame * pose_table->object_capacity + i];
+		struct pose_table_object *b = &pose_table->objects[other * pose_table->object_capacity + i];
+		if ((a->parent != b->parent) || (a->timeline != b->timeline)) return false;
+		if ((a->folder != b->folder) || (a->file != b->file) || (a->z_index != b->z_index)) return false;
+	}
+	
+	return true;
+}
+
+// Writes the rows of every channel of `slot` into series[channel * row_count +
+// row]. Angles continue from the previous frame by its turn when the two
+// blend, and otherwise by whole turns to stay close to it. Frames without the
+// slot repeat its last values so they do not widen the range.
+static void compressed_pose_table_series(struct pose_table *pose_table, int slot, int row_count, float *series) {
+	struct transform value = transform_create(0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+	float turn = 0.0f;
+	
+	for (int f = 0; f < pose_table->frame_count; f++) {
+		if (pose_table_slot(pose_table, f, slot, &value, &turn)) break;
+	}
+	
+	bool previous_present = false;
+	float previous_angle = value.angle;
+	float previous_turn = 0.0f;
+	bool last_blends = false;
+	
+	for (int f = 0; f < pose_table->frame_count; f++) {
+		struct transform local;
+		float local_turn = 0.0f;
+		bool present = pose_table_slot(pose_table, f, slot, &local, &local_turn);
+		
+		if (present) {
+			float angle = local.angle;
+			if (previous_present && pose_table->blends[f - 1]) {
+				angle = previous_angle + previous_turn;
+			} else if (f > 0) {
+				angle += 360.0f * roundf((previous_angle - angle) / 360.0f);
+			}
+			
+			value = local;
+			value.angle = angle;
+			previous_angle = angle;
+			previous_turn = local_turn;
+		}
+		previous_present = present;
+		last_blends = present && pose_table->blends[f];
+		
+		for (int c = 0; c < transform_channel_count; c++) {
+			series[c * row_count + f] = transform_channel(&value, c);
+		}
+	}
+	
+	// The extra row of a looping table is the first frame again, reached by
+	// turning on from the last one.
+	for (int row = pose_table->frame_count; row < row_count; row++) {
+		for (int c = 0; c < transform_channel_count; c++) {
+			series[c * row_count + row] = series[c * row_count];
+		}
+		if (last_blends) series[transform_channel_angle * row_count + row] = previous_angle + previous_turn;
+	}
+}
+
+struct compressed_pose_table compressed_pose_table_create(struct pose_table *pose_table, struct arena *arena) {
+	assert(pose_table != NULL);
+	
+	struct compressed_pose_table compressed;
+	compressed.animation = pose_table->animation;
+	compressed.length = pose_table->length;
+	compressed.looping = pose_table->looping;
+	compressed.frame_interval = pose_table->frame_interval;
+	compressed.frame_count = pose_table->frame_count;
+	compressed.row_count = pose_table->frame_count + (pose_table->looping ? 1 : 0);
+	compressed.bone_capacity = pose_table->bone_capacity;
+	compressed.object_capacity = pose_table->object_capacity;
+	compressed.arena = arena;
+	
+	int frame_count = compressed.frame_count;
+	int row_count = compressed.row_count;
+	int slot_total = compressed.bone_capacity + compressed.object_capacity;
+	
+	// Layouts, one per run of frames with the same slots.
+	compressed.layout_count = 0;
+	compressed.slot_count = 0;
+	for (int f = 0; f < frame_count; f++) {
+		if ((f > 0) && pose_table_same_layout(pose_table, f, f - 1)) continue;
+		compressed.layout_count++;
+		compressed.slot_count += pose_table->bone_counts[f] + pose_table->object_counts[f];
+	}
+	
+	compressed.blends = memory_alloc(arena, sizeof(bool) * frame_count);
+	compressed.frame_layouts = memory_alloc(arena, sizeof(int) * frame_count);
+	compressed.layouts = memory_alloc(arena, sizeof(struct compressed_pose_layout) * compressed.layout_count);
+	compressed.slots = memory_alloc(arena, sizeof(struct compressed_pose_slot) * compressed.slot_count);
+	
+	int layout = -1;
+	int slot = 0;
+	for (int f = 0; f < frame_count; f++) {
+		compressed.blends[f] = pose_table->blends[f];
+		
+		if ((f == 0) || !pose_table_same_layout(pose_table, f, f - 1)) {
+			struct compressed_pose_layout *current = &compressed.layouts[++layout];
+			current->bone_count = pose_table->bone_counts[f];
+			current->object_count = pose_table->object_counts[f];
+			current->first_slot = slot;
+			
+			for (int i = 0; i < current->bone_count; i++) {
+				struct pose_table_bone *bone = &pose_table->bones[f * pose_table->bone_capacity + i];
+				compressed.slots[slot++] = compressed_pose_slot_create(bone->parent, bone->timeline, -1, -1, 0);
+			}
+			for (int i = 0; i < current->object_count; i++) {
+				struct pose_table_object *object = &pose_table->objects[f * pose_table->object_capacity + i];
+				compressed.slots[slot++] = compressed_pose_slot_create(object->parent, object->timeline, object->folder, object->file, object->z_index);
+			}
+		}
+		compressed.frame_layouts[f] = layout;
+	}
+	
+	// Tracks: every channel that changes across the rows.
+	float *series = memory_alloc(NULL, sizeof(float) * (size_t)slot_total * transform_channel_count * row_count);
+	compressed.constants = memory_alloc(arena, sizeof(struct transform) * slot_total);
+	compressed.channel_masks = memory_alloc(arena, sizeof(unsigned char) * slot_total);
+	compressed.first_tracks = memory_alloc(arena, sizeof(int) * (slot_total + 1));
+	compressed.track_count = 0;
+	
+	for (int s = 0; s < slot_total; s++) {
+		float *slot_series = &series[(size_t)s * transform_channel_count * row_count];
+		compressed_pose_table_series(pose_table, s, row_count, slot_series);
+		compressed.channel_masks[s] = 0;
+		compressed.first_tracks[s] = compressed.track_count;
+		
+		for (int c = 0; c < transform_channel_count; c++) {
+			float *channel = &slot_series[c * row_count];
+			bool constant = true;
+			for (int row = 1; row < row_count; row++) {
+				if (channel[row] != channel[0]) constant = false;
+			}
+			
+			transform_set_channel(&compressed.constants[s], c, channel[0]);
+			if (constant) continue;
+			
+			compressed.channel_masks[s] |= 1 << c;
+			compressed.track_count++;
+		}
+	}
+	compressed.first_tracks[slot_total] = compressed.track_count;
+	
+	// Decoding runs in whole vectors, so it may read up to a vector past the
+	// last track.
+	int track_count = compressed.track_count;
+	size_t slack = COMPRESSED_POSE_TABLE_LANES;
+	compressed.track_offsets = memory_alloc(arena, sizeof(float) * (track_count + slack));
+	compressed.track_scales = memory_alloc(arena, sizeof(float) * (track_count + slack));
+	compressed.rows = memory_alloc(arena, sizeof(uint16_t) * ((size_t)row_count * track_count + slack));
+	memset(compressed.track_offsets + track_count, 0, sizeof(float) * slack);
+	memset(compressed.track_scales + track_count, 0, sizeof(float) * slack);
+	memset(compressed.rows + (size_t)row_count * track_count, 0, sizeof(uint16_t) * slack);
+	for (int c = 0; c < transform_channel_count; c++) {
+		compressed.error_bounds[c] = 0.0f;
+	}
+	
+	int track = 0;
+	for (int target = 0; target < slot_total * transform_channel_count; target++) {
+		if (!(compressed.channel_masks[target / transform_channel_count] & (1 << (target % transform_channel_count)))) continue;
+		
+		float *channel = &series[(size_t)target * row_count];
+		float low = channel[0];
+		float high = channel[0];
+		for (int row = 1; row < row_count; row++) {
+			if (channel[row] < low) low = channel[row];
+			if (channel[row] > high) high = channel[row];
+		}
+		
+		float scale = (high - low) / 65535.0f;
+		compressed.track_offsets[track] = low;
+		compressed.track_scales[track] = scale;
+		
+		int c = target % transform_channel_count;
+		if (scale * 0.5f > compressed.error_bounds[c]) compressed.error_bounds[c] = scale * 0.5f;
+		
+		for (int row = 0; row < row_count; row++) {
+			float q = roundf((channel[row] - low) / scale);
+			if (q > 65535.0f) q = 65535.0f;
+			compressed.rows[(size_t)row * track_count + track] = (uint16_t)q;
+		}
+		track++;
+	}
+	
+	memory_free(NULL, series);
+	
+	return compressed;
+}
+
+void compressed_pose_table_destroy(struct compressed_pose_table *compressed_pose_table) {
+	assert(compressed_pose_table != NULL);
+	
+	if (compressed_pose_table->arena != NULL) return; // released with the arena
+	
+	struct arena *arena = compressed_pose_table->arena;
+	memory_free(arena, compressed_pose_table->constants);
+	memory_free(arena, compressed_pose_table->channel_masks);
+	memory_free(arena, compressed_pose_table->first_tracks);
+	memory_free(arena, compressed_pose_table->track_offsets);
+	memory_free(arena, compressed_pose_table->track_scales);
+	memory_free(arena, compressed_pose_table->rows);
+	memory_free(arena, compressed_pose_table->blends);
+	memory_free(arena, compressed_pose_table->frame_layouts);
+	memory_free(arena, compressed_pose_table->layouts);
+	memory_free(arena, compressed_pose_table->slots);
+}
+
+size_t compressed_pose_table_memory(struct compressed_pose_table *compressed_pose_table) {
+	assert(compressed_pose_table != NULL);
+	
+	struct compressed_pose_table *table = compressed_pose_table;
+	size_t memory = (sizeof(struct transform) + sizeof(unsigned char) + sizeof(int)) * (table->bone_capacity + table->object_capacity);
+	memory += sizeof(float) * 2 * (table->track_count + COMPRESSED_POSE_TABLE_LANES);
+	memory += sizeof(uint16_t) * ((size_t)table->row_count * table->track_count + COMPRESSED_POSE_TABLE_LANES);
+	memory += (sizeof(bool) + sizeof(int)) * table->frame_count;
+	memory += sizeof(struct compressed_pose_layout) * table->layout_count;
+	memory += sizeof(struct compressed_pose_slot) * table->slot_count;
+	return memory;
+}
+
+void compressed_pose_table_sample_pose(struct compressed_pose_table *compressed_pose_table, float time, bool interpolate, struct pose *pose) {
+	assert(compressed_pose_table != NULL);
+	assert(pose != NULL);
+	
+	struct compressed_pose_table *table = compressed_pose_table;
+	assert(table->bone_capacity <= pose->bone_capacity);
+	assert(table->object_capacity <= pose->object_capacity);
+	
+	float t = 0.0f;
+	int frame = pose_table_find_frame(table->length, table->looping, table->frame_interval, table->frame_count,
+		interpolate ? table->blends : NULL, time, &t);
+	int next_row = (t > 0.0f) ? frame + 1 : frame;
+	
+	struct compressed_pose_layout *layout = &table->layouts[table->frame_layouts[frame]];
+	struct compressed_pose_slot *slots = &table->slots[layout->first_slot];
+	pose->bone_count = layout->bone_count;
+	pose->object_count = layout->object_count;
+	
+	for (int i = 0; i < layout->bone_count; i++) {
+		pose->bones[i].parent = slots[i].parent;
+		pose->bones[i].timeline = slots[i].timeline;
+	}
+	
+	for (int i = 0; i < layout->object_count; i++) {
+		struct compressed_pose_slot *slot = &slots[layout->bone_count + i];
+		struct pose_object *object = &pose->objects[i];
+		object->parent = slot->parent;
+		object->timeline = slot->timeline;
+		object->folder = slot->folder;
+		object->file = slot->file;
+		object->z_index = slot->z_index;
+	}
+	
+	// Slots are decoded a block at a time. Decoding their tracks is a straight
+	// loop over contiguous rows that compilers vectorize; each slot then
+	// takes its tracks in channel order over its constants.
+	const uint16_t *row = &table->rows[(size_t)frame * table->track_count];
+	const uint16_t *next = &table->rows[(size_t)next_row * table->track_count];
+	float decoded[COMPRESSED_POSE_TABLE_BLOCK * transform_channel_count + COMPRESSED_POSE_TABLE_LANES];
+	int slot_total = table->bone_capacity + table->object_capacity;
+	
+	for (int first = 0; first < slot_total; first += COMPRESSED_POSE_TABLE_BLOCK) {
+		int count = slot_total - first;
+		if (count > COMPRESSED_POSE_TABLE_BLOCK) count = COMPRESSED_POSE_TABLE_BLOCK;
+		
+		int first_track = table->first_tracks[first];
+		int track_count = table->first_tracks[first + count] - first_track;
+		const uint16_t *row_block = row + first_track;
+		const uint16_t *next_block = next + first_track;
+		const float *offsets = table->track_offsets + first_track;
+		const float *scales = table->track_scales + first_track;
+		
+		for (int i = 0; i < track_count; i += COMPRESSED_POSE_TABLE_LANES) {
+			for (int lane = i; lane < i + COMPRESSED_POSE_TABLE_LANES; lane++) {
+				float q = (float)row_block[lane] + ((float)next_block[lane] - (float)row_block[lane]) * t;
+				decoded[lane] = offsets[lane] + q * scales[lane];
+			}
+		}
+		
+		const float *value = decoded;
+		for (int slot = first; slot < first + count; slot++) {
+			struct transform local = table->constants[slot];
+			int mask = table->channel_masks[slot];
+			if (mask & (1 << transform_channel_x)) local.x = *value++;
+			if (mask & (1 << transform_channel_y)) local.y = *value++;
+			if (mask & (1 << transform_channel_angle)) local.angle = *value++;
+			if (mask & (1 << transform_channel_scale_x)) local.scale_x = *value++;
+			if (mask & (1 << transform_channel_scale_y)) local.scale_y = *value++;
+			if (mask & (1 << transform_channel_a)) local.a = *value++;
+			
+			if (slot < layout->bone_count) {
+				pose->bones[slot].local = local;
+			} else if ((slot >= table->bone_capacity) && (slot - table->bone_capacity < layout->object_count)) {
+				pose->objects[slot - table->bone_capacity].local = local;
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Pose table cache
+////////////////////////////////////////////////////////////////////////////////
+struct pose_table_cache pose_table_cache_create(size_t budget, bool compress) {
+	struct pose_table_cache cache;
+	cache.budget = budget;
+	cache.compress = compress;
+	cache.used = 0;
+	cache.clock = 0;
+	cache.hits = 0;
+	cache.misses = 0;
+	cache.evictions = 0;
+	cache.length = 0;
+	cache.capacity = 0;
+	cache.items = NULL;
+	return cache;
+}
+
+void pose_table_cache_destroy(struct pose_table_cache *cache) {
+	assert(cache != NULL);
+	
+	pose_table_cache_clear(cache);
+	memory_free(NULL, cache->items);
+	cache->items = NULL;
+	cache->capacity = 0;
+}
+
+static void pose_table_cache_entry_destroy(struct pose_table_cache *cache, struct pose_table_cache_entry *entry) {
+	if (cache->compress) {
+		compressed_pose_table_destroy(&entry->compressed_pose_table);
+	} else {
+		pose_table_destroy(&entry->pose_table);
+	}
+}
+
+void pose_table_cache_clear(struct pose_table_cache *cache) {
+	assert(cache != NULL);
+	
+	for (int i = 0; i < cache->length; i++) {
+		pose_table_cache_entry_destroy(cache, &cache->items[i]);
+	}
+	cache->length = 0;
+	cache->used = 0;
+}
+
+static void pose_table_cache_evict(struct pose_table_cache *cache, int index) {
+	cache->used -= cache->items[index].memory;
+	cache->evictions++;
+	pose_table_cache_entry_destroy(cache, &cache->items[index]);
+	cache->items[index] = cache->items[cache->length - 1];
+	cache->length--;
+}
+
+// The cache holds a handful of tables, so finding one, or the least recently
+// used one, is a scan.
+static int pose_table_cache_least_recently_used(struct pose_table_cache *cache) {
+	int found = 0;
+	
+	for (int i = 1; i < cache->length; i++) {
+		if (cache->items[i].last_used < cache->items[found].last_used) found = i;
+	}
+	
+	return found;
+}
+
+static struct pose_table_cache_entry *pose_table_cache_find(struct pose_table_cache *cache, struct animation *animation, float frame_interval) {
+	cache->clock++;
+	
+	for (int i = 0; i < cache->length; i++) {
+		struct pose_table_cache_entry *entry = &cache->items[i];
+		if ((entry->animation == animation) && (entry->frame_interval == frame_interval)) {
+			entry->last_used = cache->clock;
+			cache->hits++;
+			return entry;
+		}
+	}
+	
+	cache->misses++;
+	return NULL;
+}
+
+// Evicts until `memory` more bytes fit and returns a new entry for them.
+static struct pose_table_cache_entry *pose_table_cache_add(struct pose_table_cache *cache, struct animation *animation, float frame_interval, size_t memory) {
+	while (cache->used + memory > cache->budget) {
+		pose_table_cache_evict(cache, pose_table_cache_least_recently_used(cache));
+	}
+	
+	if (cache->length == cache->capacity) {
+		int capacity = (cache->capacity == 0) ? 8 : cache->capacity * 2;
+		size_t entry_size = sizeof(struct pose_table_cache_entry);
+		cache->items = memory_realloc(NULL, cache->items, entry_size * cache->capacity, entry_size * capacity);
+		assert(cache->items != NULL);
+		cache->capacity = capacity;
+	}
+	
+	struct pose_table_cache_entry *entry = &cache->items[cache->length++];
+	entry->animation = animation;
+	entry->frame_interval = frame_interval;
+	entry->memory = memory;
+	entry->last_used = cache->clock;
+	cache->used += memory;
+	
+	return entry;
+}
+
+// Returns the table of `animation` at `frame_interval` (0 or less for the
+// animation's own interval), baking it if needed, or NULL when it alone would
+// exceed the budget. The table stays valid until the next call.
+struct pose_table *pose_table_cache_get(struct pose_table_cache *cache, struct animation *animation, float frame_interval) {
+	assert(cache != NULL);
+	assert(!cache->compress);
+	assert(animation != NULL);
+	
+	frame_interval = pose_table_resolve_interval(animation, frame_interval);
+	struct pose_table_cache_entry *entry = pose_table_cache_find(cache, animation, frame_interval);
+	if (entry != NULL) return &entry->pose_table;
+	
+	size_t memory = pose_table_memory(animation, frame_interval);
+	if (memory > cache->budget) return NULL;
+	
+	entry = pose_table_cache_add(cache, animation, frame_interval, memory);
+	entry->pose_table = pose_table_create(animation, frame_interval, NULL);
+	
+	return &entry->pose_table;
+}
+
+// Same as pose_table_cache_get for a compressing cache. How large a compressed
+// table is shows only once it is built, so a table that does not fit is baked
+// and thrown away on every call; size the budget for the tables in use.
+struct compressed_pose_table *pose_table_cache_get_compressed(struct pose_table_cache *cache, struct animation *animation, float frame_interval) {
+	assert(cache != NULL);
+	assert(cache->compress);
+	assert(animation != NULL);
+	
+	frame_interval = pose_table_resolve_interval(animation, frame_interval);
+	struct pose_table_cache_entry *entry = pose_table_cache_find(cache, animation, frame_interval);
+	if (entry != NULL) return &entry->compressed_pose_table;
+	
+	struct pose_table pose_table = pose_table_create(animation, frame_interval, NULL);
+	struct compressed_pose_table compressed_pose_table = compressed_pose_table_create(&pose_table, NULL);
+	pose_table_destroy(&pose_table);
+	
+	size_t memory = compressed_pose_table_memory(&compressed_pose_table);
+	if (memory > cache->budget) {
+		compressed_pose_table_destroy(&compressed_pose_table);
+		return NULL;
+	}
+	
+	entry = pose_table_cache_add(cache, animation, frame_interval, memory);
+	entry->compressed_pose_table = compressed_pose_table;
+	
+	return &entry->compressed_pose_table;
+}
+
+// Plays `animation` from its cached table at its own interval, falling back
+// to animation_sample_pose when the table does not fit the budget.
+void pose_table_cache_sample_pose(struct pose_table_cache *cache, struct animation *animation, float time, bool interpolate, struct pose *pose) {
+	assert(cache != NULL);
+	
+	if (cache->compress) {
+		struct compressed_pose_table *compressed_pose_table = pose_table_cache_get_compressed(cache, animation, 0.0f);
+		if (compressed_pose_table != NULL) {
+			compressed_pose_table_sample_pose(compressed_pose_table, time, interpolate, pose);
+			return;
+		}
+	} else {
+		struct pose_table *pose_table = pose_table_cache_get(cache, animation, 0.0f);
+		if (pose_table != NULL) {
+			pose_table_sample_pose(pose_table, time, interpolate, pose);
+			return;
+		}
+	}
+	
+	animation_sample_pose(animation, time, pose);
+}
\ No newline at end of file
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "arena.h"
+#include "runtime.h"
+#include "scml.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// 							Baked animations
+////////////////////////////////////////////////////////////////////////////////
+// A read-only copy of the animations of a spriter_data with one flat array per
+// field, built by baked_data_create. The keys of all timelines of an animation
+// sit back to back, and refs name keys by that global index, so sampling reads
+// key times and channels from a few contiguous arrays instead of chasing the
+// bone_list and object_list of every timeline_key.
+
+////////////////////////////////////////////////////////////////////////////////
+// Baked ref
+////////////////////////////////////////////////////////////////////////////////
+struct baked_ref {
+	int parent; // index of the parent among the key's baked bone refs, -1 for the root
+	int timeline;
+	int key;     // global key index
+	int z_index; // objects only
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Baked animation
+////////////////////////////////////////////////////////////////////////////////
+// Timeline t owns keys [timeline_keys[t], timeline_keys[t + 1]) and mainline
+// key m owns refs [mainline_bone_refs[m], mainline_bone_refs[m + 1]), objects
+// likewise. key_next and key_durations hold the key each key blends into and
+// how long that takes, 0 when it holds its value.
+struct baked_animation {
+	int length;
+	bool looping;
+	
+	int timeline_count;
+	int *timeline_keys; // [timeline_count + 1]
+	
+	int key_count;
+	int *key_times;
+	int *key_spins;
+	int *key_next;
+	float *key_durations;
+	int *key_folders; // -1 for bone keys
+	int *key_files;
+	float *channels[transform_channel_count]; // [key]
+	
+	int mainline_key_count;
+	int *mainline_times;
+	int *mainline_bone_refs;   // [mainline_key_count + 1]
+	int *mainline_object_refs; // [mainline_key_count + 1]
+	
+	int bone_ref_count;
+	struct baked_ref *bone_refs;
+	int object_ref_count;
+	struct baked_ref *object_refs;
+	
+	struct arena *arena;
+};
+
+struct baked_animation baked_animation_create(struct animation *animation, struct arena *arena);
+void baked_animation_destroy(struct baked_animation *baked_animation);
+int baked_animation_find_mainline_key(struct baked_animation *baked_animation, float time);
+int baked_animation_cursor_find_mainline_key(struct animation_cursor *cursor, struct baked_animation *baked_animation, float time);
+void baked_animation_sample_pose(struct baked_animation *baked_animation, float time, struct pose *pose);
+void baked_animation_sample_pose_with_cursor(struct baked_animation *baked_animation, float time, struct animation_cursor *cursor, struct pose *pose);
+void baked_animation_sample_batch(struct baked_animation *baked_animation, const float *times, int count, struct pose_batch *batch);
+
+////////////////////////////////////////////////////////////////////////////////
+// Baked entity
+////////////////////////////////////////////////////////////////////////////////
+struct baked_entity {
+	int animation_count;
+	struct baked_animation *animations;
+	int bone_capacity;   // of the largest mainline key, for pose_create
+	int object_capacity;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Baked data
+////////////////////////////////////////////////////////////////////////////////
+struct baked_data {
+	int entity_count;
+	struct baked_entity *entities;
+	struct arena *arena; // when set, baked_data_destroy is a no-op and the arena owns everything
+};
+
+struct baked_data baked_data_create(struct spriter_data *spriter_data, struct arena *arena);
+void baked_data_destroy(struct baked_data *baked_data);
+size_t baked_data_memory(struct baked_data *baked_data);
+void baked_entity_sample_pose(struct baked_entity *baked_entity, int animation_index, float time, struct pose *pose);
+
+////////////////////////////////////////////////////////////////////////////////
+// Pose table
+////////////////////////////////////////////////////////////////////////////////
+// An animation sampled once at a fixed rate: frame f holds the pose at
+// f * frame_interval, so playback is a lookup plus, optionally, a lerp towards
+// the next frame. Every frame has room for the largest mainline key. `turn` is
+// how far the angle goes until the next frame, in the direction the animation
+// actually turns, which the angles alone cannot tell.
+struct pose_table_bone {
+	struct transform local;
+	float turn;
+	int parent;
+	int timeline;
+};
+
+struct pose_table_object {
+	struct transform local;
+	float turn;
+	int parent;
+	int timeline;
+	int folder;
+	int file;
+	int z_index;
+};
+
+struct pose_table {
+	struct animation *animation; // sampled from
+	int length;
+	bool looping;
+	float frame_interval; // milliseconds
+	int frame_count;
+	
+	int bone_capacity;
+	int object_capacity;
+	int *bone_counts;   // [frame]
+	int *object_counts; // [frame]
+	bool *blends;       // [frame], false across a change of mainline key
+	struct pose_table_bone *bones;     // [frame * bone_capacity + bone]
+	struct pose_table_object *objects; // [frame * object_capacity + object]
+	
+	struct arena *arena;
+};
+
+size_t pose_table_memory(struct animation *animation, float frame_interval);
+struct pose_table pose_table_create(struct animation *animation, float frame_interval, struct arena *arena);
+void pose_table_destroy(struct pose_table *pose_table);
+void pose_table_sample_pose(struct pose_table *pose_table, float time, bool interpolate, struct pose *pose);
+
+////////////////////////////////////////////////////////////////////////////////
+// Compressed pose table
+////////////////////////////////////////////////////////////////////////////////
+// A pose table with every channel of every slot stored as a track of 16-bit
+// values over the frames, value = offset + q * scale. Channels that never
+// change are kept once as constants instead. Each frame is one contiguous row
+// of all tracks, decoded with one multiply-add per track. Angles are stored
+// unwrapped (each frame continues from the previous one by its turn) so that
+// blending is the same lerp for every track, and a looping table has one more
+// row that continues its last frame into the first. The parents, timelines
+// and files of the slots are stored once per run of frames that share them.
+#define COMPRESSED_POSE_TABLE_LANES 8 // tracks decoded per vector
+#define COMPRESSED_POSE_TABLE_BLOCK 64 // slots decoded at a time
+
+struct compressed_pose_slot {
+	int parent;
+	int timeline;
+	int folder;
+	int file;
+	int z_index;
+};
+
+struct compressed_pose_layout {
+	int bone_count;
+	int object_count;
+	int first_slot; // into slots, bones then objects
+};
+
+struct compressed_pose_table {
+	struct animation *animation;
+	int length;
+	bool looping;
+	float frame_interval;
+	int frame_count;
+	int row_count;
+	
+	int bone_capacity;
+	int object_capacity;
+	struct transform *constants;  // [slot], bones then objects
+	unsigned char *channel_masks; // [slot], bit c set when channel c is a track
+	int *first_tracks;            // [slot + 1], the tracks of a slot in channel order
+	
+	int track_count;
+	float *track_offsets; // [track]
+	float *track_scales;  // [track]
+	uint16_t *rows;       // [row * track_count + track]
+	
+	bool *blends;          // [frame]
+	int *frame_layouts;    // [frame]
+	int layout_count;
+	struct compressed_pose_layout *layouts;
+	int slot_count;
+	struct compressed_pose_slot *slots;
+	
+	float error_bounds[transform_channel_count]; // largest quantization error of any track
+	
+	struct arena *arena;
+};
+
+struct compressed_pose_table compressed_pose_table_create(struct pose_table *pose_table, struct arena *arena);
+void compressed_pose_table_destroy(struct compressed_pose_table *compressed_pose_table);
+size_t compressed_pose_table_memory(struct compressed_pose_table *compressed_pose_table);
+void compressed_pose_table_sample_pose(struct compressed_pose_table *compressed_pose_table, float time, bool interpolate, struct pose *pose);
+
+////////////////////////////////////////////////////////////////////////////////
+// Pose table cache
+////////////////////////////////////////////////////////////////////////////////
+// Pose tables of the animations played most, within a memory budget. Asking
+// for a table that is not cached bakes it, first evicting the least recently
+// used tables until it fits. A compressing cache stores compressed pose tables
+// instead. Tables live on the heap so that they can be evicted one by one.
+struct pose_table_cache_entry {
+	struct animation *animation;
+	float frame_interval;
+	struct pose_table pose_table;                       // unless compressed
+	struct compressed_pose_table compressed_pose_table; // if compressed
+	size_t memory;
+	unsigned long last_used;
+};
+
+struct pose_table_cache {
+	size_t budget; // bytes
+	bool compress;
+	size_t used;
+	unsigned long clock;
+	unsigned long hits;
+	unsigned long misses; // tables baked, or too large for the budget
+	unsigned long evictions;
+	
+	int length;
+	int capacity;
+	struct pose_table_cache_entry *items;
+};
+
+struct pose_table_cache pose_table_cache_create(size_t budget, bool compress);
+void pose_table_cache_destroy(struct pose_table_cache *cache);
+void pose_table_cache_clear(struct pose_table_cache *cache);
+struct pose_table *pose_table_cache_get(struct pose_table_cache *cache, struct animation *animation, float frame_interval);
+struct compressed_pose_table *pose_table_cache_get_compressed(struct pose_table_cache *cache, struct animation *animation, float frame_interval);
+void pose_table_cache_sample_pose(struct pose_table_cache *cache, struct animation *animation, float time, bool interpolate, struct pose *pose);
\ No newline at end of file
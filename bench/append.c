@@ -0,0 +1,88 @@
+// List growth: appending 100k timeline keys through the array facility
+// against growing by one element per append, and the worst case of a
+// tag_list built from a large file.
+//
+//   cc -O2 -o bench_append bench/append.c && ./bench_append
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+
+#define APPEND_COUNT 100000
+
+static double append_grow_by_one() {
+	struct timeline_key *items = NULL;
+	
+	double start = bench_now();
+	for (int i = 0; i < APPEND_COUNT; i++) {
+		items = realloc(items, sizeof(struct timeline_key) * (i + 1));
+		items[i] = timeline_key_create(i, i, 1, NULL);
+	}
+	double elapsed = bench_now() - start;
+	
+	free(items);
+	return elapsed;
+}
+
+static double append_list(struct arena *arena) {
+	struct timeline_key_list timeline_key_list = timeline_key_list_create(arena);
+	
+	double start = bench_now();
+	for (int i = 0; i < APPEND_COUNT; i++) {
+		timeline_key_list_append(&timeline_key_list, timeline_key_create(i, i, 1, arena));
+	}
+	double elapsed = bench_now() - start;
+	
+	timeline_key_list_destroy(&timeline_key_list);
+	return elapsed;
+}
+
+int main(int argc, char **argv) {
+	long allocations_before = bench_allocation_count;
+	double grow_by_one = append_grow_by_one();
+	long grow_by_one_allocations = bench_allocation_count - allocations_before;
+	
+	allocations_before = bench_allocation_count;
+	double heap = append_list(NULL);
+	long heap_allocations = bench_allocation_count - allocations_before;
+	
+	struct arena arena = arena_create(ARENA_DEFAULT_BLOCK_SIZE);
+	allocations_before = bench_allocation_count;
+	double arena_backed = append_list(&arena);
+	long arena_allocations = bench_allocation_count - allocations_before;
+	size_t arena_bytes = arena_used(&arena);
+	arena_destroy(&arena);
+	
+	printf("append %d timeline keys\r\n", APPEND_COUNT);
+	printf("  grow by one: %8.3f ms, %7ld allocations\r\n", grow_by_one * 1e3, grow_by_one_allocations);
+	printf("  heap list:   %8.3f ms, %7ld allocations\r\n", heap * 1e3, heap_allocations);
+	printf("  arena list:  %8.3f ms, %7ld allocations, %zu bytes used\r\n", arena_backed * 1e3, arena_allocations, arena_bytes);
+	
+	struct scml_generator_options options;
+	options.entity_count = 4;
+	options.animation_count = 16;
+	options.timeline_count = 32;
+	options.bone_count = 16;
+	options.key_count = 32;
+	
+	int length = 0;
+	char *buffer = scml_generate(options, &length);
+	
+	allocations_before = bench_allocation_count;
+	double start = bench_now();
+	struct tag_list tag_list = parse_buffer(buffer, length, NULL);
+	double elapsed = bench_now() - start;
+	long tag_allocations = bench_allocation_count - allocations_before;
+	
+	printf("tag_list from a %.2f MB buffer\r\n", length / (1024.0 * 1024.0));
+	printf("  %d tags in %.3f ms (%.2f M tags/s), %ld allocations, capacity %d\r\n",
+		tag_list.length, elapsed * 1e3, tag_list.length / elapsed * 1e-6, tag_allocations, tag_list.capacity);
+	
+	tag_list_destroy(&tag_list);
+	free(buffer);
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+// Background loading while the calling thread keeps running frames: a set of
+// rigs is handed to a spriter_loader with 2 background threads and at most 2
+// loads at a time, and the loop polls them every frame. The longest frame
+// shows whether loading stalls the loop. One load is cancelled while queued,
+// one path is missing, and every loaded rig is checked against a blocking
+// load.
+//
+//   cc -O2 -pthread -o bench_async bench/async.c -lm && ./bench_async
+#include "bench.h"
+
+// The allocation counters of bench.h are not thread safe.
+#undef malloc
+#undef calloc
+#undef realloc
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../job.c"
+#include "../load.c"
+#include "../cache.c"
+
+#define FILE_COUNT 12
+
+int main(int argc, char **argv) {
+	char *filepaths[FILE_COUNT];
+	char names[FILE_COUNT][32];
+	
+	for (int i = 0; i < FILE_COUNT; i++) {
+		struct scml_generator_options options;
+		options.entity_count = 1;
+		options.animation_count = 4 + i % 4 * 4;
+		options.timeline_count = 24;
+		options.bone_count = 16;
+		options.key_count = 16;
+		
+		snprintf(names[i], sizeof(names[i]), "bench_async_%02d.scml", i);
+		filepaths[i] = names[i];
+		scml_generate_file(filepaths[i], options);
+	}
+	filepaths[FILE_COUNT - 1] = "bench_async_missing.scml";
+	
+	char *expected[FILE_COUNT] = { NULL };
+	int expected_lengths[FILE_COUNT] = { 0 };
+	double blocking = 0.0;
+	for (int i = 0; i < FILE_COUNT - 1; i++) {
+		double start = bench_now();
+		struct spriter_data spriter_data = parse_spriter_file(filepaths[i], NULL);
+		blocking += bench_now() - start;
+		
+		expected[i] = spriter_cache_serialize(&spriter_data, &expected_lengths[i]);
+		spriter_data_destroy(&spriter_data);
+	}
+	fprintf(stderr, "blocking:  %7.2f ms on the calling thread\r\n", blocking * 1e3);
+	
+	struct spriter_loader *loader = spriter_loader_create(2, 2);
+	struct spriter_load *loads[FILE_COUNT];
+	
+	double start = bench_now();
+	for (int i = 0; i < FILE_COUNT; i++) {
+		loads[i] = spriter_load_async(loader, filepaths[i], NULL);
+	}
+	spriter_load_cancel(loads[FILE_COUNT - 2]); // still queued behind the others
+	double submitted = bench_now() - start;
+	
+	int frames = 0;
+	int remaining = FILE_COUNT;
+	double longest = 0.0;
+	bool collected[FILE_COUNT] = { false };
+	int counts[spriter_load_status_cancelled + 1] = { 0 };
+	int mismatches = 0;
+	
+	while (remaining > 0) {
+		double frame_start = bench_now();
+		
+		for (int i = 0; i < FILE_COUNT; i++) {
+			if (collected[i] || !spriter_load_is_done(loads[i])) continue;
+			
+			struct spriter_data spriter_data;
+			enum spriter_load_status status = spriter_load_collect(loads[i], &spriter_data);
+			if ((status == spriter_load_status_ok) && !bench_spriter_data_matches(&spriter_data, expected[i], expected_lengths[i])) mismatches++;
+			spriter_data_destroy(&spriter_data);
+			
+			counts[status]++;
+			collected[i] = true;
+			remaining--;
+		}
+		
+		// Stands in for a frame's work.
+		while (bench_now() - frame_start < 0.001) {
+		}
+		
+		double frame = bench_now() - frame_start;
+		if (frame > longest) longest = frame;
+		frames++;
+	}
+	double total = bench_now() - start;
+	
+	spriter_loader_destroy(loader);
+	
+	fprintf(stderr, "async:     %7.2f ms in %d frames, %.3f ms to submit, longest frame %.2f ms\r\n", total * 1e3, frames, submitted * 1e3, longest * 1e3);
+	fprintf(stderr, "statuses:  %d ok, %d unreadable, %d cancelled, %d mismatches\r\n", counts[spriter_load_status_ok],
+		counts[spriter_load_status_unreadable], counts[spriter_load_status_cancelled], mismatches);
+	
+	for (int i = 0; i < FILE_COUNT; i++) {
+		free(expected[i]);
+		remove(names[i]);
+	}
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+// Sampling from the parsed tree against sampling from its baked arrays, after
+// checking that both give the same poses. The instances spread over enough
+// animations that the key data does not stay in cache.
+//
+//   cc -O2 -o bench_bake bench/bake.c -lm && ./bench_bake > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../runtime.c"
+#include "../bake.c"
+
+static float transform_error(struct transform a, struct transform b) {
+	float errors[6] = { a.x - b.x, a.y - b.y, a.angle - b.angle, a.scale_x - b.scale_x, a.scale_y - b.scale_y, a.a - b.a };
+	float max_error = 0.0f;
+	for (int c = 0; c < 6; c++) {
+		if (fabsf(errors[c]) > max_error) max_error = fabsf(errors[c]);
+	}
+	return max_error;
+}
+
+int main(int argc, char **argv) {
+	char *filepath = "bench_bake.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 64;
+	options.timeline_count = 48;
+	options.bone_count = 32;
+	options.key_count = 32;
+	scml_generate_file(filepath, options);
+	
+	struct spriter_data spriter_data = parse_spriter_file(filepath, NULL);
+	struct entity *entity = &spriter_data.entity_list.items[0];
+	
+	double start = bench_now();
+	struct baked_data baked_data = baked_data_create(&spriter_data, NULL);
+	double bake = bench_now() - start;
+	struct baked_entity *baked_entity = &baked_data.entities[0];
+	
+	struct pose pose = pose_create_for_entity(entity, NULL);
+	struct pose baked_pose = pose_create(baked_entity->bone_capacity, baked_entity->object_capacity, NULL);
+	
+	int instance_count = 2000;
+	int tick_count = 100;
+	float *times = malloc(sizeof(float) * instance_count);
+	for (int i = 0; i < instance_count; i++) {
+		times[i] = bench_random_float(-1000.0f, 1000.0f);
+	}
+	
+	float max_error = 0.0f;
+	int mismatches = 0;
+	for (int i = 0; i < instance_count; i++) {
+		int animation = i % options.animation_count;
+		entity_sample_pose(entity, animation, times[i], &pose);
+		baked_entity_sample_pose(baked_entity, animation, times[i], &baked_pose);
+		
+		if ((pose.bone_count != baked_pose.bone_count) || (pose.object_count != baked_pose.object_count)) {
+			mismatches++;
+			continue;
+		}
+		for (int b = 0; b < pose.bone_count; b++) {
+			float error = transform_error(pose.bones[b].local, baked_pose.bones[b].local);
+			if (error > max_error) max_error = error;
+			if (pose.bones[b].parent != baked_pose.bones[b].parent) mismatches++;
+		}
+		for (int o = 0; o < pose.object_count; o++) {
+			float error = transform_error(pose.objects[o].local, baked_pose.objects[o].local);
+			if (error > max_error) max_error = error;
+			if (pose.objects[o].file != baked_pose.objects[o].file) mismatches++;
+		}
+	}
+	
+	float checksum = 0.0f;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			entity_sample_pose(entity, i % options.animation_count, times[i] + tick * 16.0f, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double tree = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			baked_entity_sample_pose(baked_entity, i % options.animation_count, times[i] + tick * 16.0f, &baked_pose);
+			checksum += baked_pose.bones[baked_pose.bone_count - 1].local.angle;
+		}
+	}
+	double baked = bench_now() - start;
+	
+	long samples = (long)instance_count * tick_count;
+	fprintf(stderr, "rig:        %d bones, %d objects, %d keys per timeline\r\n", options.bone_count, options.timeline_count - options.bone_count, options.key_count);
+	fprintf(stderr, "bake:       %.3f ms\r\n", bake * 1e3);
+	fprintf(stderr, "check:      max error %g, %d mismatches\r\n", max_error, mismatches);
+	fprintf(stderr, "tree:       %.1f ns/sample\r\n", tree / samples * 1e9);
+	fprintf(stderr, "baked:      %.1f ns/sample\r\n", baked / samples * 1e9);
+	fprintf(stderr, "checksum:   %f\r\n", checksum);
+	
+	free(times);
+	pose_destroy(&baked_pose);
+	pose_destroy(&pose);
+	baked_data_destroy(&baked_data);
+	spriter_data_destroy(&spriter_data);
+	remove(filepath);
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+// Crowd sampling: one animation_sample_pose or baked_animation_sample_pose per
+// instance against one baked_animation_sample_batch for all of them, and the
+// batch interpolation kernel alone (on the keys of the last block), with the
+// kernel picked at run time and scalar.
+//
+//   cc -O2 -o bench_batch bench/batch.c -lm && ./bench_batch > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../runtime.c"
+#include "../bake.c"
+
+int main(int argc, char **argv) {
+	char *filepath = "bench_batch.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 1;
+	options.timeline_count = 32;
+	options.bone_count = 32;
+	options.key_count = 16;
+	scml_generate_file(filepath, options);
+	
+	struct spriter_data spriter_data = parse_spriter_file(filepath, NULL);
+	struct entity *entity = &spriter_data.entity_list.items[0];
+	struct animation *animation = &entity->animation_list.items[0];
+	struct baked_animation baked_animation = baked_animation_create(animation, NULL);
+	
+	int instance_count = 4096;
+	int tick_count = 50;
+	
+	float *times = malloc(sizeof(float) * instance_count);
+	for (int i = 0; i < instance_count; i++) {
+		times[i] = bench_random_float(0.0f, 1000.0f);
+	}
+	
+	struct pose pose = pose_create_for_entity(entity, NULL);
+	struct pose_batch batch = pose_batch_create(instance_count, pose.bone_capacity, NULL);
+	
+	// Both paths must agree before they are timed.
+	baked_animation_sample_batch(&baked_animation, times, instance_count, &batch);
+	float max_error = 0.0f;
+	for (int i = 0; i < instance_count; i++) {
+		animation_sample_pose(animation, times[i], &pose);
+		for (int b = 0; b < pose.bone_count; b++) {
+			struct transform expected = pose.bones[b].local;
+			struct transform actual = pose_batch_bone(&batch, i, b);
+			float errors[6] = {
+				expected.x - actual.x, expected.y - actual.y, expected.angle - actual.angle,
+				expected.scale_x - actual.scale_x, expected.scale_y - actual.scale_y, expected.a - actual.a
+			};
+			for (int c = 0; c < 6; c++) {
+				if (fabsf(errors[c]) > max_error) max_error = fabsf(errors[c]);
+			}
+		}
+	}
+	
+	float checksum = 0.0f;
+	
+	double start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			animation_sample_pose(animation, times[i] + tick * 16.0f, &pose);
+			checksum += pose.bones[0].local.angle;
+		}
+	}
+	double per_instance = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			baked_animation_sample_pose(&baked_animation, times[i] + tick * 16.0f, &pose);
+			checksum += pose.bones[0].local.angle;
+		}
+	}
+	double per_instance_baked = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			times[i] += 16.0f;
+		}
+		baked_animation_sample_batch(&baked_animation, times, instance_count, &batch);
+		checksum += batch.channels[transform_channel_angle][0];
+	}
+	double batched = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int lane = 0; lane < batch.bone_count * batch.stride; lane += POSE_BATCH_BLOCK) {
+			pose_batch_interpolate(&batch, baked_animation.channels, lane, POSE_BATCH_BLOCK);
+		}
+	}
+	double kernel = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int lane = 0; lane < batch.bone_count * batch.stride; lane += POSE_BATCH_BLOCK) {
+			pose_batch_interpolate_scalar(&batch, baked_animation.channels, lane, POSE_BATCH_BLOCK);
+		}
+	}
+	double kernel_scalar = bench_now() - start;
+	
+	double bones = (double)instance_count * tick_count * pose.bone_capacity;
+	fprintf(stderr, "instances:     %d x %d bones, max batch error %g\r\n", instance_count, pose.bone_capacity, max_error);
+	fprintf(stderr, "per instance:  %6.2f ns/bone\r\n", per_instance / bones * 1e9);
+	fprintf(stderr, "baked:         %6.2f ns/bone\r\n", per_instance_baked / bones * 1e9);
+	fprintf(stderr, "batch:         %6.2f ns/bone\r\n", batched / bones * 1e9);
+	fprintf(stderr, "kernel SIMD:   %6.2f ns/bone (%s)\r\n", kernel / bones * 1e9, pose_batch_kernel_name());
+	fprintf(stderr, "kernel scalar: %6.2f ns/bone\r\n", kernel_scalar / bones * 1e9);
+	fprintf(stderr, "checksum:      %g\r\n", checksum);
+	
+	free(times);
+	pose_batch_destroy(&batch);
+	pose_destroy(&pose);
+	baked_animation_destroy(&baked_animation);
+	spriter_data_destroy(&spriter_data);
+	remove(filepath);
+	
+	return 0;
+}
\ No newline at end of file
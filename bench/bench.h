@@ -0,0 +1,222 @@
+#pragma once
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Timer
+////////////////////////////////////////////////////////////////////////////////
+static inline double bench_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Output buffer
+////////////////////////////////////////////////////////////////////////////////
+struct bench_buffer {
+	char *data;
+	int length;
+	int capacity;
+};
+
+static inline void bench_buffer_printf(struct bench_buffer *buffer, const char *format, ...) {
+	va_list args;
+	
+	va_start(args, format);
+	int needed = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+	
+	if (buffer->length + needed + 1 > buffer->capacity) {
+		while (buffer->length + needed + 1 > buffer->capacity) {
+			buffer->capacity = (buffer->capacity == 0) ? 4096 : buffer->capacity * 2;
+		}
+		buffer->data = realloc(buffer->data, buffer->capacity);
+	}
+	
+	va_start(args, format);
+	vsnprintf(buffer->data + buffer->length, needed + 1, format, args);
+	va_end(args);
+	
+	buffer->length += needed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SCML generator
+////////////////////////////////////////////////////////////////////////////////
+struct scml_generator_options {
+	int entity_count;
+	int animation_count; // per entity
+	int timeline_count;  // per animation, the first bone_count are bone timelines
+	int bone_count;
+	int key_count;       // per timeline and on the mainline
+};
+
+static unsigned int bench_random_state = 1;
+
+static inline float bench_random_float(float min, float max) {
+	bench_random_state = bench_random_state * 1103515245u + 12345u;
+	return min + (max - min) * ((bench_random_state >> 8) & 0xffff) / 65535.0f;
+}
+
+// Produces a deterministic, Spriter-shaped SCML document, one tag per line
+// and indented with spaces so that every loader in the tree can read it. The
+// same options always give the same bytes.
+static inline char *scml_generate(struct scml_generator_options options, int *length) {
+	assert(options.bone_count <= options.timeline_count);
+	
+	struct bench_buffer out = { NULL, 0, 0 };
+	bench_random_state = 1;
+	
+	int object_count = options.timeline_count - options.bone_count;
+	int animation_length = 1000;
+	
+	bench_buffer_printf(&out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	bench_buffer_printf(&out, "<spriter_data scml_version=\"1.0\" generator=\"BrashMonkey Spriter\" generator_version=\"r11\">\n");
+	bench_buffer_printf(&out, "    <folder id=\"0\">\n");
+	for (int i = 0; i < object_count; i++) {
+		bench_buffer_printf(&out, "        <file id=\"%d\" name=\"part_%03d.png\" width=\"%d\" height=\"%d\" pivot_x=\"0.5\" pivot_y=\"%.6f\"/>\n",
+			i, i, 32 + i % 64, 32 + (i * 7) % 64, bench_random_float(0.0f, 1.0f));
+	}
+	bench_buffer_printf(&out, "    </folder>\n");
+	
+	for (int e = 0; e < options.entity_count; e++) {
+		bench_buffer_printf(&out, "    <entity id=\"%d\" name=\"entity_%03d\">\n", e, e);
+		
+		for (int a = 0; a < options.animation_count; a++) {
+			bench_buffer_printf(&out, "        <animation id=\"%d\" name=\"animation_%03d\" length=\"%d\" interval=\"100\">\n", a, a, animation_length);
+			
+			bench_buffer_printf(&out, "            <mainline>\n");
+			for (int k = 0; k < options.key_count; k++) {
+				int time = k * animation_length / options.key_count;
+				if (time == 0) {
+					bench_buffer_printf(&out, "                <key id=\"%d\">\n", k);
+				} else {
+					bench_buffer_printf(&out, "                <key id=\"%d\" time=\"%d\">\n", k, time);
+				}
+				for (int b = 0; b < options.bone_count; b++) {
+					if (b == 0) {
+						bench_buffer_printf(&out, "                    <bone_ref id=\"%d\" timeline=\"%d\" key=\"%d\"/>\n", b, b, k);
+					} else {
+						bench_buffer_printf(&out, "                    <bone_ref id=\"%d\" parent=\"%d\" timeline=\"%d\" key=\"%d\"/>\n", b, (b - 1) / 2, b, k);
+					}
+				}
+				for (int o = 0; o < object_count; o++) {
+					int timeline = options.bone_count + o;
+					if (options.bone_count > 0) {
+						bench_buffer_printf(&out, "                    <object_ref id=\"%d\" parent=\"%d\" timeline=\"%d\" key=\"%d\" z_index=\"%d\"/>\n", o, o % options.bone_count, timeline, k, o);
+					} else {
+						bench_buffer_printf(&out, "                    <object_ref id=\"%d\" timeline=\"%d\" key=\"%d\" z_index=\"%d\"/>\n", o, timeline, k, o);
+					}
+				}
+				bench_buffer_printf(&out, "                </key>\n");
+			}
+			bench_buffer_printf(&out, "            </mainline>\n");
+			
+			for (int t = 0; t < options.timeline_count; t++) {
+				bool is_bone = t < options.bone_count;
+				if (is_bone) {
+					bench_buffer_printf(&out, "            <timeline id=\"%d\" name=\"bone_%03d\" object_type=\"bone\">\n", t, t);
+				} else {
+					bench_buffer_printf(&out, "            <timeline id=\"%d\" name=\"part_%03d\">\n", t, t - options.bone_count);
+				}
+				for (int k = 0; k < options.key_count; k++) {
+					int time = k * animation_length / options.key_count;
+					int spin = (k % 3 == 2) ? -1 : 1;
+					if (time == 0) {
+						bench_buffer_printf(&out, "                <key id=\"%d\" spin=\"%d\">\n", k, spin);
+					} else {
+						bench_buffer_printf(&out, "                <key id=\"%d\" time=\"%d\" spin=\"%d\">\n", k, time, spin);
+					}
+					if (is_bone) {
+						bench_buffer_printf(&out, "                    <bone x=\"%.6f\" y=\"%.6f\" angle=\"%.6f\" scale_x=\"%.6f\" scale_y=\"%.6f\"/>\n",
+							bench_random_float(-50.0f, 50.0f), bench_random_float(-50.0f, 50.0f), bench_random_float(0.0f, 360.0f),
+							bench_random_float(0.5f, 1.5f), bench_random_float(0.5f, 1.5f));
+					} else {
+						int file = t - options.bone_count;
+						bench_buffer_printf(&out, "                    <object folder=\"0\" file=\"%d\" x=\"%.6f\" y=\"%.6f\" angle=\"%.6f\" scale_x=\"%.6f\" scale_y=\"%.6f\" a=\"%.6f\"/>\n",
+							file, bench_random_float(-50.0f, 50.0f), bench_random_float(-50.0f, 50.0f), bench_random_float(0.0f, 360.0f),
+							bench_random_float(0.5f, 1.5f), bench_random_float(0.5f, 1.5f), bench_random_float(0.0f, 1.0f));
+					}
+					bench_buffer_printf(&out, "                </key>\n");
+				}
+				bench_buffer_printf(&out, "            </timeline>\n");
+			}
+			
+			bench_buffer_printf(&out, "        </animation>\n");
+		}
+		
+		bench_buffer_printf(&out, "    </entity>\n");
+	}
+	
+	bench_buffer_printf(&out, "</spriter_data>\n");
+	
+	*length = out.length;
+	return out.data;
+}
+
+static inline void scml_generate_file(const char *filepath, struct scml_generator_options options) {
+	int length = 0;
+	char *data = scml_generate(options, &length);
+	
+	FILE *f = fopen(filepath, "wb");
+	assert(f != NULL);
+	fwrite(data, 1, length, f);
+	fclose(f);
+	
+	free(data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Comparison
+////////////////////////////////////////////////////////////////////////////////
+// Two rigs hold the same content when their binary caches (cache.h) have the
+// same bytes. Benches that compare include ../cache.c after the library
+// sources; the expected bytes come from spriter_cache_serialize on the result
+// of parse_spriter_buffer or parse_spriter_file.
+struct spriter_data;
+char *spriter_cache_serialize(struct spriter_data *spriter_data, int *length);
+
+static inline bool bench_spriter_data_matches(struct spriter_data *spriter_data, const char *expected, int expected_length) {
+	int length = 0;
+	char *data = spriter_cache_serialize(spriter_data, &length);
+	bool matches = (length == expected_length) && (memcmp(data, expected, length) == 0);
+	free(data);
+	return matches;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation counter
+////////////////////////////////////////////////////////////////////////////////
+// Library sources are included after this header, so the macros below route
+// their allocations through these counters.
+static long bench_allocation_count = 0;
+static long bench_allocation_bytes = 0;
+
+static inline void *bench_malloc(size_t size) {
+	bench_allocation_count++;
+	bench_allocation_bytes += size;
+	return malloc(size);
+}
+
+static inline void *bench_calloc(size_t count, size_t size) {
+	bench_allocation_count++;
+	bench_allocation_bytes += count * size;
+	return calloc(count, size);
+}
+
+static inline void *bench_realloc(void *ptr, size_t size) {
+	bench_allocation_count++;
+	bench_allocation_bytes += size;
+	return realloc(ptr, size);
+}
+
+#define malloc(size) bench_malloc(size)
+#define calloc(count, size) bench_calloc(count, size)
+#define realloc(ptr, size) bench_realloc(ptr, size)
@@ -0,0 +1,70 @@
+// Startup cost of a rig: parsing the SCML against opening its binary cache,
+// both in place and converted back to a spriter_data.
+//
+//   cc -O2 -o bench_cache bench/cache.c && ./bench_cache > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../cache.c"
+
+int main(int argc, char **argv) {
+	char *filepath = "bench_cache.scml";
+	char *cache_filepath = "bench_cache.sprc";
+	
+	struct scml_generator_options options;
+	options.entity_count = 4;
+	options.animation_count = 8;
+	options.timeline_count = 24;
+	options.bone_count = 12;
+	options.key_count = 16;
+	scml_generate_file(filepath, options);
+	
+	struct arena rig = arena_create(ARENA_DEFAULT_BLOCK_SIZE);
+	
+	struct spriter_data spriter_data = parse_spriter_file(filepath, &rig);
+	bool written = spriter_cache_write_file(&spriter_data, cache_filepath);
+	assert(written);
+	arena_reset(&rig);
+	
+	int iterations = 20;
+	double parse = 0.0;
+	double open = 0.0;
+	double convert = 0.0;
+	int cache_length = 0;
+	
+	for (int i = 0; i < iterations; i++) {
+		double start = bench_now();
+		spriter_data = parse_spriter_file(filepath, &rig);
+		parse += bench_now() - start;
+		arena_reset(&rig);
+		
+		start = bench_now();
+		struct spriter_cache cache = spriter_cache_open(cache_filepath);
+		open += bench_now() - start;
+		assert(cache.is_valid);
+		cache_length = cache.source.length;
+		
+		start = bench_now();
+		spriter_data = spriter_cache_to_spriter_data(&cache, &rig);
+		convert += bench_now() - start;
+		arena_reset(&rig);
+		
+		spriter_cache_close(&cache);
+	}
+	
+	arena_destroy(&rig);
+	
+	fprintf(stderr, "cache:           %.2f MB\r\n", cache_length / (1024.0 * 1024.0));
+	fprintf(stderr, "parse SCML:      %8.3f ms\r\n", parse * 1e3 / iterations);
+	fprintf(stderr, "open cache:      %8.3f ms (validated, used in place)\r\n", open * 1e3 / iterations);
+	fprintf(stderr, "cache to lists:  %8.3f ms\r\n", convert * 1e3 / iterations);
+	
+	remove(filepath);
+	remove(cache_filepath);
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+// Compressed pose tables against the pose tables they are built from: memory,
+// the quantization error bound of each channel next to the error measured on
+// and between frames, playback cost, and a compressing pose_table_cache given
+// the budget of the plain cache in bench/table.c.
+//
+//   cc -O2 -o bench_compress bench/compress.c -lm && ./bench_compress > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../runtime.c"
+#include "../bake.c"
+
+static void transform_errors(struct transform a, struct transform b, float *errors) {
+	float angle = fmodf(fabsf(a.angle - b.angle), 360.0f);
+	if (angle > 180.0f) angle = 360.0f - angle;
+	
+	float channel_errors[transform_channel_count] = { fabsf(a.x - b.x), fabsf(a.y - b.y), angle, fabsf(a.scale_x - b.scale_x), fabsf(a.scale_y - b.scale_y), fabsf(a.a - b.a) };
+	for (int c = 0; c < transform_channel_count; c++) {
+		if (channel_errors[c] > errors[c]) errors[c] = channel_errors[c];
+	}
+}
+
+static int pose_errors(struct pose *a, struct pose *b, float *errors) {
+	if ((a->bone_count != b->bone_count) || (a->object_count != b->object_count)) return 1;
+	
+	int mismatches = 0;
+	for (int i = 0; i < a->bone_count; i++) {
+		transform_errors(a->bones[i].local, b->bones[i].local, errors);
+		if (a->bones[i].parent != b->bones[i].parent) mismatches++;
+	}
+	for (int i = 0; i < a->object_count; i++) {
+		transform_errors(a->objects[i].local, b->objects[i].local, errors);
+		if (a->objects[i].file != b->objects[i].file) mismatches++;
+	}
+	
+	return mismatches;
+}
+
+static void print_errors(const char *label, float *errors) {
+	fprintf(stderr, "%s x %.2g, y %.2g, angle %.2g, scale_x %.2g, scale_y %.2g, a %.2g\r\n",
+		label, errors[0], errors[1], errors[2], errors[3], errors[4], errors[5]);
+}
+
+int main(int argc, char **argv) {
+	char *filepath = "bench_compress.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 8;
+	options.timeline_count = 32;
+	options.bone_count = 24;
+	options.key_count = 8;
+	scml_generate_file(filepath, options);
+	
+	struct spriter_data spriter_data = parse_spriter_file(filepath, NULL);
+	struct entity *entity = &spriter_data.entity_list.items[0];
+	struct animation *animation = &entity->animation_list.items[0];
+	
+	struct pose pose = pose_create_for_entity(entity, NULL);
+	struct pose expected = pose_create_for_entity(entity, NULL);
+	
+	float intervals[2] = { 0.0f, 1000.0f / 60.0f };
+	for (int i = 0; i < 2; i++) {
+		struct pose_table pose_table = pose_table_create(animation, intervals[i], NULL);
+		struct compressed_pose_table compressed = compressed_pose_table_create(&pose_table, NULL);
+		
+		float errors[transform_channel_count] = { 0 };
+		int mismatches = 0;
+		for (float time = -1000.0f; time < 2000.0f; time += 0.7f) {
+			pose_table_sample_pose(&pose_table, time, true, &expected);
+			compressed_pose_table_sample_pose(&compressed, time, true, &pose);
+			mismatches += pose_errors(&expected, &pose, errors);
+			
+			pose_table_sample_pose(&pose_table, time, false, &expected);
+			compressed_pose_table_sample_pose(&compressed, time, false, &pose);
+			mismatches += pose_errors(&expected, &pose, errors);
+		}
+		
+		size_t memory = pose_table_memory(animation, intervals[i]);
+		size_t compressed_memory = compressed_pose_table_memory(&compressed);
+		fprintf(stderr, "%6.2f ms:    %3d frames, %d of %d channels tracked, %zu -> %zu bytes (%.1fx), %d mismatches\r\n",
+			pose_table.frame_interval, pose_table.frame_count, compressed.track_count,
+			(pose_table.bone_capacity + pose_table.object_capacity) * transform_channel_count,
+			memory, compressed_memory, (double)memory / compressed_memory, mismatches);
+		print_errors("  bound:     ", compressed.error_bounds);
+		print_errors("  measured:  ", errors);
+		
+		compressed_pose_table_destroy(&compressed);
+		pose_table_destroy(&pose_table);
+	}
+	
+	int instance_count = 2000;
+	int tick_count = 100;
+	float *times = malloc(sizeof(float) * instance_count);
+	for (int i = 0; i < instance_count; i++) {
+		times[i] = bench_random_float(0.0f, 1000.0f);
+	}
+	
+	struct pose_table pose_table = pose_table_create(animation, 1000.0f / 60.0f, NULL);
+	struct compressed_pose_table compressed = compressed_pose_table_create(&pose_table, NULL);
+	float checksum = 0.0f;
+	
+	double start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			animation_sample_pose(animation, times[i] + tick * 16.0f, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double sampled = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			pose_table_sample_pose(&pose_table, times[i] + tick * 16.0f, true, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double lerped = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			compressed_pose_table_sample_pose(&compressed, times[i] + tick * 16.0f, true, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double decoded = bench_now() - start;
+	
+	double samples = (double)instance_count * tick_count;
+	fprintf(stderr, "sample:       %6.1f ns/pose\r\n", sampled / samples * 1e9);
+	fprintf(stderr, "table lerp:   %6.1f ns/pose\r\n", lerped / samples * 1e9);
+	fprintf(stderr, "compressed:   %6.1f ns/pose\r\n", decoded / samples * 1e9);
+	
+	// The scenario of bench/table.c: room for 4 plain tables, instances
+	// playing animations 0 to 3 and then 2 to 5. Compressed, all six fit.
+	size_t table_memory = pose_table_memory(animation, 0.0f);
+	struct pose_table_cache cache = pose_table_cache_create(table_memory * 4, true);
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		int first = (tick < tick_count / 2) ? 0 : 2;
+		for (int i = 0; i < instance_count; i++) {
+			struct animation *played = &entity->animation_list.items[first + i % 4];
+			pose_table_cache_sample_pose(&cache, played, times[i] + tick * 16.0f, true, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double cached = bench_now() - start;
+	
+	fprintf(stderr, "cache:        %6.1f ns/pose, %zu of %zu bytes, %lu hits, %lu misses, %lu evictions\r\n",
+		cached / samples * 1e9, cache.used, cache.budget, cache.hits, cache.misses, cache.evictions);
+	fprintf(stderr, "checksum:     %g\r\n", checksum);
+	
+	free(times);
+	pose_table_cache_destroy(&cache);
+	compressed_pose_table_destroy(&compressed);
+	pose_table_destroy(&pose_table);
+	pose_destroy(&expected);
+	pose_destroy(&pose);
+	spriter_data_destroy(&spriter_data);
+	remove(filepath);
+	
+	return 0;
+}
\ No newline at end of file
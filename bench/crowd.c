@@ -0,0 +1,106 @@
+// A crowd of 10,000 instances of two rigs stepped with crowd_update on 1 to 32
+// threads. Every instance switches animation with a crossfade now and then,
+// so batches are regrouped as the crowd plays. The pose checksum must not
+// change with the thread count. Speedups need as many free cores as threads.
+//
+//   cc -O2 -pthread -o bench_crowd bench/crowd.c -lm && ./bench_crowd
+#include "bench.h"
+
+// The allocation counters of bench.h are not thread safe.
+#undef malloc
+#undef calloc
+#undef realloc
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../runtime.c"
+#include "../bake.c"
+#include "../job.c"
+#include "../rig.c"
+#include "../crowd.c"
+
+#define INSTANCE_COUNT 10000
+#define TICK_COUNT 20
+
+static struct rig *bench_rig_create(int animation_count, int bone_count) {
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = animation_count;
+	options.timeline_count = bone_count + 8;
+	options.bone_count = bone_count;
+	options.key_count = 16;
+	
+	int length = 0;
+	char *buffer = scml_generate(options, &length);
+	struct rig *rig = rig_create(parse_spriter_buffer(buffer, length, NULL));
+	free(buffer);
+	
+	return rig;
+}
+
+static double crowd_checksum(struct crowd *crowd) {
+	double checksum = 0.0;
+	
+	for (int i = 0; i < crowd->length; i++) {
+		struct pose *pose = crowd_pose(crowd, i);
+		for (int b = 0; b < pose->bone_count; b++) {
+			checksum += pose->bones[b].world.x * (double)(b + 1) + pose->bones[b].world.angle;
+		}
+	}
+	
+	return checksum;
+}
+
+int main(int argc, char **argv) {
+	struct rig *rigs[2] = { bench_rig_create(6, 16), bench_rig_create(4, 24) };
+	
+	int thread_counts[6] = { 1, 2, 4, 8, 16, 32 };
+	double expected = 0.0;
+	double serial = 0.0;
+	
+	for (int t = 0; t < 6; t++) {
+		struct crowd crowd = crowd_create(INSTANCE_COUNT);
+		for (int i = 0; i < INSTANCE_COUNT; i++) {
+			struct rig *rig = rigs[i % 2];
+			struct rig_instance instance = rig_instance_create(rig, 0);
+			rig_instance_play(&instance, i % rig->baked_data.entities[0].animation_count, 0.0f);
+			rig_instance_update(&instance, (float)(i * 37 % 1000));
+			crowd_add(&crowd, instance);
+		}
+		
+		struct job_pool *pool = job_pool_create(thread_counts[t] - 1);
+		
+		double elapsed = 0.0;
+		for (int tick = 0; tick < TICK_COUNT; tick++) {
+			for (int i = tick % 9; i < crowd.length; i += 9) {
+				struct rig_instance *instance = crowd_instance(&crowd, i);
+				int animation_count = instance->rig->baked_data.entities[0].animation_count;
+				rig_instance_play(instance, (instance->animation + 1) % animation_count, 200.0f);
+			}
+			
+			double start = bench_now();
+			crowd_update(&crowd, pool, 1000.0f / 60.0f);
+			elapsed += bench_now() - start;
+		}
+		
+		double checksum = crowd_checksum(&crowd);
+		if (t == 0) {
+			expected = checksum;
+			serial = elapsed;
+		}
+		
+		fprintf(stderr, "%2d threads: %7.2f ms per update, %.2fx, %d batches, checksum %s\r\n", thread_counts[t], elapsed * 1e3 / TICK_COUNT,
+			serial / elapsed, crowd.batch_count, (checksum == expected) ? "ok" : "MISMATCH");
+		
+		job_pool_destroy(pool);
+		crowd_destroy(&crowd);
+	}
+	
+	rig_release(rigs[0]);
+	rig_release(rigs[1]);
+	
+	return 0;
+}
\ No newline at end of file
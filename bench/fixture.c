@@ -0,0 +1,216 @@
+// A small Spriter r11 rig with everything the builder must skip: <meta> with
+// <varline> and <tagline> keys in a timeline and an animation, <soundline>
+// keys holding an <object>, <eventline> keys, and the <obj_info>,
+// <character_map> and <var_defs> of an entity. The rig is loaded by
+// parse_spriter_buffer, parse_buffer + parse_tags, the push parser one byte at
+// a time and parse_spriter_buffer_parallel; the first must hold exactly the
+// authored keys, and the others must match it byte for byte. The bones of one
+// key are authored child first, to check every loader orders them the same
+// way while leaving their ids as written.
+//
+//   cc -O2 -pthread -o bench_fixture bench/fixture.c -lm && ./bench_fixture
+#include "bench.h"
+
+// The allocation counters of bench.h are not thread safe.
+#undef malloc
+#undef calloc
+#undef realloc
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../job.c"
+#include "../load.c"
+#include "../cache.c"
+
+static const char *fixture_scml =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<spriter_data scml_version=\"1.0\" generator=\"BrashMonkey Spriter\" generator_version=\"r11\">\n"
+	"    <folder id=\"0\">\n"
+	"        <file id=\"0\" name=\"body.png\" width=\"32\" height=\"64\" pivot_x=\"0.5\" pivot_y=\"0\"/>\n"
+	"    </folder>\n"
+	"    <entity id=\"0\" name=\"hero\">\n"
+	"        <obj_info name=\"bone_000\" type=\"bone\" w=\"100\" h=\"10\"/>\n"
+	"        <character_map id=\"0\" name=\"alt\">\n"
+	"            <map folder=\"0\" file=\"0\" target_folder=\"0\" target_file=\"0\"/>\n"
+	"        </character_map>\n"
+	"        <var_defs>\n"
+	"            <i id=\"0\" name=\"speed\" type=\"float\" default=\"0\"/>\n"
+	"        </var_defs>\n"
+	"        <animation id=\"0\" name=\"walk\" length=\"1000\" interval=\"100\">\n"
+	"            <mainline>\n"
+	"                <key id=\"0\">\n"
+	"                    <bone_ref id=\"0\" timeline=\"1\" key=\"0\"/>\n"
+	"                    <object_ref id=\"0\" parent=\"0\" timeline=\"0\" key=\"0\" z_index=\"0\"/>\n"
+	"                </key>\n"
+	"                <key id=\"1\" time=\"500\">\n"
+	"                    <bone_ref id=\"0\" timeline=\"1\" key=\"0\"/>\n"
+	"                    <object_ref id=\"0\" parent=\"0\" timeline=\"0\" key=\"1\" z_index=\"0\"/>\n"
+	"                </key>\n"
+	"            </mainline>\n"
+	"            <timeline id=\"0\" name=\"body\">\n"
+	"                <key id=\"0\" spin=\"1\">\n"
+	"                    <object folder=\"0\" file=\"0\" x=\"1\" y=\"2\" angle=\"10\"/>\n"
+	"                </key>\n"
+	"                <key id=\"1\" time=\"500\" spin=\"-1\">\n"
+	"                    <object folder=\"0\" file=\"0\" x=\"3\" y=\"4\" angle=\"350\"/>\n"
+	"                </key>\n"
+	"                <meta>\n"
+	"                    <varline id=\"0\" def=\"0\">\n"
+	"                        <key id=\"0\" time=\"0\" val=\"1\"/>\n"
+	"                        <key id=\"1\" time=\"250\" val=\"2\"/>\n"
+	"                    </varline>\n"
+	"                    <tagline>\n"
+	"                        <key id=\"0\" time=\"0\">\n"
+	"                            <tag id=\"0\" t=\"0\"/>\n"
+	"                        </key>\n"
+	"                    </tagline>\n"
+	"                </meta>\n"
+	"            </timeline>\n"
+	"            <timeline id=\"1\" name=\"bone_000\" object_type=\"bone\">\n"
+	"                <key id=\"0\">\n"
+	"                    <bone x=\"0\" y=\"0\" angle=\"90\"/>\n"
+	"                </key>\n"
+	"            </timeline>\n"
+	"            <soundline id=\"0\" name=\"steps\">\n"
+	"                <key id=\"0\" time=\"250\">\n"
+	"                    <object folder=\"1\" file=\"0\"/>\n"
+	"                </key>\n"
+	"            </soundline>\n"
+	"            <eventline id=\"0\" name=\"hit\">\n"
+	"                <key id=\"0\" time=\"750\"/>\n"
+	"            </eventline>\n"
+	"            <meta>\n"
+	"                <varline id=\"0\" def=\"0\">\n"
+	"                    <key id=\"0\" time=\"0\" val=\"5\"/>\n"
+	"                </varline>\n"
+	"            </meta>\n"
+	"        </animation>\n"
+	"        <animation id=\"1\" name=\"idle\" length=\"500\" interval=\"100\">\n"
+	"            <mainline>\n"
+	"                <key id=\"0\">\n"
+	"                    <bone_ref id=\"5\" parent=\"2\" timeline=\"1\" key=\"0\"/>\n"
+	"                    <bone_ref id=\"2\" timeline=\"1\" key=\"0\"/>\n"
+	"                    <object_ref id=\"0\" parent=\"5\" timeline=\"0\" key=\"0\" z_index=\"0\"/>\n"
+	"                </key>\n"
+	"            </mainline>\n"
+	"            <timeline id=\"0\" name=\"body\">\n"
+	"                <key id=\"0\">\n"
+	"                    <object folder=\"0\" file=\"0\"/>\n"
+	"                </key>\n"
+	"            </timeline>\n"
+	"            <timeline id=\"1\" name=\"bone_000\" object_type=\"bone\">\n"
+	"                <key id=\"0\">\n"
+	"                    <bone/>\n"
+	"                </key>\n"
+	"            </timeline>\n"
+	"            <eventline id=\"0\" name=\"blink\">\n"
+	"                <key id=\"0\" time=\"100\">\n"
+	"                    <object folder=\"0\" file=\"0\"/>\n"
+	"                </key>\n"
+	"            </eventline>\n"
+	"        </animation>\n"
+	"    </entity>\n"
+	"</spriter_data>\n";
+
+// The keys and transforms as authored, `timeline_keys[a][t]` keys on timeline
+// t of animation a, each with one object or bone.
+static bool fixture_matches_authored(struct spriter_data *spriter_data) {
+	int mainline_keys[2] = { 2, 1 };
+	int timeline_counts[2] = { 2, 2 };
+	int timeline_keys[2][2] = { { 2, 1 }, { 1, 1 } };
+	
+	if (spriter_data->entity_list.length != 1) return false;
+	struct animation_list *animations = &spriter_data->entity_list.items[0].animation_list;
+	if (animations->length != 2) return false;
+	
+	for (int a = 0; a < 2; a++) {
+		struct animation *animation = &animations->items[a];
+		if (animation->mainline.mainline_key_list.length != mainline_keys[a]) return false;
+		if (animation->timeline_list.length != timeline_counts[a]) return false;
+		
+		for (int t = 0; t < animation->timeline_list.length; t++) {
+			struct timeline_key_list *keys = &animation->timeline_list.items[t].timeline_key_list;
+			if (keys->length != timeline_keys[a][t]) return false;
+			
+			for (int k = 0; k < keys->length; k++) {
+				if (keys->items[k].object_list.length + keys->items[k].bone_list.length != 1) return false;
+			}
+		}
+	}
+	
+	return true;
+}
+
+// The bones of "idle" are authored child first; they must keep their ids and
+// be visited parents first all the same.
+static bool fixture_orders_bones(struct spriter_data *spriter_data) {
+	struct mainline_key *walk = &spriter_data->entity_list.items[0].animation_list.items[0].mainline.mainline_key_list.items[0];
+	struct mainline_key *idle = &spriter_data->entity_list.items[0].animation_list.items[1].mainline.mainline_key_list.items[0];
+	if (walk->bone_order != NULL) return false;
+	
+	struct bone_ref_list *bone_refs = &idle->bone_ref_list;
+	if ((bone_refs->length != 2) || (bone_refs->items[0].id != 5) || (bone_refs->items[1].id != 2)) return false;
+	if ((bone_refs->items[0].parent != 2) || (idle->object_ref_list.items[0].parent != 5)) return false;
+	
+	return (mainline_key_bone_ref_at(idle, 0) == 1) && (mainline_key_bone_ref_at(idle, 1) == 0) &&
+		(mainline_key_bone_parent(idle, 0) == -1) && (mainline_key_bone_parent(idle, 1) == 0) &&
+		(mainline_key_object_parent(idle, 0) == 1);
+}
+
+int main(int argc, char **argv) {
+	int length = (int)strlen(fixture_scml);
+	int failures = 0;
+	
+	struct spriter_data expected = parse_spriter_buffer(fixture_scml, length, NULL);
+	bool authored = fixture_matches_authored(&expected) && fixture_orders_bones(&expected);
+	struct timeline_key_list *body_keys = &expected.entity_list.items[0].animation_list.items[0].timeline_list.items[0].timeline_key_list;
+	fprintf(stderr, "buffer:      body keys=%d, key 1 objects=%d, %s\r\n", body_keys->length,
+		(body_keys->length > 1) ? body_keys->items[1].object_list.length : 0, authored ? "ok" : "MISMATCH");
+	if (!authored) failures++;
+	
+	int expected_length = 0;
+	char *expected_bytes = spriter_cache_serialize(&expected, &expected_length);
+	
+	struct tag_list tag_list = parse_buffer(fixture_scml, length, NULL);
+	struct spriter_data spriter_data = parse_tags(tag_list, NULL);
+	bool matches = bench_spriter_data_matches(&spriter_data, expected_bytes, expected_length) && fixture_orders_bones(&spriter_data);
+	fprintf(stderr, "parse_tags:  %s\r\n", matches ? "ok" : "MISMATCH");
+	if (!matches) failures++;
+	spriter_data_destroy(&spriter_data);
+	tag_list_destroy(&tag_list);
+	
+	struct spriter_push_parser parser = spriter_push_parser_create(NULL);
+	for (int i = 0; i < length; i++) {
+		spriter_push_parser_feed(&parser, fixture_scml + i, 1);
+	}
+	bool complete = false;
+	spriter_data = spriter_push_parser_finish(&parser, &complete);
+	matches = complete && bench_spriter_data_matches(&spriter_data, expected_bytes, expected_length) && fixture_orders_bones(&spriter_data);
+	fprintf(stderr, "push:        %s\r\n", matches ? "ok" : "MISMATCH");
+	if (!matches) failures++;
+	spriter_data_destroy(&spriter_data);
+	
+	struct job_pool *pool = job_pool_create(1);
+	spriter_data = parse_spriter_buffer_parallel(pool, fixture_scml, length, NULL);
+	matches = bench_spriter_data_matches(&spriter_data, expected_bytes, expected_length) && fixture_orders_bones(&spriter_data);
+	fprintf(stderr, "parallel:    %s\r\n", matches ? "ok" : "MISMATCH");
+	if (!matches) failures++;
+	spriter_data_destroy(&spriter_data);
+	job_pool_destroy(pool);
+	
+	struct spriter_cache cache = spriter_cache_from_buffer(expected_bytes, expected_length);
+	spriter_data = spriter_cache_to_spriter_data(&cache, NULL);
+	matches = fixture_orders_bones(&spriter_data);
+	fprintf(stderr, "cache:       %s\r\n", matches ? "ok" : "MISMATCH");
+	if (!matches) failures++;
+	spriter_data_destroy(&spriter_data);
+	spriter_cache_close(&cache);
+	
+	free(expected_bytes);
+	spriter_data_destroy(&expected);
+	
+	return (failures == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+// World transform resolution on large rigs: sampling alone against sampling
+// followed by the linear parent-ordered pass of pose_compute_world.
+//
+//   cc -O2 -o bench_hierarchy bench/hierarchy.c -lm && ./bench_hierarchy > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../runtime.c"
+
+static void run(int bone_count) {
+	char *filepath = "bench_hierarchy.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 1;
+	options.timeline_count = bone_count + 8;
+	options.bone_count = bone_count;
+	options.key_count = 8;
+	scml_generate_file(filepath, options);
+	
+	struct spriter_data spriter_data = parse_spriter_file(filepath, NULL);
+	struct entity *entity = &spriter_data.entity_list.items[0];
+	struct pose pose = pose_create_for_entity(entity, NULL);
+	
+	int samples = 200000 / bone_count;
+	float checksum = 0.0f;
+	
+	double start = bench_now();
+	for (int i = 0; i < samples; i++) {
+		entity_sample_pose(entity, 0, i * 3.0f, &pose);
+		checksum += pose.bones[bone_count - 1].local.x;
+	}
+	double sample_only = (bench_now() - start) / samples;
+	
+	start = bench_now();
+	for (int i = 0; i < samples; i++) {
+		entity_sample_pose(entity, 0, i * 3.0f, &pose);
+		pose_compute_world(&pose);
+		checksum += pose.bones[bone_count - 1].world.x;
+	}
+	double sample_world = (bench_now() - start) / samples;
+	
+	fprintf(stderr, "%3d bones: sample %7.2f us, sample + world %7.2f us, world pass %5.1f ns/bone (checksum %g)\r\n",
+		bone_count, sample_only * 1e6, sample_world * 1e6, (sample_world - sample_only) / bone_count * 1e9, checksum);
+	
+	pose_destroy(&pose);
+	spriter_data_destroy(&spriter_data);
+	remove(filepath);
+}
+
+int main(int argc, char **argv) {
+	run(50);
+	run(100);
+	run(200);
+	
+	return 0;
+}
\ No newline at end of file
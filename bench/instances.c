@@ -0,0 +1,134 @@
+// Many copies of one character: the memory of one spriter_data per copy
+// against one shared rig plus a rig_instance per copy, then every instance
+// updated and sampled on 1, 2, 4 and one thread per processor, all reading the
+// same rig. Instances switch animations with a crossfade now and then. The
+// checksum must not change with the thread count.
+//
+//   cc -O2 -pthread -o bench_instances bench/instances.c -lm && ./bench_instances
+#include "bench.h"
+
+// The allocation counters of bench.h are not thread safe.
+#undef malloc
+#undef calloc
+#undef realloc
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../runtime.c"
+#include "../bake.c"
+#include "../job.c"
+#include "../rig.c"
+
+#define INSTANCE_COUNT 5000
+#define TICK_COUNT 20
+#define JOB_COUNT 64
+
+struct instances_job {
+	struct rig_instance *instances;
+	int count;
+	int animation_count;
+	double checksum;
+};
+
+static void instances_job_run(void *user_data) {
+	struct instances_job *job = user_data;
+	
+	struct pose pose = rig_instance_pose_create(&job->instances[0], NULL);
+	struct pose scratch = rig_instance_pose_create(&job->instances[0], NULL);
+	
+	job->checksum = 0.0;
+	for (int tick = 0; tick < TICK_COUNT; tick++) {
+		for (int i = 0; i < job->count; i++) {
+			struct rig_instance *instance = &job->instances[i];
+			
+			if ((tick + i) % 7 == 0) rig_instance_play(instance, (instance->animation + 1) % job->animation_count, 150.0f);
+			rig_instance_update(instance, 1000.0f / 60.0f);
+			rig_instance_sample_pose(instance, &pose, &scratch);
+			pose_compute_world(&pose);
+			
+			for (int b = 0; b < pose.bone_count; b++) {
+				job->checksum += pose.bones[b].world.x;
+			}
+		}
+	}
+	
+	pose_destroy(&scratch);
+	pose_destroy(&pose);
+}
+
+int main(int argc, char **argv) {
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 4;
+	options.timeline_count = 24;
+	options.bone_count = 16;
+	options.key_count = 16;
+	
+	int length = 0;
+	char *buffer = scml_generate(options, &length);
+	
+	struct spriter_data spriter_data = parse_spriter_buffer(buffer, length, NULL);
+	size_t copy_memory = spriter_data_memory(&spriter_data);
+	struct rig *rig = rig_create(spriter_data);
+	free(buffer);
+	
+	size_t copies = copy_memory * INSTANCE_COUNT;
+	size_t shared = rig->memory + sizeof(struct rig_instance) * INSTANCE_COUNT;
+	fprintf(stderr, "%d copies:          %8.2f MB, %zu bytes each\r\n", INSTANCE_COUNT, copies / (1024.0 * 1024.0), copy_memory);
+	fprintf(stderr, "1 rig + %d instances: %6.2f MB, rig %zu bytes, %zu bytes per instance\r\n", INSTANCE_COUNT, shared / (1024.0 * 1024.0), rig->memory, sizeof(struct rig_instance));
+	
+	struct rig_instance *instances = malloc(sizeof(struct rig_instance) * INSTANCE_COUNT);
+	struct instances_job jobs[JOB_COUNT];
+	int per_job = (INSTANCE_COUNT + JOB_COUNT - 1) / JOB_COUNT;
+	
+	int thread_counts[4] = { 1, 2, 4, job_pool_default_thread_count() };
+	double expected = 0.0;
+	double serial = 0.0;
+	for (int t = 0; t < 4; t++) {
+		for (int i = 0; i < INSTANCE_COUNT; i++) {
+			instances[i] = rig_instance_create(rig, 0);
+			rig_instance_play(&instances[i], i % options.animation_count, 0.0f);
+			rig_instance_update(&instances[i], (float)(i * 37 % 1000));
+		}
+		
+		struct job_pool *pool = job_pool_create(thread_counts[t] - 1);
+		struct job_group group = job_group_create();
+		
+		double start = bench_now();
+		for (int j = 0; j < JOB_COUNT; j++) {
+			int first = j * per_job;
+			int count = (first + per_job <= INSTANCE_COUNT) ? per_job : INSTANCE_COUNT - first;
+			jobs[j].instances = &instances[first];
+			jobs[j].count = (count > 0) ? count : 0;
+			jobs[j].animation_count = options.animation_count;
+			if (jobs[j].count > 0) job_pool_submit(pool, &group, instances_job_run, &jobs[j]);
+		}
+		job_pool_wait(pool, &group);
+		double elapsed = bench_now() - start;
+		job_pool_destroy(pool);
+		
+		double checksum = 0.0;
+		for (int j = 0; j < JOB_COUNT; j++) {
+			if (jobs[j].count > 0) checksum += jobs[j].checksum;
+		}
+		if (t == 0) {
+			expected = checksum;
+			serial = elapsed;
+		}
+		
+		fprintf(stderr, "%2d threads: %7.2f ms for %d ticks, %.2fx, checksum %s\r\n", thread_counts[t], elapsed * 1e3, TICK_COUNT, serial / elapsed, (checksum == expected) ? "ok" : "MISMATCH");
+		
+		for (int i = 0; i < INSTANCE_COUNT; i++) {
+			rig_instance_destroy(&instances[i]);
+		}
+	}
+	
+	fprintf(stderr, "references left: %d\r\n", rig->references);
+	rig_release(rig);
+	free(instances);
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+// Mainline key lookup on a long animation: a linear scan, the binary search of
+// animation_find_mainline_key, and a per-instance animation_cursor, for
+// instances playing forward (wrapping around the end) at two frame steps. All
+// three are first checked against each other over playback and random seeks.
+//
+//   cc -O2 -o bench_keys bench/keys.c -lm && ./bench_keys > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../runtime.c"
+
+static int find_mainline_key_linear(struct animation *animation, float time) {
+	struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+	int found = 0;
+	
+	for (int i = 1; i < mainline_keys->length; i++) {
+		if ((float)mainline_keys->items[i].time > time) break;
+		found = i;
+	}
+	
+	return found;
+}
+
+static float wrap(float time) {
+	time = fmodf(time, 1000.0f);
+	return (time < 0.0f) ? time + 1000.0f : time;
+}
+
+static void run(struct animation *animation, float *times, struct animation_cursor *cursors, int instance_count, float step) {
+	int tick_count = 200;
+	long checksum = 0;
+	
+	double start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			checksum += find_mainline_key_linear(animation, wrap(times[i] + tick * step));
+		}
+	}
+	double linear = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			checksum += animation_find_mainline_key(animation, wrap(times[i] + tick * step));
+		}
+	}
+	double binary = bench_now() - start;
+	
+	for (int i = 0; i < instance_count; i++) {
+		animation_cursor_reset(&cursors[i]);
+	}
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			checksum += animation_cursor_find_mainline_key(&cursors[i], animation, wrap(times[i] + tick * step));
+		}
+	}
+	double cursor = bench_now() - start;
+	
+	double lookups = (double)instance_count * tick_count;
+	fprintf(stderr, "step %4.0f ms: linear %6.1f ns, binary %5.1f ns, cursor %5.1f ns (checksum %ld)\r\n",
+		step, linear / lookups * 1e9, binary / lookups * 1e9, cursor / lookups * 1e9, checksum);
+}
+
+int main(int argc, char **argv) {
+	char *filepath = "bench_keys.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 1;
+	options.timeline_count = 1;
+	options.bone_count = 1;
+	options.key_count = 500;
+	scml_generate_file(filepath, options);
+	
+	struct spriter_data spriter_data = parse_spriter_file(filepath, NULL);
+	struct animation *animation = &spriter_data.entity_list.items[0].animation_list.items[0];
+	
+	int instance_count = 1000;
+	float *times = malloc(sizeof(float) * instance_count);
+	struct animation_cursor *cursors = malloc(sizeof(struct animation_cursor) * instance_count);
+	for (int i = 0; i < instance_count; i++) {
+		times[i] = bench_random_float(0.0f, 1000.0f);
+		cursors[i] = animation_cursor_create();
+	}
+	
+	// Playback with a seek every 37 frames, forwards or backwards.
+	int mismatches = 0;
+	struct animation_cursor cursor = animation_cursor_create();
+	float time = 0.0f;
+	for (int frame = 0; frame < 100000; frame++) {
+		time = (frame % 37 == 0) ? bench_random_float(-3000.0f, 3000.0f) : time + bench_random_float(0.0f, 40.0f);
+		float wrapped = wrap(time);
+		int expected = find_mainline_key_linear(animation, wrapped);
+		if (animation_find_mainline_key(animation, wrapped) != expected) mismatches++;
+		if (animation_cursor_find_mainline_key(&cursor, animation, wrapped) != expected) mismatches++;
+	}
+	fprintf(stderr, "keys:        %d mainline keys, %d mismatches\r\n", animation->mainline.mainline_key_list.length, mismatches);
+	
+	run(animation, times, cursors, instance_count, 1.0f);
+	run(animation, times, cursors, instance_count, 16.0f);
+	
+	free(times);
+	free(cursors);
+	spriter_data_destroy(&spriter_data);
+	remove(filepath);
+	
+	return 0;
+}
\ No newline at end of file
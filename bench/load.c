@@ -0,0 +1,90 @@
+// Loading a set of rigs of mixed sizes one after the other, then with
+// spriter_batch_load on 1, 2, 4 and one thread per processor. Every batch is
+// checked against the serial load. Speedups need as many free cores as
+// threads.
+//
+//   cc -O2 -pthread -o bench_load bench/load.c -lm && ./bench_load > /dev/null
+#include "bench.h"
+
+// The allocation counters of bench.h are not thread safe.
+#undef malloc
+#undef calloc
+#undef realloc
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../job.c"
+#include "../load.c"
+#include "../cache.c"
+
+#define FILE_COUNT 24
+
+int main(int argc, char **argv) {
+	char *filepaths[FILE_COUNT];
+	char names[FILE_COUNT][32];
+	
+	// A few large rigs among many small ones, as in a level.
+	for (int i = 0; i < FILE_COUNT; i++) {
+		struct scml_generator_options options;
+		options.entity_count = 1;
+		options.animation_count = (i % 6 == 0) ? 24 : 4;
+		options.timeline_count = 24;
+		options.bone_count = 16;
+		options.key_count = 16;
+		
+		snprintf(names[i], sizeof(names[i]), "bench_load_%02d.scml", i);
+		filepaths[i] = names[i];
+		scml_generate_file(filepaths[i], options);
+	}
+	
+	char *expected[FILE_COUNT];
+	int expected_lengths[FILE_COUNT];
+	double serial = 0.0;
+	for (int i = 0; i < FILE_COUNT; i++) {
+		double start = bench_now();
+		struct spriter_data spriter_data = parse_spriter_file(filepaths[i], NULL);
+		serial += bench_now() - start;
+		
+		expected[i] = spriter_cache_serialize(&spriter_data, &expected_lengths[i]);
+		spriter_data_destroy(&spriter_data);
+	}
+	fprintf(stderr, "serial:      %7.2f ms\r\n", serial * 1e3);
+	
+	int thread_counts[4] = { 1, 2, 4, job_pool_default_thread_count() };
+	for (int t = 0; t < 4; t++) {
+		double start = bench_now();
+		struct spriter_batch batch = spriter_batch_load(filepaths, FILE_COUNT, thread_counts[t], NULL);
+		double elapsed = bench_now() - start;
+		
+		int mismatches = 0;
+		for (int i = 0; i < FILE_COUNT; i++) {
+			if (batch.statuses[i] != spriter_load_status_ok) mismatches++;
+			else if (!bench_spriter_data_matches(&batch.items[i], expected[i], expected_lengths[i])) mismatches++;
+		}
+		
+		fprintf(stderr, "%2d threads:  %7.2f ms, %.2fx, %d mismatches\r\n", thread_counts[t], elapsed * 1e3, serial / elapsed, mismatches);
+		spriter_batch_destroy(&batch);
+	}
+	
+	char *missing[2] = { filepaths[0], "bench_load_missing.scml" };
+	struct spriter_batch batch = spriter_batch_load(missing, 2, 2, NULL);
+	fprintf(stderr, "statuses:    %s, %s\r\n", spriter_load_status_name(batch.statuses[0]), spriter_load_status_name(batch.statuses[1]));
+	spriter_batch_destroy(&batch);
+	
+	struct job_pool *pool = job_pool_create(1);
+	enum spriter_load_status status = spriter_load_status_ok;
+	struct spriter_data spriter_data = parse_spriter_file_parallel(pool, missing[1], NULL, &status);
+	fprintf(stderr, "parallel:    %s, %d entities\r\n", spriter_load_status_name(status), spriter_data.entity_list.length);
+	spriter_data_destroy(&spriter_data);
+	job_pool_destroy(pool);
+	
+	for (int i = 0; i < FILE_COUNT; i++) {
+		free(expected[i]);
+		remove(filepaths[i]);
+	}
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+// string_to_float / string_to_int against the atof / atoi they replace, on
+// every numeric attribute value of a generated rig, one value at a time and
+// through the batch string_to_floats. Every value is checked against strtof.
+//
+//   cc -O2 -o bench_numbers bench/numbers.c -lm && ./bench_numbers > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+
+#define RUNS 20
+
+struct number_spans {
+	int float_count;
+	int int_count;
+	int capacity;
+	struct string_view *floats;
+	struct string_view *ints;
+};
+
+static void number_spans_on_attribute(void *user_data, enum attribute_types attribute_type, struct string_view name, struct string_view value) {
+	struct number_spans *spans = user_data;
+	(void)name;
+	
+	if (spans->float_count == spans->capacity || spans->int_count == spans->capacity) {
+		spans->capacity = (spans->capacity == 0) ? 1024 : spans->capacity * 2;
+		spans->floats = realloc(spans->floats, sizeof(struct string_view) * spans->capacity);
+		spans->ints = realloc(spans->ints, sizeof(struct string_view) * spans->capacity);
+	}
+	
+	switch (attribute_type) {
+		case attribute_type_x:
+		case attribute_type_y:
+		case attribute_type_angle:
+		case attribute_type_scale_x:
+		case attribute_type_scale_y:
+		case attribute_type_a:
+		case attribute_type_pivot_x:
+		case attribute_type_pivot_y:
+			spans->floats[spans->float_count++] = value;
+			break;
+		case attribute_type_id:
+		case attribute_type_time:
+		case attribute_type_key:
+		case attribute_type_timeline:
+		case attribute_type_parent:
+		case attribute_type_spin:
+		case attribute_type_z_index:
+		case attribute_type_file:
+		case attribute_type_folder:
+			spans->ints[spans->int_count++] = value;
+			break;
+		default:
+			break;
+	}
+}
+
+// What string_to_float and string_to_int did before.
+static float legacy_to_float(struct string_view view) {
+	char terminated[64];
+	int length = view.length < 64 ? view.length : 63;
+	memcpy(terminated, view.characters, length);
+	terminated[length] = '\0';
+	return atof(terminated);
+}
+
+static int legacy_to_int(struct string_view view) {
+	char terminated[64];
+	int length = view.length < 64 ? view.length : 63;
+	memcpy(terminated, view.characters, length);
+	terminated[length] = '\0';
+	return atoi(terminated);
+}
+
+static float exact_to_float(struct string_view view) {
+	char terminated[64];
+	int length = view.length < 64 ? view.length : 63;
+	memcpy(terminated, view.characters, length);
+	terminated[length] = '\0';
+	return strtof(terminated, NULL);
+}
+
+int main(int argc, char **argv) {
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 8;
+	options.timeline_count = 24;
+	options.bone_count = 12;
+	options.key_count = 32;
+	
+	int length = 0;
+	char *buffer = scml_generate(options, &length);
+	
+	struct number_spans spans;
+	memset(&spans, 0, sizeof(struct number_spans));
+	
+	struct xml_handler handler;
+	memset(&handler, 0, sizeof(struct xml_handler));
+	handler.user_data = &spans;
+	handler.on_attribute = number_spans_on_attribute;
+	parse_buffer_stream(buffer, length, &handler);
+	fprintf(stderr, "values:        %d floats, %d ints\r\n", spans.float_count, spans.int_count);
+	
+	float *values = malloc(sizeof(float) * spans.float_count);
+	int *ints = malloc(sizeof(int) * spans.int_count);
+	
+	int rounding_errors = 0;
+	int legacy_rounding_errors = 0;
+	for (int i = 0; i < spans.float_count; i++) {
+		float exact = exact_to_float(spans.floats[i]);
+		if (string_to_float(spans.floats[i]) != exact) rounding_errors++;
+		if (legacy_to_float(spans.floats[i]) != exact) legacy_rounding_errors++;
+	}
+	int int_errors = 0;
+	for (int i = 0; i < spans.int_count; i++) {
+		if (string_to_int(spans.ints[i]) != legacy_to_int(spans.ints[i])) int_errors++;
+	}
+	fprintf(stderr, "misrounded:    %d (atof: %d), ints differing: %d\r\n", rounding_errors, legacy_rounding_errors, int_errors);
+	
+	double start = bench_now();
+	for (int r = 0; r < RUNS; r++) {
+		for (int i = 0; i < spans.float_count; i++) values[i] = legacy_to_float(spans.floats[i]);
+	}
+	double legacy = (bench_now() - start) / RUNS;
+	
+	start = bench_now();
+	for (int r = 0; r < RUNS; r++) {
+		for (int i = 0; i < spans.float_count; i++) values[i] = string_to_float(spans.floats[i]);
+	}
+	double single = (bench_now() - start) / RUNS;
+	
+	start = bench_now();
+	for (int r = 0; r < RUNS; r++) {
+		string_to_floats(spans.floats, values, spans.float_count);
+	}
+	double batch = (bench_now() - start) / RUNS;
+	
+	fprintf(stderr, "atof:          %6.1f ns per value\r\n", legacy * 1e9 / spans.float_count);
+	fprintf(stderr, "string_to_float: %4.1f ns per value, %.1fx\r\n", single * 1e9 / spans.float_count, legacy / single);
+	fprintf(stderr, "string_to_floats: %3.1f ns per value, %.1fx\r\n", batch * 1e9 / spans.float_count, legacy / batch);
+	
+	start = bench_now();
+	for (int r = 0; r < RUNS; r++) {
+		for (int i = 0; i < spans.int_count; i++) ints[i] = legacy_to_int(spans.ints[i]);
+	}
+	legacy = (bench_now() - start) / RUNS;
+	
+	start = bench_now();
+	for (int r = 0; r < RUNS; r++) {
+		string_to_ints(spans.ints, ints, spans.int_count);
+	}
+	batch = (bench_now() - start) / RUNS;
+	
+	fprintf(stderr, "atoi:          %6.1f ns per value\r\n", legacy * 1e9 / spans.int_count);
+	fprintf(stderr, "string_to_ints: %5.1f ns per value, %.1fx\r\n", batch * 1e9 / spans.int_count, legacy / batch);
+	
+	fprintf(stderr, "checksum:      %f %d\r\n", values[spans.float_count - 1], ints[spans.int_count - 1]);
+	
+	free(values);
+	free(ints);
+	free(spans.floats);
+	free(spans.ints);
+	free(buffer);
+	
+	return 0;
+}
\ No newline at end of file
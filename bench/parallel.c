@@ -0,0 +1,88 @@
+// One large file parsed by parse_spriter_buffer, then by
+// parse_spriter_buffer_parallel on 1, 2, 4 and one thread per processor, into
+// the heap and into an arena. Every result is checked against the serial
+// parse. Speedups need as many free cores as threads.
+//
+//   cc -O2 -pthread -o bench_parallel bench/parallel.c -lm && ./bench_parallel > /dev/null
+#include "bench.h"
+
+// The allocation counters of bench.h are not thread safe.
+#undef malloc
+#undef calloc
+#undef realloc
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../job.c"
+#include "../load.c"
+#include "../cache.c"
+
+#define RUNS 5
+
+int main(int argc, char **argv) {
+	struct scml_generator_options options;
+	options.entity_count = 2;
+	options.animation_count = 64;
+	options.timeline_count = 24;
+	options.bone_count = 16;
+	options.key_count = 16;
+	
+	int length = 0;
+	char *buffer = scml_generate(options, &length);
+	fprintf(stderr, "file:        %.2f MB, %d animations\r\n", length / 1e6, options.entity_count * options.animation_count);
+	
+	int start, end, count = 0;
+	double scan_start = bench_now();
+	for (int i = 0; find_element(buffer, length, i, "animation", &start, &end); i = end) count++;
+	fprintf(stderr, "split:       %7.2f ms, %d animations found\r\n", (bench_now() - scan_start) * 1e3, count);
+	
+	struct spriter_data expected_data = parse_spriter_buffer(buffer, length, NULL);
+	int expected_length = 0;
+	char *expected = spriter_cache_serialize(&expected_data, &expected_length);
+	spriter_data_destroy(&expected_data);
+	
+	double serial = 1e30;
+	for (int r = 0; r < RUNS; r++) {
+		double run_start = bench_now();
+		struct spriter_data spriter_data = parse_spriter_buffer(buffer, length, NULL);
+		double elapsed = bench_now() - run_start;
+		if (elapsed < serial) serial = elapsed;
+		spriter_data_destroy(&spriter_data);
+	}
+	fprintf(stderr, "serial:      %7.2f ms\r\n", serial * 1e3);
+	
+	struct arena arena = arena_create(ARENA_DEFAULT_BLOCK_SIZE);
+	int thread_counts[4] = { 1, 2, 4, job_pool_default_thread_count() };
+	for (int t = 0; t < 4; t++) {
+		struct job_pool *pool = job_pool_create(thread_counts[t] - 1);
+		
+		for (int use_arena = 0; use_arena < 2; use_arena++) {
+			double best = 1e30;
+			int mismatches = 0;
+			
+			for (int r = 0; r < RUNS; r++) {
+				double run_start = bench_now();
+				struct spriter_data spriter_data = parse_spriter_buffer_parallel(pool, buffer, length, use_arena ? &arena : NULL);
+				double elapsed = bench_now() - run_start;
+				if (elapsed < best) best = elapsed;
+				
+				if (!bench_spriter_data_matches(&spriter_data, expected, expected_length)) mismatches++;
+				spriter_data_destroy(&spriter_data);
+				arena_reset(&arena);
+			}
+			
+			fprintf(stderr, "%2d threads %s: %7.2f ms, %.2fx, %d mismatches\r\n", thread_counts[t], use_arena ? "arena" : "heap ", best * 1e3, serial / best, mismatches);
+		}
+		
+		job_pool_destroy(pool);
+	}
+	
+	arena_destroy(&arena);
+	free(expected);
+	free(buffer);
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+// The push parser fed a rig in chunks of 1 byte to the whole file, against
+// parse_spriter_buffer on the same bytes. Every chunked result is checked
+// against the buffer one, and the carry shows the memory the push parser held
+// beyond the chunk itself. A small rig with a comment and quoted '>' is then
+// fed in two chunks split at every byte, so each of them straddles a boundary.
+//
+//   cc -O2 -o bench_push bench/push.c -lm && ./bench_push
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../cache.c"
+
+// Markup characters where a naive scan for the end of a tag would stop early.
+static const char *tricky_scml =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<spriter_data scml_version=\"1.0\" generator=\"BrashMonkey Spriter\" generator_version=\"r11\">\n"
+	"    <!-- a comment with <tags/> and a > inside -->\n"
+	"    <folder id=\"0\">\n"
+	"        <file id=\"0\" name=\"parts/a>b.png\" width=\"10\" height=\"20\" pivot_x=\"0\" pivot_y=\"1\"/>\n"
+	"    </folder>\n"
+	"    <entity id=\"0\" name=\"entity > 0\">\n"
+	"        <animation id=\"0\" name=\"idle\" length=\"1000\" interval=\"100\">\n"
+	"            <mainline>\n"
+	"                <key id=\"0\">\n"
+	"                    <object_ref id=\"0\" timeline=\"0\" key=\"0\" z_index=\"0\"/>\n"
+	"                </key>\n"
+	"            </mainline>\n"
+	"            <!-- > -->\n"
+	"            <timeline id=\"0\" name=\"a > b\">\n"
+	"                <key id=\"0\" spin=\"0\">\n"
+	"                    <object folder=\"0\" file=\"0\" x=\"1\" y=\"2\"/>\n"
+	"                </key>\n"
+	"            </timeline>\n"
+	"        </animation>\n"
+	"    </entity>\n"
+	"</spriter_data>\n";
+
+int main(int argc, char **argv) {
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 32;
+	options.timeline_count = 32;
+	options.bone_count = 16;
+	options.key_count = 32;
+	
+	int length = 0;
+	char *buffer = scml_generate(options, &length);
+	double megabytes = length / (1024.0 * 1024.0);
+	
+	double start = bench_now();
+	struct spriter_data expected = parse_spriter_buffer(buffer, length, NULL);
+	double elapsed = bench_now() - start;
+	int expected_length = 0;
+	char *expected_bytes = spriter_cache_serialize(&expected, &expected_length);
+	fprintf(stderr, "buffer:        %7.2f ms, %7.1f MB/s (%.2f MB)\r\n", elapsed * 1e3, megabytes / elapsed, megabytes);
+	
+	int chunk_sizes[6] = { 1, 61, 4096, 65536, 1 << 20, length };
+	for (int c = 0; c < 6; c++) {
+		int chunk_size = chunk_sizes[c];
+		
+		start = bench_now();
+		struct spriter_push_parser parser = spriter_push_parser_create(NULL);
+		for (int i = 0; i < length; i += chunk_size) {
+			spriter_push_parser_feed(&parser, buffer + i, (i + chunk_size <= length) ? chunk_size : length - i);
+		}
+		int carry_capacity = parser.xml.carry_capacity;
+		
+		bool complete = false;
+		struct spriter_data spriter_data = spriter_push_parser_finish(&parser, &complete);
+		elapsed = bench_now() - start;
+		
+		bool matches = complete && bench_spriter_data_matches(&spriter_data, expected_bytes, expected_length);
+		fprintf(stderr, "%7d bytes: %7.2f ms, %7.1f MB/s, carry %5d bytes, %s\r\n", chunk_size, elapsed * 1e3, megabytes / elapsed,
+			carry_capacity, matches ? "ok" : "MISMATCH");
+		spriter_data_destroy(&spriter_data);
+	}
+	
+	spriter_data_destroy(&expected);
+	free(expected_bytes);
+	free(buffer);
+	
+	int tricky_length = (int)strlen(tricky_scml);
+	struct spriter_data tricky = parse_spriter_buffer(tricky_scml, tricky_length, NULL);
+	expected_bytes = spriter_cache_serialize(&tricky, &expected_length);
+	
+	int mismatches = 0;
+	for (int split = 1; split < tricky_length; split++) {
+		struct spriter_push_parser parser = spriter_push_parser_create(NULL);
+		spriter_push_parser_feed(&parser, tricky_scml, split);
+		spriter_push_parser_feed(&parser, tricky_scml + split, tricky_length - split);
+		
+		bool complete = false;
+		struct spriter_data spriter_data = spriter_push_parser_finish(&parser, &complete);
+		if (!complete || !bench_spriter_data_matches(&spriter_data, expected_bytes, expected_length)) mismatches++;
+		spriter_data_destroy(&spriter_data);
+	}
+	fprintf(stderr, "every split:   %d splits, entity \"%s\", %d mismatches\r\n", tricky_length - 1,
+		tricky.entity_list.items[0].name.characters, mismatches);
+	
+	spriter_data_destroy(&tricky);
+	free(expected_bytes);
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+// Pose sampling throughput: many instances of one rig, each at its own time,
+// sampled tick after tick into one preallocated pose.
+//
+//   cc -O2 -o bench_runtime bench/runtime.c -lm && ./bench_runtime > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../runtime.c"
+
+int main(int argc, char **argv) {
+	char *filepath = "bench_runtime.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 4;
+	options.timeline_count = 24;
+	options.bone_count = 16;
+	options.key_count = 16;
+	scml_generate_file(filepath, options);
+	
+	struct spriter_data spriter_data = parse_spriter_file(filepath, NULL);
+	struct entity *entity = &spriter_data.entity_list.items[0];
+	
+	struct pose pose = pose_create_for_entity(entity, NULL);
+	
+	int instance_count = 2000;
+	int tick_count = 200;
+	float *times = malloc(sizeof(float) * instance_count);
+	for (int i = 0; i < instance_count; i++) {
+		times[i] = bench_random_float(0.0f, 1000.0f);
+	}
+	
+	long allocations_before = bench_allocation_count;
+	float checksum = 0.0f;
+	
+	double start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			entity_sample_pose(entity, i % options.animation_count, times[i] + tick * 16.0f, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double elapsed = bench_now() - start;
+	
+	long samples = (long)instance_count * tick_count;
+	fprintf(stderr, "rig:         %d bones, %d objects\r\n", options.bone_count, options.timeline_count - options.bone_count);
+	fprintf(stderr, "samples:     %.2f M/s (%.1f ns each)\r\n", samples / elapsed * 1e-6, elapsed / samples * 1e9);
+	fprintf(stderr, "allocations: %ld while sampling\r\n", bench_allocation_count - allocations_before);
+	fprintf(stderr, "checksum:    %f\r\n", checksum);
+	
+	free(times);
+	pose_destroy(&pose);
+	spriter_data_destroy(&spriter_data);
+	remove(filepath);
+	
+	return 0;
+}
\ No newline at end of file
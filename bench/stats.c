@@ -0,0 +1,65 @@
+// The cost of measuring a load: parse_spriter_buffer against
+// parse_spriter_buffer_with_stats with counters only, with phase timing, and
+// with the printing trace sink that used to be built in. Prints the stats of
+// the last measured run.
+//
+//   cc -O2 -o bench_stats bench/stats.c -lm && ./bench_stats > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+
+#define RUNS 10
+
+static double bench_parse(const char *buffer, int length, struct parse_stats *stats) {
+	double best = 1e30;
+	
+	for (int r = 0; r < RUNS; r++) {
+		double start = bench_now();
+		struct spriter_data spriter_data = parse_spriter_buffer_with_stats(buffer, length, NULL, stats);
+		double elapsed = bench_now() - start;
+		if (elapsed < best) best = elapsed;
+		spriter_data_destroy(&spriter_data);
+	}
+	
+	return best;
+}
+
+int main(int argc, char **argv) {
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 8;
+	options.timeline_count = 24;
+	options.bone_count = 12;
+	options.key_count = 32;
+	
+	int length = 0;
+	char *buffer = scml_generate(options, &length);
+	
+	double quiet = bench_parse(buffer, length, NULL);
+	fprintf(stderr, "no stats:     %7.2f ms\r\n", quiet * 1e3);
+	
+	struct parse_stats stats = parse_stats_create();
+	double counted = bench_parse(buffer, length, &stats);
+	fprintf(stderr, "counters:     %7.2f ms, %+.1f%%\r\n", counted * 1e3, (counted / quiet - 1.0) * 100.0);
+	
+	stats = parse_stats_create();
+	stats.time_phases = true;
+	double timed = bench_parse(buffer, length, &stats);
+	fprintf(stderr, "time phases:  %7.2f ms, %+.1f%%\r\n", timed * 1e3, (timed / quiet - 1.0) * 100.0);
+	
+	struct parse_stats traced_stats = parse_stats_create();
+	traced_stats.trace = parse_trace_print;
+	double traced = bench_parse(buffer, length, &traced_stats);
+	fprintf(stderr, "print trace:  %7.2f ms, %+.1f%%\r\n", traced * 1e3, (traced / quiet - 1.0) * 100.0);
+	
+	fprintf(stderr, "\r\n%d runs with phase timing:\r\n", RUNS);
+	parse_stats_print(&stats, stderr);
+	
+	free(buffer);
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+// Peak RSS of the two-phase load (parse_file + parse_tags) against the
+// streaming parse_spriter_file. Each mode runs in its own process so that
+// ru_maxrss only covers that load.
+//
+//   cc -O2 -o bench_streaming bench/streaming.c && ./bench_streaming
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static long peak_rss_kb() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+static void run_mode(char *mode, char *filepath) {
+	double start = bench_now();
+	
+	if (strcmp(mode, "two-phase") == 0) {
+		struct tag_list tag_list = parse_file(filepath, NULL);
+		struct spriter_data spriter_data = parse_tags(tag_list, NULL);
+		long peak = peak_rss_kb();
+		tag_list_destroy(&tag_list);
+		spriter_data_destroy(&spriter_data);
+		fprintf(stderr, "two-phase: %8.1f ms, peak RSS %7ld KB\r\n", (bench_now() - start) * 1e3, peak);
+	} else {
+		struct spriter_data spriter_data = parse_spriter_file(filepath, NULL);
+		long peak = peak_rss_kb();
+		spriter_data_destroy(&spriter_data);
+		fprintf(stderr, "streaming: %8.1f ms, peak RSS %7ld KB\r\n", (bench_now() - start) * 1e3, peak);
+	}
+}
+
+static void spawn(char *self, char *mode, char *filepath) {
+	pid_t pid = fork();
+	assert(pid >= 0);
+	
+	if (pid == 0) {
+		execl(self, self, mode, filepath, (char *)NULL);
+		_exit(1);
+	}
+	
+	int status = 0;
+	waitpid(pid, &status, 0);
+}
+
+int main(int argc, char **argv) {
+	if (argc == 3) {
+		run_mode(argv[1], argv[2]);
+		return 0;
+	}
+	
+	char *filepath = "bench_streaming.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 2;
+	options.animation_count = 16;
+	options.timeline_count = 32;
+	options.bone_count = 16;
+	options.key_count = 32;
+	scml_generate_file(filepath, options);
+	
+	struct mapped_file mapped_file = mapped_file_open(filepath);
+	fprintf(stderr, "file: %.2f MB\r\n", mapped_file.length / (1024.0 * 1024.0));
+	mapped_file_close(&mapped_file);
+	
+	spawn(argv[0], "two-phase", filepath);
+	spawn(argv[0], "streaming", filepath);
+	
+	remove(filepath);
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+// The benchmark suite. Generates rigs of several sizes and, for each, measures
+// parse_file, parse_tags and spriter_data_destroy of the two-phase load, and
+// the streaming parse_spriter_file. Each load runs in a child process so that
+// its peak RSS is its own; times are the best of RUNS. Results go to stdout as
+// one JSON document, progress to stderr. Pass five counts (entities,
+// animations, timelines, bones, keys) to measure that one size instead.
+//
+//   cc -O2 -o bench_suite bench/suite.c -lm && ./bench_suite > bench_suite.json
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define RUNS 5
+
+static long peak_rss_kb() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+struct phase {
+	const char *name;
+	double seconds; // best run
+	long allocations;
+	long allocated_bytes;
+	long peak_rss_kb;
+};
+
+// Allocations and peak RSS are those of the first run: later runs reuse the
+// memory it grew.
+static void phase_end(struct phase *phase, int run, double elapsed, long allocations, long bytes) {
+	if ((run == 0) || (elapsed < phase->seconds)) phase->seconds = elapsed;
+	if (run == 0) {
+		phase->allocations = bench_allocation_count - allocations;
+		phase->allocated_bytes = bench_allocation_bytes - bytes;
+		phase->peak_rss_kb = peak_rss_kb();
+	}
+}
+
+static void phase_print(struct phase *phase, long bytes, long tags, bool last) {
+	printf("        { \"phase\": \"%s\", \"seconds\": %.6f, \"mb_per_s\": %.2f, \"tags_per_s\": %.0f, \"allocations\": %ld, \"allocated_bytes\": %ld, \"peak_rss_kb\": %ld }%s\n",
+		phase->name, phase->seconds, bytes / (1024.0 * 1024.0) / phase->seconds, tags / phase->seconds,
+		phase->allocations, phase->allocated_bytes, phase->peak_rss_kb, last ? "" : ",");
+}
+
+// Runs in a child: prints the phases of one load mode as JSON array items.
+static void run_mode(char *mode, char *filepath, long bytes, long tags, bool last) {
+	long allocations, allocated_bytes;
+	
+	if (strcmp(mode, "two-phase") == 0) {
+		struct phase phases[3] = { { "parse_file" }, { "parse_tags" }, { "spriter_data_destroy" } };
+		
+		for (int run = 0; run < RUNS; run++) {
+			allocations = bench_allocation_count, allocated_bytes = bench_allocation_bytes;
+			double start = bench_now();
+			struct tag_list tag_list = parse_file(filepath, NULL);
+			phase_end(&phases[0], run, bench_now() - start, allocations, allocated_bytes);
+			
+			allocations = bench_allocation_count, allocated_bytes = bench_allocation_bytes;
+			start = bench_now();
+			struct spriter_data spriter_data = parse_tags(tag_list, NULL);
+			phase_end(&phases[1], run, bench_now() - start, allocations, allocated_bytes);
+			
+			tag_list_destroy(&tag_list);
+			
+			allocations = bench_allocation_count, allocated_bytes = bench_allocation_bytes;
+			start = bench_now();
+			spriter_data_destroy(&spriter_data);
+			phase_end(&phases[2], run, bench_now() - start, allocations, allocated_bytes);
+		}
+		
+		for (int i = 0; i < 3; i++) {
+			phase_print(&phases[i], bytes, tags, last && (i == 2));
+		}
+	} else {
+		struct phase phase = { "parse_spriter_file" };
+		
+		for (int run = 0; run < RUNS; run++) {
+			allocations = bench_allocation_count, allocated_bytes = bench_allocation_bytes;
+			double start = bench_now();
+			struct spriter_data spriter_data = parse_spriter_file(filepath, NULL);
+			phase_end(&phase, run, bench_now() - start, allocations, allocated_bytes);
+			
+			spriter_data_destroy(&spriter_data);
+		}
+		
+		phase_print(&phase, bytes, tags, last);
+	}
+}
+
+static void spawn(char *self, char *mode, char *filepath, long bytes, long tags, bool last) {
+	fflush(stdout);
+	
+	char bytes_text[32], tags_text[32];
+	snprintf(bytes_text, sizeof(bytes_text), "%ld", bytes);
+	snprintf(tags_text, sizeof(tags_text), "%ld", tags);
+	
+	pid_t pid = fork();
+	assert(pid >= 0);
+	
+	if (pid == 0) {
+		execl(self, self, "--child", mode, filepath, bytes_text, tags_text, last ? "last" : "more", (char *)NULL);
+		_exit(1);
+	}
+	
+	int status = 0;
+	waitpid(pid, &status, 0);
+	assert(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+}
+
+static void count_tag(void *user_data, enum tag_types tag_type, struct string_view identifier) {
+	(void)tag_type;
+	(void)identifier;
+	(*(long *)user_data)++;
+}
+
+static void run_config(char *self, struct scml_generator_options options, bool last) {
+	char *filepath = "bench_suite.scml";
+	
+	int length = 0;
+	char *buffer = scml_generate(options, &length);
+	
+	long tags = 0;
+	struct xml_handler handler;
+	memset(&handler, 0, sizeof(struct xml_handler));
+	handler.user_data = &tags;
+	handler.on_open_tag = count_tag;
+	parse_buffer_stream(buffer, length, &handler);
+	
+	FILE *file = fopen(filepath, "wb");
+	assert(file != NULL);
+	fwrite(buffer, 1, length, file);
+	fclose(file);
+	free(buffer);
+	
+	fprintf(stderr, "%d entities, %d animations, %d timelines, %d bones, %d keys: %.2f MB, %ld tags\r\n",
+		options.entity_count, options.animation_count, options.timeline_count, options.bone_count, options.key_count,
+		length / (1024.0 * 1024.0), tags);
+	
+	printf("    {\n");
+	printf("      \"entities\": %d, \"animations\": %d, \"timelines\": %d, \"bones\": %d, \"keys\": %d,\n",
+		options.entity_count, options.animation_count, options.timeline_count, options.bone_count, options.key_count);
+	printf("      \"bytes\": %d, \"tags\": %ld,\n", length, tags);
+	printf("      \"phases\": [\n");
+	spawn(self, "two-phase", filepath, length, tags, false);
+	spawn(self, "streaming", filepath, length, tags, true);
+	printf("      ]\n");
+	printf("    }%s\n", last ? "" : ",");
+	
+	remove(filepath);
+}
+
+int main(int argc, char **argv) {
+	if ((argc == 7) && (strcmp(argv[1], "--child") == 0)) {
+		run_mode(argv[2], argv[3], atol(argv[4]), atol(argv[5]), strcmp(argv[6], "last") == 0);
+		return 0;
+	}
+	
+	struct scml_generator_options configs[3] = {
+		{ 1, 4, 8, 4, 8 },
+		{ 1, 16, 24, 12, 32 },
+		{ 2, 64, 32, 16, 32 },
+	};
+	int config_count = 3;
+	
+	if (argc == 6) {
+		configs[0].entity_count = atoi(argv[1]);
+		configs[0].animation_count = atoi(argv[2]);
+		configs[0].timeline_count = atoi(argv[3]);
+		configs[0].bone_count = atoi(argv[4]);
+		configs[0].key_count = atoi(argv[5]);
+		config_count = 1;
+	}
+	
+	printf("{\n");
+	printf("  \"runs\": %d,\n", RUNS);
+	printf("  \"configs\": [\n");
+	for (int i = 0; i < config_count; i++) {
+		run_config(argv[0], configs[i], i == config_count - 1);
+	}
+	printf("  ]\n");
+	printf("}\n");
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+// Playback from fixed-rate pose tables against sampling the animation, the
+// error the tables introduce at two frame rates, and a pose_table_cache whose
+// budget holds only some of the animations being played.
+//
+//   cc -O2 -o bench_table bench/table.c -lm && ./bench_table > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+#include "../runtime.c"
+#include "../bake.c"
+
+static float max_pose_error(struct pose *a, struct pose *b) {
+	float max_error = 0.0f;
+	
+	for (int i = 0; i < a->bone_count; i++) {
+		struct transform x = a->bones[i].local;
+		struct transform y = b->bones[i].local;
+		float angle = fabsf(x.angle - y.angle);
+		if (angle > 180.0f) angle = 360.0f - angle;
+		float errors[6] = { fabsf(x.x - y.x), fabsf(x.y - y.y), angle, fabsf(x.scale_x - y.scale_x), fabsf(x.scale_y - y.scale_y), fabsf(x.a - y.a) };
+		for (int c = 0; c < 6; c++) {
+			if (errors[c] > max_error) max_error = errors[c];
+		}
+	}
+	
+	return max_error;
+}
+
+int main(int argc, char **argv) {
+	char *filepath = "bench_table.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 8;
+	options.timeline_count = 32;
+	options.bone_count = 24;
+	options.key_count = 8;
+	scml_generate_file(filepath, options);
+	
+	struct spriter_data spriter_data = parse_spriter_file(filepath, NULL);
+	struct entity *entity = &spriter_data.entity_list.items[0];
+	struct animation *animation = &entity->animation_list.items[0];
+	
+	struct pose pose = pose_create_for_entity(entity, NULL);
+	struct pose expected = pose_create_for_entity(entity, NULL);
+	
+	float intervals[2] = { 0.0f, 1000.0f / 60.0f };
+	for (int i = 0; i < 2; i++) {
+		struct pose_table pose_table = pose_table_create(animation, intervals[i], NULL);
+		
+		float frame_error = 0.0f;
+		for (int f = 0; f < pose_table.frame_count; f++) {
+			float time = f * pose_table.frame_interval;
+			animation_sample_pose(animation, time, &expected);
+			pose_table_sample_pose(&pose_table, time, false, &pose);
+			float error = max_pose_error(&expected, &pose);
+			if (error > frame_error) frame_error = error;
+		}
+		
+		float max_error = 0.0f;
+		for (float time = 0.0f; time < 1000.0f; time += 0.7f) {
+			animation_sample_pose(animation, time, &expected);
+			pose_table_sample_pose(&pose_table, time, true, &pose);
+			float error = max_pose_error(&expected, &pose);
+			if (error > max_error) max_error = error;
+		}
+		
+		fprintf(stderr, "table:        %6.2f ms frames, %3d frames, %6zu bytes, max error %g on frames, %g between\r\n",
+			pose_table.frame_interval, pose_table.frame_count, pose_table_memory(animation, intervals[i]), frame_error, max_error);
+		pose_table_destroy(&pose_table);
+	}
+	
+	int instance_count = 2000;
+	int tick_count = 100;
+	float *times = malloc(sizeof(float) * instance_count);
+	for (int i = 0; i < instance_count; i++) {
+		times[i] = bench_random_float(0.0f, 1000.0f);
+	}
+	
+	struct pose_table pose_table = pose_table_create(animation, 1000.0f / 60.0f, NULL);
+	float checksum = 0.0f;
+	
+	double start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			animation_sample_pose(animation, times[i] + tick * 16.0f, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double sampled = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			pose_table_sample_pose(&pose_table, times[i] + tick * 16.0f, true, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double lerped = bench_now() - start;
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		for (int i = 0; i < instance_count; i++) {
+			pose_table_sample_pose(&pose_table, times[i] + tick * 16.0f, false, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double looked_up = bench_now() - start;
+	
+	double samples = (double)instance_count * tick_count;
+	fprintf(stderr, "sample:       %6.1f ns/pose\r\n", sampled / samples * 1e9);
+	fprintf(stderr, "table lerp:   %6.1f ns/pose\r\n", lerped / samples * 1e9);
+	fprintf(stderr, "table frame:  %6.1f ns/pose\r\n", looked_up / samples * 1e9);
+	
+	// Room for 4 tables. Instances play animations 0 to 3, then halfway
+	// through switch to 2 to 5, so 0 and 1 are the ones to evict.
+	size_t table_memory = pose_table_memory(animation, 0.0f);
+	struct pose_table_cache cache = pose_table_cache_create(table_memory * 4, false);
+	
+	start = bench_now();
+	for (int tick = 0; tick < tick_count; tick++) {
+		int first = (tick < tick_count / 2) ? 0 : 2;
+		for (int i = 0; i < instance_count; i++) {
+			struct animation *played = &entity->animation_list.items[first + i % 4];
+			pose_table_cache_sample_pose(&cache, played, times[i] + tick * 16.0f, true, &pose);
+			checksum += pose.bones[pose.bone_count - 1].local.angle;
+		}
+	}
+	double cached = bench_now() - start;
+	
+	fprintf(stderr, "cache:        %6.1f ns/pose, %zu of %zu bytes, %lu hits, %lu misses, %lu evictions\r\n",
+		cached / samples * 1e9, cache.used, cache.budget, cache.hits, cache.misses, cache.evictions);
+	fprintf(stderr, "checksum:     %g\r\n", checksum);
+	
+	free(times);
+	pose_table_cache_destroy(&cache);
+	pose_table_destroy(&pose_table);
+	pose_destroy(&expected);
+	pose_destroy(&pose);
+	spriter_data_destroy(&spriter_data);
+	remove(filepath);
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+// Rig teardown: spriter_data_destroy on a heap-backed rig against a single
+// arena_reset on an arena-backed one.
+//
+//   cc -O2 -o bench_teardown bench/teardown.c && ./bench_teardown > /dev/null
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+#include "../scml.c"
+
+int main(int argc, char **argv) {
+	char *filepath = "bench_teardown.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 4;
+	options.animation_count = 8;
+	options.timeline_count = 24;
+	options.bone_count = 12;
+	options.key_count = 16;
+	scml_generate_file(filepath, options);
+	
+	int iterations = 10;
+	double heap_load = 0.0;
+	double heap_teardown = 0.0;
+	double arena_load = 0.0;
+	double arena_teardown = 0.0;
+	
+	struct arena scratch = arena_create(ARENA_DEFAULT_BLOCK_SIZE);
+	struct arena rig = arena_create(ARENA_DEFAULT_BLOCK_SIZE);
+	
+	for (int i = 0; i < iterations; i++) {
+		double start = bench_now();
+		struct tag_list tag_list = parse_file(filepath, NULL);
+		struct spriter_data spriter_data = parse_tags(tag_list, NULL);
+		tag_list_destroy(&tag_list);
+		double loaded = bench_now();
+		spriter_data_destroy(&spriter_data);
+		double destroyed = bench_now();
+		
+		heap_load += loaded - start;
+		heap_teardown += destroyed - loaded;
+		
+		start = bench_now();
+		tag_list = parse_file(filepath, &scratch);
+		spriter_data = parse_tags(tag_list, &rig);
+		tag_list_destroy(&tag_list);
+		arena_reset(&scratch);
+		loaded = bench_now();
+		arena_reset(&rig);
+		destroyed = bench_now();
+		
+		arena_load += loaded - start;
+		arena_teardown += destroyed - loaded;
+	}
+	
+	arena_destroy(&scratch);
+	arena_destroy(&rig);
+	
+	fprintf(stderr, "heap:  load %8.3f ms, teardown %8.3f ms\r\n", heap_load * 1e3 / iterations, heap_teardown * 1e3 / iterations);
+	fprintf(stderr, "arena: load %8.3f ms, teardown %8.3f ms\r\n", arena_load * 1e3 / iterations, arena_teardown * 1e3 / iterations);
+	
+	remove(filepath);
+	
+	return 0;
+}
\ No newline at end of file
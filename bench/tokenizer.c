@@ -0,0 +1,248 @@
+// Tokenizer throughput and allocations per file for parse_file against the
+// getc-driven parse_file_by_line it replaced, and the throughput of
+// parse_buffer_stream alone, with a handler that only counts.
+//
+//   cc -O2 -o bench_tokenizer bench/tokenizer.c && ./bench_tokenizer
+#include "bench.h"
+
+#include "../arena.c"
+#include "../array.c"
+#include "../string.c"
+#include "../xml.c"
+
+////////////////////////////////////////////////////////////////////////////////
+// parse_file_by_line
+////////////////////////////////////////////////////////////////////////////////
+// What parse_file did before: one getc at a time into a line, every identifier,
+// name and value built with string_append_char, and the lists grown by one.
+struct legacy_attribute {
+	struct string name;
+	struct string value;
+};
+
+struct legacy_tag {
+	struct string identifier;
+	int attribute_count;
+	struct legacy_attribute *attributes;
+};
+
+struct legacy_tag_list {
+	int length;
+	struct legacy_tag *items;
+};
+
+static void legacy_tag_list_destroy(struct legacy_tag_list *tag_list) {
+	for (int i = 0; i < tag_list->length; i++) {
+		struct legacy_tag *tag = &tag_list->items[i];
+		for (int a = 0; a < tag->attribute_count; a++) {
+			string_destroy(&tag->attributes[a].name);
+			string_destroy(&tag->attributes[a].value);
+		}
+		free(tag->attributes);
+		string_destroy(&tag->identifier);
+	}
+	free(tag_list->items);
+}
+
+static void legacy_parse_attributes(struct string line, struct legacy_tag *tag) {
+	struct string name = string_create("");
+	struct string value = string_create("");
+	
+	bool past_whitespace = false;
+	bool identifier_skipped = false;
+	bool reading_name = true;
+	bool in_quotes = false;
+	
+	for (int i = 0; i < string_length(&line); i++) {
+		char c = string_at(&line, i);
+		
+		if (!past_whitespace) {
+			if (c == ' ') continue;
+			past_whitespace = true;
+		}
+		
+		if (!identifier_skipped) {
+			if (c == ' ') identifier_skipped = true;
+			continue;
+		}
+		
+		if (reading_name) {
+			if (c == ' ') continue;
+			
+			if (c == '=') {
+				reading_name = false;
+			} else {
+				string_append_char(&name, c);
+			}
+		} else if (c == '"') {
+			in_quotes = !in_quotes;
+			
+			if (!in_quotes) {
+				tag->attribute_count++;
+				tag->attributes = realloc(tag->attributes, sizeof(struct legacy_attribute) * tag->attribute_count);
+				tag->attributes[tag->attribute_count - 1].name = name;
+				tag->attributes[tag->attribute_count - 1].value = value;
+				
+				name = string_create("");
+				value = string_create("");
+				reading_name = true;
+			}
+		} else if (in_quotes) {
+			string_append_char(&value, c);
+		}
+	}
+	
+	string_destroy(&name);
+	string_destroy(&value);
+}
+
+static struct string legacy_parse_identifier(struct string line) {
+	struct string identifier = string_create("");
+	bool whitespace_ended = false;
+	
+	for (int i = 0; i < string_length(&line); i++) {
+		char c = string_at(&line, i);
+		
+		if (!whitespace_ended) {
+			if (c == ' ') continue;
+			whitespace_ended = true;
+		}
+		
+		if ((c == '<') || (c == '/') || (c == '>') || (c == '?')) continue;
+		if (c == ' ') break;
+		
+		string_append_char(&identifier, c);
+	}
+	
+	return identifier;
+}
+
+static bool legacy_is_opening_tag(struct string line) {
+	int less_than_at = -2;
+	
+	for (int i = 0; i < string_length(&line); i++) {
+		char c = string_at(&line, i);
+		
+		if (c == '<') less_than_at = i;
+		if ((c == '/') && (less_than_at == i - 1)) return false;
+	}
+	
+	return true;
+}
+
+static struct legacy_tag_list legacy_parse_file_by_line(const char *filepath) {
+	FILE *f = fopen(filepath, "r");
+	assert(f != NULL);
+	
+	struct legacy_tag_list tag_list = { 0, NULL };
+	struct string line = string_create("");
+	
+	bool line_ended = false;
+	while (!feof(f)) {
+		char c = getc(f);
+		
+		if (!line_ended) {
+			if ((c == '\r') || (c == '\n')) {
+				line_ended = true;
+			} else {
+				string_append_char(&line, c);
+			}
+		} else if ((c != '\r') && (c != '\n')) {
+			line_ended = false;
+			
+			if (legacy_is_opening_tag(line)) {
+				struct legacy_tag tag = { legacy_parse_identifier(line), 0, NULL };
+				legacy_parse_attributes(line, &tag);
+				
+				tag_list.length++;
+				tag_list.items = realloc(tag_list.items, sizeof(struct legacy_tag) * tag_list.length);
+				tag_list.items[tag_list.length - 1] = tag;
+			}
+			
+			string_destroy(&line);
+			line = string_create("");
+			if (c != ' ') string_append_char(&line, c);
+		}
+	}
+	
+	string_destroy(&line);
+	fclose(f);
+	
+	return tag_list;
+}
+
+static void count_tag(void *user_data, enum tag_types tag_type, struct string_view identifier) {
+	(void)tag_type;
+	(void)identifier;
+	(*(int *)user_data)++;
+}
+
+int main(int argc, char **argv) {
+	char *filepath = "bench_tokenizer.scml";
+	
+	struct scml_generator_options options;
+	options.entity_count = 1;
+	options.animation_count = 8;
+	options.timeline_count = 24;
+	options.bone_count = 12;
+	options.key_count = 16;
+	scml_generate_file(filepath, options);
+	
+	struct mapped_file mapped_file = mapped_file_open(filepath);
+	double megabytes = mapped_file.length / (1024.0 * 1024.0);
+	
+	int iterations = 20;
+	int tag_count = 0;
+	long allocation_count = 0;
+	
+	double start = bench_now();
+	for (int i = 0; i < iterations; i++) {
+		long allocations_before = bench_allocation_count;
+		
+		struct tag_list tag_list = parse_file(filepath, NULL);
+		tag_count = tag_list_length(&tag_list);
+		allocation_count = bench_allocation_count - allocations_before;
+		tag_list_destroy(&tag_list);
+	}
+	double elapsed = (bench_now() - start) / iterations;
+	
+	int legacy_iterations = 3;
+	int legacy_tag_count = 0;
+	long legacy_allocation_count = 0;
+	
+	start = bench_now();
+	for (int i = 0; i < legacy_iterations; i++) {
+		long allocations_before = bench_allocation_count;
+		
+		struct legacy_tag_list tag_list = legacy_parse_file_by_line(filepath);
+		legacy_tag_count = tag_list.length;
+		legacy_allocation_count = bench_allocation_count - allocations_before;
+		legacy_tag_list_destroy(&tag_list);
+	}
+	double legacy_elapsed = (bench_now() - start) / legacy_iterations;
+	
+	printf("file:        %.2f MB, %d tags (%d opening tags by line)\r\n", megabytes, tag_count, legacy_tag_count);
+	printf("by line:     %8.2f MB/s, %ld allocations per file\r\n", megabytes / legacy_elapsed, legacy_allocation_count);
+	printf("parse_file:  %8.2f MB/s, %ld allocations per file (%.2f per tag), %.1fx faster, %.1fx fewer allocations\r\n",
+		megabytes / elapsed, allocation_count, (double)allocation_count / tag_count, legacy_elapsed / elapsed,
+		(double)legacy_allocation_count / allocation_count);
+	
+	struct xml_handler handler;
+	memset(&handler, 0, sizeof(struct xml_handler));
+	int streamed_count = 0;
+	handler.user_data = &streamed_count;
+	handler.on_open_tag = count_tag;
+	
+	start = bench_now();
+	for (int i = 0; i < iterations; i++) {
+		parse_buffer_stream(mapped_file.data, mapped_file.length, &handler);
+	}
+	elapsed = (bench_now() - start) / iterations;
+	
+	printf("stream:      %8.2f MB/s (%s), %d tags\r\n", megabytes / elapsed, structural_kernel_name(), streamed_count / iterations);
+	mapped_file_close(&mapped_file);
+	
+	remove(filepath);
+	
+	return 0;
+}
\ No newline at end of file
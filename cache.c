@@ -0,0 +1,596 @@
+#include "cache.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 							Binary cache
+////////////////////////////////////////////////////////////////////////////////
+static const size_t spriter_cache_record_sizes[spriter_cache_section_count] = {
+	[spriter_cache_section_strings] = 1,
+	[spriter_cache_section_folders] = sizeof(struct spriter_cache_folder),
+	[spriter_cache_section_files] = sizeof(struct spriter_cache_file),
+	[spriter_cache_section_entities] = sizeof(struct spriter_cache_entity),
+	[spriter_cache_section_animations] = sizeof(struct spriter_cache_animation),
+	[spriter_cache_section_mainline_keys] = sizeof(struct spriter_cache_mainline_key),
+	[spriter_cache_section_object_refs] = sizeof(struct spriter_cache_object_ref),
+	[spriter_cache_section_bone_refs] = sizeof(struct spriter_cache_bone_ref),
+	[spriter_cache_section_timelines] = sizeof(struct spriter_cache_timeline),
+	[spriter_cache_section_timeline_keys] = sizeof(struct spriter_cache_timeline_key),
+	[spriter_cache_section_objects] = sizeof(struct spriter_cache_object),
+	[spriter_cache_section_bones] = sizeof(struct spriter_cache_bone),
+};
+
+// FNV-1a over the blob's 32-bit words, skipping the checksum itself so that
+// the header is covered too. Blobs are always a multiple of four bytes long.
+static uint32_t spriter_cache_checksum(const char *data, uint32_t length) {
+	uint32_t skipped = offsetof(struct spriter_cache_header, checksum);
+	uint32_t hash = 2166136261u;
+	
+	for (uint32_t i = 0; i < length; i += 4) {
+		if (i == skipped) continue;
+		
+		uint32_t word;
+		memcpy(&word, data + i, 4);
+		hash = (hash ^ word) * 16777619u;
+	}
+	
+	return hash;
+}
+
+static uint32_t spriter_cache_align(uint32_t offset) {
+	return (offset + 3u) & ~3u;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writer
+////////////////////////////////////////////////////////////////////////////////
+struct spriter_cache_writer {
+	char *data;
+	struct spriter_cache_header *header;
+	uint32_t cursors[spriter_cache_section_count]; // records written so far
+};
+
+static void spriter_cache_count_string(uint32_t *counts, struct string *str) {
+	counts[spriter_cache_section_strings] += strlen(str->characters) + 1;
+}
+
+static void spriter_cache_count_records(struct spriter_data *spriter_data, uint32_t *counts) {
+	spriter_cache_count_string(counts, &spriter_data->version);
+	spriter_cache_count_string(counts, &spriter_data->generator);
+	spriter_cache_count_string(counts, &spriter_data->generator_version);
+	
+	counts[spriter_cache_section_folders] += spriter_data->folder_list.length;
+	for (int i = 0; i < spriter_data->folder_list.length; i++) {
+		struct folder *folder = &spriter_data->folder_list.items[i];
+		
+		counts[spriter_cache_section_files] += folder->file_list.length;
+		for (int j = 0; j < folder->file_list.length; j++) {
+			spriter_cache_count_string(counts, &folder->file_list.items[j].name);
+		}
+	}
+	
+	counts[spriter_cache_section_entities] += spriter_data->entity_list.length;
+	for (int i = 0; i < spriter_data->entity_list.length; i++) {
+		struct entity *entity = &spriter_data->entity_list.items[i];
+		spriter_cache_count_string(counts, &entity->name);
+		
+		counts[spriter_cache_section_animations] += entity->animation_list.length;
+		for (int j = 0; j < entity->animation_list.length; j++) {
+			struct animation *animation = &entity->animation_list.items[j];
+			spriter_cache_count_string(counts, &animation->name);
+			
+			struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+			counts[spriter_cache_section_mainline_keys] += mainline_keys->length;
+			for (int k = 0; k < mainline_keys->length; k++) {
+				counts[spriter_cache_section_object_refs] += mainline_keys->items[k].object_ref_list.length;
+				counts[spriter_cache_section_bone_refs] += mainline_keys->items[k].bone_ref_list.length;
+			}
+			
+			counts[spriter_cache_section_timelines] += animation->timeline_list.length;
+			for (int k = 0; k < animation->timeline_list.length; k++) {
+				struct timeline *timeline = &animation->timeline_list.items[k];
+				spriter_cache_count_string(counts, &timeline->name);
+				
+				counts[spriter_cache_section_timeline_keys] += timeline->timeline_key_list.length;
+				for (int l = 0; l < timeline->timeline_key_list.length; l++) {
+					counts[spriter_cache_section_objects] += timeline->timeline_key_list.items[l].object_list.length;
+					counts[spriter_cache_section_bones] += timeline->timeline_key_list.items[l].bone_list.length;
+				}
+			}
+		}
+	}
+}
+
+// Claims the next `count` records of a section and returns the first one.
+static void *spriter_cache_writer_claim(struct spriter_cache_writer *writer, enum spriter_cache_sections section, uint32_t count, uint32_t *first) {
+	struct spriter_cache_section *header_section = &writer->header->sections[section];
+	uint32_t index = writer->cursors[section];
+	
+	assert(index + count <= header_section->count);
+	writer->cursors[section] += count;
+	
+	if (first != NULL) *first = index;
+	return writer->data + header_section->offset + index * spriter_cache_record_sizes[section];
+}
+
+static uint32_t spriter_cache_writer_string(struct spriter_cache_writer *writer, struct string *str) {
+	uint32_t length = strlen(str->characters) + 1;
+	uint32_t offset = 0;
+	
+	char *characters = spriter_cache_writer_claim(writer, spriter_cache_section_strings, length, &offset);
+	memcpy(characters, str->characters, length);
+	
+	return offset;
+}
+
+static struct spriter_cache_range spriter_cache_range_create(uint32_t first, uint32_t count) {
+	struct spriter_cache_range range;
+	range.first = first;
+	range.count = count;
+	return range;
+}
+
+static void spriter_cache_write_timeline(struct spriter_cache_writer *writer, struct timeline *timeline, struct spriter_cache_timeline *record) {
+	struct timeline_key_list *keys = &timeline->timeline_key_list;
+	uint32_t first_key = 0;
+	struct spriter_cache_timeline_key *key_records = spriter_cache_writer_claim(writer, spriter_cache_section_timeline_keys, keys->length, &first_key);
+	
+	record->id = timeline->id;
+	record->name = spriter_cache_writer_string(writer, &timeline->name);
+	record->keys = spriter_cache_range_create(first_key, keys->length);
+	
+	for (int i = 0; i < keys->length; i++) {
+		struct timeline_key *key = &keys->items[i];
+		uint32_t first_object = 0;
+		uint32_t first_bone = 0;
+		struct spriter_cache_object *objects = spriter_cache_writer_claim(writer, spriter_cache_section_objects, key->object_list.length, &first_object);
+		struct spriter_cache_bone *bones = spriter_cache_writer_claim(writer, spriter_cache_section_bones, key->bone_list.length, &first_bone);
+		
+		key_records[i].id = key->id;
+		key_records[i].time = key->time;
+		key_records[i].spin = key->spin;
+		key_records[i].objects = spriter_cache_range_create(first_object, key->object_list.length);
+		key_records[i].bones = spriter_cache_range_create(first_bone, key->bone_list.length);
+		
+		for (int j = 0; j < key->object_list.length; j++) {
+			struct object *object = &key->object_list.items[j];
+			objects[j].folder = object->folder;
+			objects[j].file = object->file;
+			objects[j].x = object->x;
+			objects[j].y = object->y;
+			objects[j].angle = object->angle;
+			objects[j].scale_x = object->scale_x;
+			objects[j].scale_y = object->scale_y;
+			objects[j].a = object->a;
+		}
+		
+		for (int j = 0; j < key->bone_list.length; j++) {
+			struct bone *bone = &key->bone_list.items[j];
+			bones[j].x = bone->x;
+			bones[j].y = bone->y;
+			bones[j].angle = bone->angle;
+			bones[j].scale_x = bone->scale_x;
+			bones[j].scale_y = bone->scale_y;
+			bones[j].a = bone->a;
+		}
+	}
+}
+
+static void spriter_cache_write_animation(struct spriter_cache_writer *writer, struct animation *animation, struct spriter_cache_animation *record) {
+	struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+	uint32_t first_mainline_key = 0;
+	uint32_t first_timeline = 0;
+	struct spriter_cache_mainline_key *mainline_key_records = spriter_cache_writer_claim(writer, spriter_cache_section_mainline_keys, mainline_keys->length, &first_mainline_key);
+	struct spriter_cache_timeline *timeline_records = spriter_cache_writer_claim(writer, spriter_cache_section_timelines, animation->timeline_list.length, &first_timeline);
+	
+	record->id = animation->id;
+	record->name = spriter_cache_writer_string(writer, &animation->name);
+	record->length = animation->length;
+	record->interval = animation->interval;
+	record->looping = animation->looping;
+	record->mainline_keys = spriter_cache_range_create(first_mainline_key, mainline_keys->length);
+	record->timelines = spriter_cache_range_create(first_timeline, animation->timeline_list.length);
+	
+	for (int i = 0; i < mainline_keys->length; i++) {
+		struct mainline_key *key = &mainline_keys->items[i];
+		uint32_t first_object_ref = 0;
+		uint32_t first_bone_ref = 0;
+		struct spriter_cache_object_ref *object_refs = spriter_cache_writer_claim(writer, spriter_cache_section_object_refs, key->object_ref_list.length, &first_object_ref);
+		struct spriter_cache_bone_ref *bone_refs = spriter_cache_writer_claim(writer, spriter_cache_section_bone_refs, key->bone_ref_list.length, &first_bone_ref);
+		
+		mainline_key_records[i].id = key->id;
+		mainline_key_records[i].time = key->time;
+		mainline_key_records[i].object_refs = spriter_cache_range_create(first_object_ref, key->object_ref_list.length);
+		mainline_key_records[i].bone_refs = spriter_cache_range_create(first_bone_ref, key->bone_ref_list.length);
+		
+		for (int j = 0; j < key->object_ref_list.length; j++) {
+			struct object_ref *object_ref = &key->object_ref_list.items[j];
+			object_refs[j].id = object_ref->id;
+			object_refs[j].parent = object_ref->parent;
+			object_refs[j].timeline = object_ref->timeline;
+			object_refs[j].key = object_ref->key;
+			object_refs[j].z_index = object_ref->z_index;
+		}
+		
+		for (int j = 0; j < key->bone_ref_list.length; j++) {
+			struct bone_ref *bone_ref = &key->bone_ref_list.items[j];
+			bone_refs[j].id = bone_ref->id;
+			bone_refs[j].parent = bone_ref->parent;
+			bone_refs[j].timeline = bone_ref->timeline;
+			bone_refs[j].key = bone_ref->key;
+		}
+	}
+	
+	for (int i = 0; i < animation->timeline_list.length; i++) {
+		spriter_cache_write_timeline(writer, &animation->timeline_list.items[i], &timeline_records[i]);
+	}
+}
+
+// Returns a heap blob that the caller frees.
+char *spriter_cache_serialize(struct spriter_data *spriter_data, int *length) {
+	assert(spriter_data != NULL);
+	assert(length != NULL);
+	
+	uint32_t counts[spriter_cache_section_count] = { 0 };
+	spriter_cache_count_records(spriter_data, counts);
+	
+	struct spriter_cache_header header;
+	memset(&header, 0, sizeof(struct spriter_cache_header));
+	memcpy(header.magic, SPRITER_CACHE_MAGIC, 4);
+	header.byte_order = SPRITER_CACHE_BYTE_ORDER;
+	header.version = SPRITER_CACHE_VERSION;
+	
+	uint32_t offset = sizeof(struct spriter_cache_header);
+	for (int i = 0; i < spriter_cache_section_count; i++) {
+		header.sections[i].offset = offset;
+		header.sections[i].count = counts[i];
+		offset = spriter_cache_align(offset + counts[i] * spriter_cache_record_sizes[i]);
+	}
+	header.length = offset;
+	
+	struct spriter_cache_writer writer;
+	writer.data = calloc(1, header.length);
+	writer.header = (struct spriter_cache_header *)writer.data;
+	memset(writer.cursors, 0, sizeof(writer.cursors));
+	*writer.header = header;
+	
+	writer.header->scml_version = spriter_cache_writer_string(&writer, &spriter_data->version);
+	writer.header->generator = spriter_cache_writer_string(&writer, &spriter_data->generator);
+	writer.header->generator_version = spriter_cache_writer_string(&writer, &spriter_data->generator_version);
+	
+	struct spriter_cache_folder *folders = spriter_cache_writer_claim(&writer, spriter_cache_section_folders, spriter_data->folder_list.length, NULL);
+	for (int i = 0; i < spriter_data->folder_list.length; i++) {
+		struct folder *folder = &spriter_data->folder_list.items[i];
+		uint32_t first_file = 0;
+		struct spriter_cache_file *files = spriter_cache_writer_claim(&writer, spriter_cache_section_files, folder->file_list.length, &first_file);
+		
+		folders[i].id = folder->id;
+		folders[i].files = spriter_cache_range_create(first_file, folder->file_list.length);
+		
+		for (int j = 0; j < folder->file_list.length; j++) {
+			struct file *file = &folder->file_list.items[j];
+			files[j].id = file->id;
+			files[j].name = spriter_cache_writer_string(&writer, &file->name);
+			files[j].width = file->width;
+			files[j].height = file->height;
+			files[j].pivot_x = file->pivot_x;
+			files[j].pivot_y = file->pivot_y;
+		}
+	}
+	
+	struct spriter_cache_entity *entities = spriter_cache_writer_claim(&writer, spriter_cache_section_entities, spriter_data->entity_list.length, NULL);
+	for (int i = 0; i < spriter_data->entity_list.length; i++) {
+		struct entity *entity = &spriter_data->entity_list.items[i];
+		uint32_t first_animation = 0;
+		struct spriter_cache_animation *animations = spriter_cache_writer_claim(&writer, spriter_cache_section_animations, entity->animation_list.length, &first_animation);
+		
+		entities[i].id = entity->id;
+		entities[i].name = spriter_cache_writer_string(&writer, &entity->name);
+		entities[i].animations = spriter_cache_range_create(first_animation, entity->animation_list.length);
+		
+		for (int j = 0; j < entity->animation_list.length; j++) {
+			spriter_cache_write_animation(&writer, &entity->animation_list.items[j], &animations[j]);
+		}
+	}
+	
+	for (int i = 0; i < spriter_cache_section_count; i++) {
+		assert(writer.cursors[i] == counts[i]);
+	}
+	
+	writer.header->checksum = spriter_cache_checksum(writer.data, header.length);
+	
+	*length = header.length;
+	return writer.data;
+}
+
+bool spriter_cache_write_file(struct spriter_data *spriter_data, const char *filepath) {
+	assert(spriter_data != NULL);
+	assert(filepath != NULL);
+	
+	int length = 0;
+	char *data = spriter_cache_serialize(spriter_data, &length);
+	
+	FILE *f = fopen(filepath, "wb");
+	bool written = false;
+	if (f != NULL) {
+		written = fwrite(data, 1, length, f) == (size_t)length;
+		written = (fclose(f) == 0) && written;
+	}
+	
+	free(data);
+	return written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Loader
+////////////////////////////////////////////////////////////////////////////////
+static bool spriter_cache_range_is_valid(struct spriter_cache_range range, const struct spriter_cache_header *header, enum spriter_cache_sections section) {
+	return ((uint64_t)range.first + range.count) <= header->sections[section].count;
+}
+
+static bool spriter_cache_string_is_valid(uint32_t offset, const struct spriter_cache_header *header) {
+	return offset < header->sections[spriter_cache_section_strings].count;
+}
+
+// Checks every index and string offset, so that walking a valid cache can
+// never leave the blob.
+static bool spriter_cache_records_are_valid(struct spriter_cache *cache) {
+	const struct spriter_cache_header *header = cache->header;
+	
+	if (!spriter_cache_string_is_valid(header->scml_version, header) ||
+		!spriter_cache_string_is_valid(header->generator, header) ||
+		!spriter_cache_string_is_valid(header->generator_version, header)) {
+		return false;
+	}
+	
+	for (uint32_t i = 0; i < header->sections[spriter_cache_section_folders].count; i++) {
+		if (!spriter_cache_range_is_valid(cache->folders[i].files, header, spriter_cache_section_files)) return false;
+	}
+	for (uint32_t i = 0; i < header->sections[spriter_cache_section_files].count; i++) {
+		if (!spriter_cache_string_is_valid(cache->files[i].name, header)) return false;
+	}
+	for (uint32_t i = 0; i < header->sections[spriter_cache_section_entities].count; i++) {
+		if (!spriter_cache_string_is_valid(cache->entities[i].name, header)) return false;
+		if (!spriter_cache_range_is_valid(cache->entities[i].animations, header, spriter_cache_section_animations)) return false;
+	}
+	for (uint32_t i = 0; i < header->sections[spriter_cache_section_animations].count; i++) {
+		if (!spriter_cache_string_is_valid(cache->animations[i].name, header)) return false;
+		if (!spriter_cache_range_is_valid(cache->animations[i].mainline_keys, header, spriter_cache_section_mainline_keys)) return false;
+		if (!spriter_cache_range_is_valid(cache->animations[i].timelines, header, spriter_cache_section_timelines)) return false;
+	}
+	for (uint32_t i = 0; i < header->sections[spriter_cache_section_mainline_keys].count; i++) {
+		if (!spriter_cache_range_is_valid(cache->mainline_keys[i].object_refs, header, spriter_cache_section_object_refs)) return false;
+		if (!spriter_cache_range_is_valid(cache->mainline_keys[i].bone_refs, header, spriter_cache_section_bone_refs)) return false;
+	}
+	for (uint32_t i = 0; i < header->sections[spriter_cache_section_timelines].count; i++) {
+		if (!spriter_cache_string_is_valid(cache->timelines[i].name, header)) return false;
+		if (!spriter_cache_range_is_valid(cache->timelines[i].keys, header, spriter_cache_section_timeline_keys)) return false;
+	}
+	for (uint32_t i = 0; i < header->sections[spriter_cache_section_timeline_keys].count; i++) {
+		if (!spriter_cache_range_is_valid(cache->timeline_keys[i].objects, header, spriter_cache_section_objects)) return false;
+		if (!spriter_cache_range_is_valid(cache->timeline_keys[i].bones, header, spriter_cache_section_bones)) return false;
+	}
+	
+	return true;
+}
+
+// Validates `data` and points the cache into it. The buffer is not copied and
+// must outlive the cache; it has to be 4-byte aligned, as heap and mapped
+// memory are.
+struct spriter_cache spriter_cache_from_buffer(const char *data, int length) {
+	struct spriter_cache cache;
+	memset(&cache, 0, sizeof(struct spriter_cache));
+	
+	if ((data == NULL) || (length < (int)sizeof(struct spriter_cache_header)) || (((uintptr_t)data & 3u) != 0)) {
+		return cache;
+	}
+	
+	const struct spriter_cache_header *header = (const struct spriter_cache_header *)data;
+	
+	if ((memcmp(header->magic, SPRITER_CACHE_MAGIC, 4) != 0) ||
+		(header->byte_order != SPRITER_CACHE_BYTE_ORDER) ||
+		(header->version != SPRITER_CACHE_VERSION) ||
+		(header->length != (uint32_t)length) ||
+		((length & 3) != 0)) {
+		return cache;
+	}
+	
+	uint32_t checksum = spriter_cache_checksum(data, length);
+	if (checksum != header->checksum) {
+		return cache;
+	}
+	
+	for (int i = 0; i < spriter_cache_section_count; i++) {
+		struct spriter_cache_section section = header->sections[i];
+		uint64_t end = (uint64_t)section.offset + (uint64_t)section.count * spriter_cache_record_sizes[i];
+		
+		if ((section.offset < sizeof(struct spriter_cache_header)) || ((section.offset & 3u) != 0) || (end > (uint64_t)length)) {
+			return cache;
+		}
+	}
+	
+	struct spriter_cache_section strings = header->sections[spriter_cache_section_strings];
+	if ((strings.count == 0) || (data[strings.offset + strings.count - 1] != '\0')) {
+		return cache;
+	}
+	
+	cache.header = header;
+	cache.strings = data + strings.offset;
+	cache.folders = (const void *)(data + header->sections[spriter_cache_section_folders].offset);
+	cache.files = (const void *)(data + header->sections[spriter_cache_section_files].offset);
+	cache.entities = (const void *)(data + header->sections[spriter_cache_section_entities].offset);
+	cache.animations = (const void *)(data + header->sections[spriter_cache_section_animations].offset);
+	cache.mainline_keys = (const void *)(data + header->sections[spriter_cache_section_mainline_keys].offset);
+	cache.object_refs = (const void *)(data + header->sections[spriter_cache_section_object_refs].offset);
+	cache.bone_refs = (const void *)(data + header->sections[spriter_cache_section_bone_refs].offset);
+	cache.timelines = (const void *)(data + header->sections[spriter_cache_section_timelines].offset);
+	cache.timeline_keys = (const void *)(data + header->sections[spriter_cache_section_timeline_keys].offset);
+	cache.objects = (const void *)(data + header->sections[spriter_cache_section_objects].offset);
+	cache.bones = (const void *)(data + header->sections[spriter_cache_section_bones].offset);
+	
+	if (!spriter_cache_records_are_valid(&cache)) {
+		memset(&cache, 0, sizeof(struct spriter_cache));
+		return cache;
+	}
+	
+	cache.is_valid = true;
+	return cache;
+}
+
+// Maps the file and uses it in place. A missing, stale or corrupt cache comes
+// back with is_valid false, and the SCML should be converted again.
+struct spriter_cache spriter_cache_open(const char *filepath) {
+	assert(filepath != NULL);
+	
+	struct mapped_file source = mapped_file_open(filepath);
+	
+	struct spriter_cache cache = spriter_cache_from_buffer(source.data, source.length);
+	if (!cache.is_valid) {
+		mapped_file_close(&source);
+		return cache;
+	}
+	
+	cache.source = source;
+	return cache;
+}
+
+void spriter_cache_close(struct spriter_cache *cache) {
+	assert(cache != NULL);
+	
+	mapped_file_close(&cache->source);
+	memset(cache, 0, sizeof(struct spriter_cache));
+}
+
+int spriter_cache_count(struct spriter_cache *cache, enum spriter_cache_sections section) {
+	assert(cache != NULL);
+	assert(cache->is_valid);
+	
+	return cache->header->sections[section].count;
+}
+
+const char *spriter_cache_string(struct spriter_cache *cache, uint32_t offset) {
+	assert(cache != NULL);
+	assert(cache->is_valid);
+	assert(offset < cache->header->sections[spriter_cache_section_strings].count);
+	
+	return cache->strings + offset;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Conversion
+////////////////////////////////////////////////////////////////////////////////
+static struct string spriter_cache_string_create(struct spriter_cache *cache, uint32_t offset, struct arena *arena) {
+	const char *characters = spriter_cache_string(cache, offset);
+	return string_create_from_view(string_view_create(characters, strlen(characters)), arena);
+}
+
+static struct timeline spriter_cache_timeline_create(struct spriter_cache *cache, const struct spriter_cache_timeline *record, struct arena *arena) {
+	struct timeline timeline = timeline_create(record->id, spriter_cache_string_create(cache, record->name, arena), arena);
+	timeline_key_list_reserve(&timeline.timeline_key_list, record->keys.count);
+	
+	for (uint32_t i = 0; i < record->keys.count; i++) {
+		const struct spriter_cache_timeline_key *key_record = &cache->timeline_keys[record->keys.first + i];
+		struct timeline_key key = timeline_key_create(key_record->id, key_record->time, key_record->spin, arena);
+		
+		object_list_reserve(&key.object_list, key_record->objects.count);
+		for (uint32_t j = 0; j < key_record->objects.count; j++) {
+			const struct spriter_cache_object *object = &cache->objects[key_record->objects.first + j];
+			object_list_append(&key.object_list, object_create(object->folder, object->file, object->x, object->y, object->angle, object->scale_x, object->scale_y, object->a));
+		}
+		
+		bone_list_reserve(&key.bone_list, key_record->bones.count);
+		for (uint32_t j = 0; j < key_record->bones.count; j++) {
+			const struct spriter_cache_bone *bone = &cache->bones[key_record->bones.first + j];
+			bone_list_append(&key.bone_list, bone_create(bone->x, bone->y, bone->angle, bone->scale_x, bone->scale_y, bone->a));
+		}
+		
+		timeline_key_list_append(&timeline.timeline_key_list, key);
+	}
+	
+	return timeline;
+}
+
+static struct animation spriter_cache_animation_create(struct spriter_cache *cache, const struct spriter_cache_animation *record, struct arena *arena) {
+	struct string name = spriter_cache_string_create(cache, record->name, arena);
+	struct animation animation = animation_create(record->id, name, record->length, record->interval, record->looping != 0, arena);
+	
+	struct mainline_key_list *mainline_keys = &animation.mainline.mainline_key_list;
+	mainline_key_list_reserve(mainline_keys, record->mainline_keys.count);
+	for (uint32_t i = 0; i < record->mainline_keys.count; i++) {
+		const struct spriter_cache_mainline_key *key_record = &cache->mainline_keys[record->mainline_keys.first + i];
+		struct mainline_key key = mainline_key_create(key_record->id, key_record->time, arena);
+		
+		object_ref_list_reserve(&key.object_ref_list, key_record->object_refs.count);
+		for (uint32_t j = 0; j < key_record->object_refs.count; j++) {
+			const struct spriter_cache_object_ref *object_ref = &cache->object_refs[key_record->object_refs.first + j];
+			object_ref_list_append(&key.object_ref_list, object_ref_create(object_ref->id, object_ref->parent, object_ref->timeline, object_ref->key, object_ref->z_index));
+		}
+		
+		bone_ref_list_reserve(&key.bone_ref_list, key_record->bone_refs.count);
+		for (uint32_t j = 0; j < key_record->bone_refs.count; j++) {
+			const struct spriter_cache_bone_ref *bone_ref = &cache->bone_refs[key_record->bone_refs.first + j];
+			bone_ref_list_append(&key.bone_ref_list, bone_ref_create(bone_ref->id, bone_ref->parent, bone_ref->timeline, bone_ref->key));
+		}
+		
+		mainline_key_list_append(mainline_keys, key);
+	}
+	
+	timeline_list_reserve(&animation.timeline_list, record->timelines.count);
+	for (uint32_t i = 0; i < record->timelines.count; i++) {
+		const struct spriter_cache_timeline *timeline = &cache->timelines[record->timelines.first + i];
+		timeline_list_append(&animation.timeline_list, spriter_cache_timeline_create(cache, timeline, arena));
+	}
+	
+	return animation;
+}
+
+// Rebuilds the tree of lists for code that walks a spriter_data. Callers that
+// only read can stay on the cache records instead.
+struct spriter_data spriter_cache_to_spriter_data(struct spriter_cache *cache, struct arena *arena) {
+	assert(cache != NULL);
+	assert(cache->is_valid);
+	
+	const struct spriter_cache_header *header = cache->header;
+	struct spriter_data spriter_data = spriter_data_create(arena);
+	
+	if (arena == NULL) {
+		string_destroy(&spriter_data.version);
+		string_destroy(&spriter_data.generator);
+		string_destroy(&spriter_data.generator_version);
+	}
+	spriter_data.version = spriter_cache_string_create(cache, header->scml_version, arena);
+	spriter_data.generator = spriter_cache_string_create(cache, header->generator, arena);
+	spriter_data.generator_version = spriter_cache_string_create(cache, header->generator_version, arena);
+	
+	int folder_count = spriter_cache_count(cache, spriter_cache_section_folders);
+	folder_list_reserve(&spriter_data.folder_list, folder_count);
+	for (int i = 0; i < folder_count; i++) {
+		const struct spriter_cache_folder *record = &cache->folders[i];
+		struct folder folder = folder_create(record->id, arena);
+		
+		file_list_reserve(&folder.file_list, record->files.count);
+		for (uint32_t j = 0; j < record->files.count; j++) {
+			const struct spriter_cache_file *file = &cache->files[record->files.first + j];
+			struct string name = spriter_cache_string_create(cache, file->name, arena);
+			file_list_append(&folder.file_list, file_create(file->id, name, file->width, file->height, file->pivot_x, file->pivot_y));
+		}
+		
+		folder_list_append(&spriter_data.folder_list, folder);
+	}
+	
+	int entity_count = spriter_cache_count(cache, spriter_cache_section_entities);
+	entity_list_reserve(&spriter_data.entity_list, entity_count);
+	for (int i = 0; i < entity_count; i++) {
+		const struct spriter_cache_entity *record = &cache->entities[i];
+		struct entity entity = entity_create(record->id, spriter_cache_string_create(cache, record->name, arena), arena);
+		
+		animation_list_reserve(&entity.animation_list, record->animations.count);
+		for (uint32_t j = 0; j < record->animations.count; j++) {
+			const struct spriter_cache_animation *animation = &cache->animations[record->animations.first + j];
+			animation_list_append(&entity.animation_list, spriter_cache_animation_create(cache, animation, arena));
+		}
+		
+		entity_list_append(&spriter_data.entity_list, entity);
+	}
+	
+	spriter_data_order_bones(&spriter_data);
+	return spriter_data;
+}
\ No newline at end of file
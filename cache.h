@@ -0,0 +1,187 @@
+#pragma once
+
+#include "arena.h"
+#include "scml.h"
+#include "xml.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// 							Binary cache
+////////////////////////////////////////////////////////////////////////////////
+// A spriter_data flattened into one blob: a header followed by one array per
+// record type. Records point at their children with index ranges and at their
+// names with offsets into the string section, so a mapped blob is used in
+// place. Bump SPRITER_CACHE_VERSION whenever a record changes.
+#define SPRITER_CACHE_MAGIC "SPRC"
+#define SPRITER_CACHE_VERSION 3
+#define SPRITER_CACHE_BYTE_ORDER 0x01020304u
+
+////////////////////////////////////////////////////////////////////////////////
+// Records
+////////////////////////////////////////////////////////////////////////////////
+struct spriter_cache_range {
+	uint32_t first;
+	uint32_t count;
+};
+
+struct spriter_cache_folder {
+	int32_t id;
+	struct spriter_cache_range files;
+};
+
+struct spriter_cache_file {
+	int32_t id;
+	uint32_t name;
+	int32_t width, height;
+	float pivot_x, pivot_y;
+};
+
+struct spriter_cache_entity {
+	int32_t id;
+	uint32_t name;
+	struct spriter_cache_range animations;
+};
+
+struct spriter_cache_animation {
+	int32_t id;
+	uint32_t name;
+	int32_t length;
+	int32_t interval;
+	int32_t looping;
+	struct spriter_cache_range mainline_keys;
+	struct spriter_cache_range timelines;
+};
+
+struct spriter_cache_mainline_key {
+	int32_t id;
+	int32_t time;
+	struct spriter_cache_range object_refs;
+	struct spriter_cache_range bone_refs;
+};
+
+struct spriter_cache_object_ref {
+	int32_t id;
+	int32_t parent;
+	int32_t timeline;
+	int32_t key;
+	int32_t z_index;
+};
+
+struct spriter_cache_bone_ref {
+	int32_t id;
+	int32_t parent;
+	int32_t timeline;
+	int32_t key;
+};
+
+struct spriter_cache_timeline {
+	int32_t id;
+	uint32_t name;
+	struct spriter_cache_range keys;
+};
+
+struct spriter_cache_timeline_key {
+	int32_t id;
+	int32_t time;
+	int32_t spin;
+	struct spriter_cache_range objects;
+	struct spriter_cache_range bones;
+};
+
+struct spriter_cache_object {
+	int32_t folder;
+	int32_t file;
+	float x;
+	float y;
+	float angle;
+	float scale_x;
+	float scale_y;
+	float a;
+};
+
+struct spriter_cache_bone {
+	float x;
+	float y;
+	float angle;
+	float scale_x;
+	float scale_y;
+	float a;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Header
+////////////////////////////////////////////////////////////////////////////////
+enum spriter_cache_sections {
+	spriter_cache_section_strings, // count is in bytes
+	spriter_cache_section_folders,
+	spriter_cache_section_files,
+	spriter_cache_section_entities,
+	spriter_cache_section_animations,
+	spriter_cache_section_mainline_keys,
+	spriter_cache_section_object_refs,
+	spriter_cache_section_bone_refs,
+	spriter_cache_section_timelines,
+	spriter_cache_section_timeline_keys,
+	spriter_cache_section_objects,
+	spriter_cache_section_bones,
+	spriter_cache_section_count
+};
+
+struct spriter_cache_section {
+	uint32_t offset; // from the start of the blob
+	uint32_t count;
+};
+
+struct spriter_cache_header {
+	char magic[4];
+	uint32_t byte_order;
+	uint32_t version;
+	uint32_t length;   // of the whole blob, header included
+	uint32_t checksum; // of the whole blob but this field
+	
+	uint32_t scml_version;
+	uint32_t generator;
+	uint32_t generator_version;
+	
+	struct spriter_cache_section sections[spriter_cache_section_count];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Cache
+////////////////////////////////////////////////////////////////////////////////
+// A validated view of a blob. Every pointer aims into the blob itself; when
+// is_valid is false they are all NULL.
+struct spriter_cache {
+	struct mapped_file source; // open when the cache was loaded from a file
+	bool is_valid;
+	
+	const struct spriter_cache_header *header;
+	const char *strings;
+	const struct spriter_cache_folder *folders;
+	const struct spriter_cache_file *files;
+	const struct spriter_cache_entity *entities;
+	const struct spriter_cache_animation *animations;
+	const struct spriter_cache_mainline_key *mainline_keys;
+	const struct spriter_cache_object_ref *object_refs;
+	const struct spriter_cache_bone_ref *bone_refs;
+	const struct spriter_cache_timeline *timelines;
+	const struct spriter_cache_timeline_key *timeline_keys;
+	const struct spriter_cache_object *objects;
+	const struct spriter_cache_bone *bones;
+};
+
+char *spriter_cache_serialize(struct spriter_data *spriter_data, int *length);
+bool spriter_cache_write_file(struct spriter_data *spriter_data, const char *filepath);
+struct spriter_cache spriter_cache_from_buffer(const char *data, int length);
+struct spriter_cache spriter_cache_open(const char *filepath);
+void spriter_cache_close(struct spriter_cache *cache);
+int spriter_cache_count(struct spriter_cache *cache, enum spriter_cache_sections section);
+const char *spriter_cache_string(struct spriter_cache *cache, uint32_t offset);
+struct spriter_data spriter_cache_to_spriter_data(struct spriter_cache *cache, struct arena *arena);
\ No newline at end of file
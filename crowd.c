@@ -0,0 +1,200 @@
+#include "crowd.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 								Crowds
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Crowd batch
+////////////////////////////////////////////////////////////////////////////////
+static size_t crowd_pose_bytes(struct rig_instance *instance) {
+	struct baked_entity *baked_entity = &instance->rig->baked_data.entities[instance->entity];
+	return sizeof(struct pose_bone) * baked_entity->bone_capacity + sizeof(struct pose_object) * baked_entity->object_capacity;
+}
+
+// Instances of one batch share an entity, so one scratch pose fits them all.
+static void crowd_batch_run(void *user_data) {
+	struct crowd_batch *batch = user_data;
+	struct crowd *crowd = batch->crowd;
+	
+	arena_reset(&batch->arena);
+	
+	struct pose scratch = rig_instance_pose_create(&crowd->instances[crowd->order[batch->first]], &batch->arena);
+	
+	for (int i = batch->first; i < batch->first + batch->count; i++) {
+		int index = crowd->order[i];
+		struct rig_instance *instance = &crowd->instances[index];
+		struct pose *pose = &crowd->poses[index];
+		
+		*pose = rig_instance_pose_create(instance, &batch->arena);
+		rig_instance_update(instance, batch->elapsed);
+		if (instance->animation < 0) continue;
+		
+		rig_instance_sample_pose(instance, pose, &scratch);
+		pose_compute_world(pose);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Crowd
+////////////////////////////////////////////////////////////////////////////////
+struct crowd crowd_create(int capacity) {
+	assert(capacity >= 0);
+	
+	if (capacity == 0) capacity = 16;
+	
+	struct crowd crowd;
+	crowd.length = 0;
+	crowd.capacity = capacity;
+	crowd.instances = malloc(sizeof(struct rig_instance) * capacity);
+	crowd.poses = malloc(sizeof(struct pose) * capacity);
+	crowd.order = malloc(sizeof(int) * capacity);
+	assert((crowd.instances != NULL) && (crowd.poses != NULL) && (crowd.order != NULL));
+	
+	crowd.batch_count = 0;
+	crowd.batch_capacity = 0;
+	crowd.batches = NULL;
+	return crowd;
+}
+
+// Destroys the instances too, releasing their rigs.
+void crowd_destroy(struct crowd *crowd) {
+	assert(crowd != NULL);
+	
+	for (int i = 0; i < crowd->length; i++) {
+		rig_instance_destroy(&crowd->instances[i]);
+	}
+	
+	for (int i = 0; i < crowd->batch_capacity; i++) {
+		arena_destroy(&crowd->batches[i].arena);
+	}
+	
+	free(crowd->instances);
+	free(crowd->poses);
+	free(crowd->order);
+	free(crowd->batches);
+	crowd->instances = NULL;
+	crowd->poses = NULL;
+	crowd->order = NULL;
+	crowd->batches = NULL;
+	crowd->length = 0;
+	crowd->batch_count = 0;
+}
+
+// Takes over `instance` and returns its index, which never changes.
+int crowd_add(struct crowd *crowd, struct rig_instance instance) {
+	assert(crowd != NULL);
+	assert(instance.rig != NULL);
+	
+	if (crowd->length == crowd->capacity) {
+		crowd->capacity *= 2;
+		crowd->instances = realloc(crowd->instances, sizeof(struct rig_instance) * crowd->capacity);
+		crowd->poses = realloc(crowd->poses, sizeof(struct pose) * crowd->capacity);
+		crowd->order = realloc(crowd->order, sizeof(int) * crowd->capacity);
+		assert((crowd->instances != NULL) && (crowd->poses != NULL) && (crowd->order != NULL));
+	}
+	
+	int index = crowd->length++;
+	crowd->instances[index] = instance;
+	memset(&crowd->poses[index], 0, sizeof(struct pose));
+	crowd->order[index] = index;
+	return index;
+}
+
+struct rig_instance *crowd_instance(struct crowd *crowd, int index) {
+	assert(crowd != NULL);
+	assert((index >= 0) && (index < crowd->length));
+	
+	return &crowd->instances[index];
+}
+
+// The instance's pose from the last update, with world transforms. Empty
+// before the first update and while the instance plays nothing.
+struct pose *crowd_pose(struct crowd *crowd, int index) {
+	assert(crowd != NULL);
+	assert((index >= 0) && (index < crowd->length));
+	
+	return &crowd->poses[index];
+}
+
+// Whether instances a and b may share a batch.
+static bool crowd_same_group(struct rig_instance *a, struct rig_instance *b) {
+	return (a->rig == b->rig) && (a->entity == b->entity) && (a->animation == b->animation);
+}
+
+static bool crowd_order_before(struct crowd *crowd, int a, int b) {
+	struct rig_instance *instance_a = &crowd->instances[a];
+	struct rig_instance *instance_b = &crowd->instances[b];
+	
+	if (instance_a->rig != instance_b->rig) return (uintptr_t)instance_a->rig < (uintptr_t)instance_b->rig;
+	if (instance_a->entity != instance_b->entity) return instance_a->entity < instance_b->entity;
+	if (instance_a->animation != instance_b->animation) return instance_a->animation < instance_b->animation;
+	return a < b;
+}
+
+// Insertion sort: from one update to the next only the instances that
+// switched animation move, so the previous order is nearly sorted already.
+static void crowd_sort(struct crowd *crowd) {
+	int *order = crowd->order;
+	
+	for (int i = 1; i < crowd->length; i++) {
+		int index = order[i];
+		int j = i;
+		while ((j > 0) && crowd_order_before(crowd, index, order[j - 1])) {
+			order[j] = order[j - 1];
+			j--;
+		}
+		order[j] = index;
+	}
+}
+
+static void crowd_append_batch(struct crowd *crowd, int first, int count, float elapsed) {
+	if (crowd->batch_count == crowd->batch_capacity) {
+		int capacity = (crowd->batch_capacity == 0) ? 16 : crowd->batch_capacity * 2;
+		crowd->batches = realloc(crowd->batches, sizeof(struct crowd_batch) * capacity);
+		assert(crowd->batches != NULL);
+		
+		for (int i = crowd->batch_capacity; i < capacity; i++) {
+			crowd->batches[i].arena = arena_create(ARENA_DEFAULT_BLOCK_SIZE);
+		}
+		crowd->batch_capacity = capacity;
+	}
+	
+	struct crowd_batch *batch = &crowd->batches[crowd->batch_count++];
+	batch->crowd = crowd;
+	batch->first = first;
+	batch->count = count;
+	batch->elapsed = elapsed;
+}
+
+// Steps every instance `elapsed` milliseconds and samples its pose, on `pool`
+// and the calling thread. Instances must not be touched elsewhere meanwhile;
+// their rigs may be shared with anything.
+void crowd_update(struct crowd *crowd, struct job_pool *pool, float elapsed) {
+	assert(crowd != NULL);
+	assert(pool != NULL);
+	
+	crowd_sort(crowd);
+	
+	crowd->batch_count = 0;
+	for (int first = 0; first < crowd->length;) {
+		struct rig_instance *leader = &crowd->instances[crowd->order[first]];
+		size_t pose_bytes = crowd_pose_bytes(leader);
+		size_t bytes = pose_bytes;
+		
+		int end = first + 1;
+		while ((end < crowd->length) && (bytes + pose_bytes <= CROWD_BATCH_BYTES) && crowd_same_group(leader, &crowd->instances[crowd->order[end]])) {
+			bytes += pose_bytes;
+			end++;
+		}
+		
+		crowd_append_batch(crowd, first, end - first, elapsed);
+		first = end;
+	}
+	
+	struct job_group group = job_group_create();
+	for (int i = 0; i < crowd->batch_count; i++) {
+		job_pool_submit(pool, &group, crowd_batch_run, &crowd->batches[i]);
+	}
+	job_pool_wait(pool, &group);
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "arena.h"
+#include "job.h"
+#include "rig.h"
+#include "runtime.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// 								Crowds
+////////////////////////////////////////////////////////////////////////////////
+// Many rig_instances stepped and sampled together on a job_pool. Every update
+// orders the instances by rig, entity and animation, so that instances reading
+// the same keys run back to back, and cuts that order into batches whose
+// output poses fit in CROWD_BATCH_BYTES. Each batch is one job and writes only
+// into its own arena. A batch always holds the same instances whatever the
+// thread count, and each instance is computed on its own, so the poses are the
+// same bit for bit on 1 thread or 32.
+#define CROWD_BATCH_BYTES (32 * 1024)
+
+////////////////////////////////////////////////////////////////////////////////
+// Crowd batch
+////////////////////////////////////////////////////////////////////////////////
+// order[first, first + count) of a crowd. The arena is kept from one update to
+// the next and reset, so after the first few frames updating allocates nothing.
+struct crowd_batch {
+	struct crowd *crowd;
+	int first;
+	int count;
+	float elapsed;
+	struct arena arena; // output poses and a scratch pose for crossfades
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Crowd
+////////////////////////////////////////////////////////////////////////////////
+struct crowd {
+	int length;
+	int capacity;
+	struct rig_instance *instances;
+	struct pose *poses; // [instance], valid until the next update
+	int *order;         // instance indices, sorted by crowd_update
+	
+	int batch_count;
+	int batch_capacity;
+	struct crowd_batch *batches;
+};
+
+struct crowd crowd_create(int capacity);
+void crowd_destroy(struct crowd *crowd);
+int crowd_add(struct crowd *crowd, struct rig_instance instance);
+struct rig_instance *crowd_instance(struct crowd *crowd, int index);
+struct pose *crowd_pose(struct crowd *crowd, int index);
+void crowd_update(struct crowd *crowd, struct job_pool *pool, float elapsed);
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "job.h"
+
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// 								Jobs
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Job group
+////////////////////////////////////////////////////////////////////////////////
+struct job_group job_group_create(void) {
+	struct job_group group;
+	group.pending = 0;
+	return group;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Job queue
+////////////////////////////////////////////////////////////////////////////////
+static void job_queue_init(struct job_queue *queue) {
+	pthread_mutex_init(&queue->mutex, NULL);
+	queue->head = 0;
+	queue->length = 0;
+	queue->capacity = 0;
+	queue->items = NULL;
+}
+
+static void job_queue_destroy(struct job_queue *queue) {
+	pthread_mutex_destroy(&queue->mutex);
+	free(queue->items);
+	queue->items = NULL;
+}
+
+static void job_queue_push(struct job_queue *queue, struct job job) {
+	pthread_mutex_lock(&queue->mutex);
+	
+	if (queue->length == queue->capacity) {
+		int capacity = (queue->capacity == 0) ? 16 : queue->capacity * 2;
+		struct job *items = malloc(sizeof(struct job) * capacity);
+		assert(items != NULL);
+		
+		for (int i = 0; i < queue->length; i++) {
+			items[i] = queue->items[(queue->head + i) % queue->capacity];
+		}
+		
+		free(queue->items);
+		queue->items = items;
+		queue->capacity = capacity;
+		queue->head = 0;
+	}
+	
+	queue->items[(queue->head + queue->length) % queue->capacity] = job;
+	queue->length++;
+	
+	pthread_mutex_unlock(&queue->mutex);
+}
+
+static bool job_queue_pop_back(struct job_queue *queue, struct job *job) {
+	pthread_mutex_lock(&queue->mutex);
+	
+	bool found = queue->length > 0;
+	if (found) {
+		queue->length--;
+		*job = queue->items[(queue->head + queue->length) % queue->capacity];
+	}
+	
+	pthread_mutex_unlock(&queue->mutex);
+	return found;
+}
+
+static bool job_queue_pop_front(struct job_queue *queue, struct job *job) {
+	pthread_mutex_lock(&queue->mutex);
+	
+	bool found = queue->length > 0;
+	if (found) {
+		*job = queue->items[queue->head];
+		queue->head = (queue->head + 1) % queue->capacity;
+		queue->length--;
+	}
+	
+	pthread_mutex_unlock(&queue->mutex);
+	return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Job pool
+////////////////////////////////////////////////////////////////////////////////
+struct job_pool_worker {
+	struct job_pool *pool;
+	int index;
+};
+
+int job_pool_default_thread_count(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count > 0) return (int)count;
+#endif
+	return 1;
+}
+
+// The queue of the calling thread: its own for a worker, the shared one
+// otherwise.
+static int job_pool_queue_index(struct job_pool *pool) {
+	pthread_t self = pthread_self();
+	
+	for (int i = 0; i < pool->thread_count; i++) {
+		if (pthread_equal(pool->threads[i], self)) return i;
+	}
+	
+	return pool->thread_count;
+}
+
+// Own queue first, newest job first, then the oldest job of every other queue.
+static bool job_pool_take(struct job_pool *pool, int index, struct job *job) {
+	int queue_count = pool->thread_count + 1;
+	
+	bool found = job_queue_pop_back(&pool->queues[index], job);
+	for (int i = 1; !found && (i < queue_count); i++) {
+		found = job_queue_pop_front(&pool->queues[(index + i) % queue_count], job);
+	}
+	
+	if (found) {
+		pthread_mutex_lock(&pool->mutex);
+		pool->queued--;
+		pthread_mutex_unlock(&pool->mutex);
+	}
+	
+	return found;
+}
+
+static void job_pool_run(struct job_pool *pool, struct job *job) {
+	job->run(job->user_data);
+	
+	pthread_mutex_lock(&pool->mutex);
+	job->group->pending--;
+	if (job->group->pending == 0) pthread_cond_broadcast(&pool->changed);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+static void *job_pool_worker_main(void *user_data) {
+	struct job_pool_worker *worker = user_data;
+	struct job_pool *pool = worker->pool;
+	int index = worker->index;
+	free(worker);
+	
+	for (;;) {
+		struct job job;
+		if (job_pool_take(pool, index, &job)) {
+			job_pool_run(pool, &job);
+			continue;
+		}
+		
+		pthread_mutex_lock(&pool->mutex);
+		while ((pool->queued == 0) && !pool->stopping) {
+			pthread_cond_wait(&pool->changed, &pool->mutex);
+		}
+		bool stopping = pool->stopping && (pool->queued == 0);
+		pthread_mutex_unlock(&pool->mutex);
+		
+		if (stopping) break;
+	}
+	
+	return NULL;
+}
+
+// 0 threads is valid: jobs then run on the thread that waits for them.
+struct job_pool *job_pool_create(int thread_count) {
+	assert(thread_count >= 0);
+	
+	struct job_pool *pool = malloc(sizeof(struct job_pool));
+	assert(pool != NULL);
+	
+	pool->thread_count = thread_count;
+	pool->threads = malloc(sizeof(pthread_t) * (thread_count + 1));
+	pool->queues = malloc(sizeof(struct job_queue) * (thread_count + 1));
+	assert((pool->threads != NULL) && (pool->queues != NULL));
+	
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->changed, NULL);
+	pool->queued = 0;
+	pool->next_queue = 0;
+	pool->stopping = false;
+	
+	for (int i = 0; i < thread_count + 1; i++) {
+		job_queue_init(&pool->queues[i]);
+	}
+	
+	// Workers look themselves up in `threads`, so it is complete before any
+	// job is submitted.
+	for (int i = 0; i < thread_count; i++) {
+		struct job_pool_worker *worker = malloc(sizeof(struct job_pool_worker));
+		assert(worker != NULL);
+		worker->pool = pool;
+		worker->index = i;
+		
+		int error = pthread_create(&pool->threads[i], NULL, job_pool_worker_main, worker);
+		assert(error == 0);
+	}
+	
+	return pool;
+}
+
+// Runs whatever is still queued, then joins the threads.
+void job_pool_destroy(struct job_pool *pool) {
+	assert(pool != NULL);
+	
+	pthread_mutex_lock(&pool->mutex);
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->changed);
+	pthread_mutex_unlock(&pool->mutex);
+	
+	for (int i = 0; i < pool->thread_count; i++) {
+		pthread_join(pool->threads[i], NULL);
+	}
+	
+	struct job job;
+	while (job_pool_take(pool, pool->thread_count, &job)) {
+		job_pool_run(pool, &job);
+	}
+	
+	for (int i = 0; i < pool->thread_count + 1; i++) {
+		job_queue_destroy(&pool->queues[i]);
+	}
+	
+	pthread_cond_destroy(&pool->changed);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->queues);
+	free(pool->threads);
+	free(pool);
+}
+
+// Queues run(user_data) as part of `group`. From a worker the job goes to the
+// worker's own queue, where it is likely to run next while its data is warm.
+void job_pool_submit(struct job_pool *pool, struct job_group *group, void (*run)(void *user_data), void *user_data) {
+	assert(pool != NULL);
+	assert(group != NULL);
+	assert(run != NULL);
+	
+	struct job job;
+	job.run = run;
+	job.user_data = user_data;
+	job.group = group;
+	
+	int index = job_pool_queue_index(pool);
+	
+	pthread_mutex_lock(&pool->mutex);
+	group->pending++;
+	pool->queued++;
+	if ((index == pool->thread_count) && (pool->thread_count > 0)) {
+		index = pool->next_queue;
+		pool->next_queue = (pool->next_queue + 1) % pool->thread_count;
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	
+	job_queue_push(&pool->queues[index], job);
+	
+	pthread_mutex_lock(&pool->mutex);
+	pthread_cond_broadcast(&pool->changed);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+// Returns once every job of `group` has finished, running queued jobs (of any
+// group) in the meantime.
+void job_pool_wait(struct job_pool *pool, struct job_group *group) {
+	assert(pool != NULL);
+	assert(group != NULL);
+	
+	int index = job_pool_queue_index(pool);
+	
+	for (;;) {
+		struct job job;
+		if (job_pool_take(pool, index, &job)) {
+			job_pool_run(pool, &job);
+			continue;
+		}
+		
+		pthread_mutex_lock(&pool->mutex);
+		while ((group->pending > 0) && (pool->queued == 0)) {
+			pthread_cond_wait(&pool->changed, &pool->mutex);
+		}
+		bool done = group->pending == 0;
+		pthread_mutex_unlock(&pool->mutex);
+		
+		if (done) return;
+	}
+}
\ No newline at end of file
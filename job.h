@@ -0,0 +1,66 @@
+#pragma once
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// 								Jobs
+////////////////////////////////////////////////////////////////////////////////
+// A fixed set of worker threads running submitted functions. Every thread has
+// its own queue: it runs its newest job first and, when it has none left,
+// steals the oldest job of another queue. Jobs submitted from outside the pool
+// are dealt out to the queues in turn. A thread waiting on a job_group runs
+// queued jobs until the group is done, so jobs may submit and wait on jobs of
+// their own, and a pool without workers runs everything in job_pool_wait.
+
+////////////////////////////////////////////////////////////////////////////////
+// Job group
+////////////////////////////////////////////////////////////////////////////////
+struct job_group {
+	int pending; // submitted and not finished, guarded by the pool's mutex
+};
+
+struct job_group job_group_create(void);
+
+////////////////////////////////////////////////////////////////////////////////
+// Job queue
+////////////////////////////////////////////////////////////////////////////////
+struct job {
+	void (*run)(void *user_data);
+	void *user_data;
+	struct job_group *group;
+};
+
+// A ring buffer: the owner pushes and pops at the back, thieves take from the
+// front.
+struct job_queue {
+	pthread_mutex_t mutex;
+	int head;
+	int length;
+	int capacity;
+	struct job *items;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Job pool
+////////////////////////////////////////////////////////////////////////////////
+// The pool is shared with its threads and lives on the heap.
+struct job_pool {
+	int thread_count;
+	pthread_t *threads;
+	struct job_queue *queues; // [thread_count + 1], the last for threads outside the pool
+	
+	pthread_mutex_t mutex;
+	pthread_cond_t changed; // a job was queued, a group finished or the pool is stopping
+	int queued;             // jobs in all queues
+	int next_queue;         // where the next job from outside goes
+	bool stopping;
+};
+
+int job_pool_default_thread_count(void);
+struct job_pool *job_pool_create(int thread_count);
+void job_pool_destroy(struct job_pool *pool);
+void job_pool_submit(struct job_pool *pool, struct job_group *group, void (*run)(void *user_data), void *user_data);
+void job_pool_wait(struct job_pool *pool, struct job_group *group);
\ No newline at end of file
@@ -0,0 +1,489 @@
+#include "load.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 							Batch loading
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Load status
+////////////////////////////////////////////////////////////////////////////////
+const char *spriter_load_status_name(enum spriter_load_status status) {
+	switch (status) {
+		case spriter_load_status_ok: return "ok";
+		case spriter_load_status_unreadable: return "unreadable";
+		case spriter_load_status_cancelled: return "cancelled";
+	}
+	
+	return "unknown";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Spriter batch
+////////////////////////////////////////////////////////////////////////////////
+struct spriter_batch_job {
+	char *filepath;
+	struct arena *arena;
+	struct spriter_data *spriter_data;
+	enum spriter_load_status *status;
+};
+
+static void spriter_batch_job_run(void *user_data) {
+	struct spriter_batch_job *job = user_data;
+	
+	struct mapped_file mapped_file = mapped_file_open(job->filepath);
+	if (!mapped_file.is_open) {
+		*job->spriter_data = spriter_data_create(job->arena);
+		*job->status = spriter_load_status_unreadable;
+		return;
+	}
+	
+	*job->spriter_data = parse_spriter_buffer(mapped_file.data, mapped_file.length, job->arena);
+	*job->status = spriter_load_status_ok;
+	
+	mapped_file_close(&mapped_file);
+}
+
+// Loads `count` files on `pool`, the calling thread included. `arenas` is
+// either NULL, for the heap, or one arena per file: an arena is not safe to
+// share between threads.
+struct spriter_batch spriter_batch_load_with_pool(struct job_pool *pool, char **filepaths, int count, struct arena *arenas) {
+	assert(pool != NULL);
+	assert((filepaths != NULL) || (count == 0));
+	
+	struct spriter_batch batch;
+	batch.length = count;
+	batch.items = malloc(sizeof(struct spriter_data) * count);
+	batch.statuses = malloc(sizeof(enum spriter_load_status) * count);
+	assert((count == 0) || ((batch.items != NULL) && (batch.statuses != NULL)));
+	
+	struct spriter_batch_job *jobs = malloc(sizeof(struct spriter_batch_job) * count);
+	assert((count == 0) || (jobs != NULL));
+	
+	struct job_group group = job_group_create();
+	for (int i = 0; i < count; i++) {
+		jobs[i].filepath = filepaths[i];
+		jobs[i].arena = (arenas != NULL) ? &arenas[i] : NULL;
+		jobs[i].spriter_data = &batch.items[i];
+		jobs[i].status = &batch.statuses[i];
+		job_pool_submit(pool, &group, spriter_batch_job_run, &jobs[i]);
+	}
+	job_pool_wait(pool, &group);
+	
+	free(jobs);
+	return batch;
+}
+
+// Same, on a pool made for the call: `thread_count` threads in all, counting
+// the calling one, or one per processor when 0 or less.
+struct spriter_batch spriter_batch_load(char **filepaths, int count, int thread_count, struct arena *arenas) {
+	if (thread_count <= 0) thread_count = job_pool_default_thread_count();
+	if (thread_count > count) thread_count = (count > 0) ? count : 1;
+	
+	struct job_pool *pool = job_pool_create(thread_count - 1);
+	struct spriter_batch batch = spriter_batch_load_with_pool(pool, filepaths, count, arenas);
+	job_pool_destroy(pool);
+	
+	return batch;
+}
+
+void spriter_batch_destroy(struct spriter_batch *batch) {
+	assert(batch != NULL);
+	
+	for (int i = 0; i < batch->length; i++) {
+		spriter_data_destroy(&batch->items[i]);
+	}
+	
+	free(batch->items);
+	free(batch->statuses);
+	batch->items = NULL;
+	batch->statuses = NULL;
+	batch->length = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Parallel parsing
+////////////////////////////////////////////////////////////////////////////////
+// One <animation> element, built on its own into `animation`. The job's arena
+// is adopted by the caller's afterwards.
+struct animation_chunk_job {
+	const char *buffer;
+	int start;
+	int end;
+	struct arena arena;
+	bool use_arena;
+	struct animation animation;
+	int entity_index;    // where the animation goes
+	int animation_index;
+};
+
+static void animation_chunk_job_run(void *user_data) {
+	struct animation_chunk_job *job = user_data;
+	struct arena *arena = job->use_arena ? &job->arena : NULL;
+	
+	// The chunk is parsed into an entity of its own, to be taken apart below.
+	struct scml_builder builder = scml_builder_create(arena);
+	scml_builder_enter(&builder, tag_type_spriter_data);
+	scml_builder_enter(&builder, tag_type_entity);
+	struct string name = string_create_from_view(string_view_create("", 0), arena);
+	entity_list_append(&builder.spriter_data.entity_list, entity_create(0, name, arena));
+	
+	struct xml_handler handler = scml_builder_handler(&builder);
+	parse_buffer_stream(job->buffer + job->start, job->end - job->start, &handler);
+	scml_builder_finish(&builder);
+	
+	struct animation_list *animations = &builder.spriter_data.entity_list.items[0].animation_list;
+	assert(animations->length == 1);
+	job->animation = animations->items[0];
+	animations->length = 0;
+	
+	spriter_data_destroy(&builder.spriter_data);
+	scml_builder_destroy(&builder);
+}
+
+// Points every list of an animation built in a job's arena at the arena that
+// adopted its blocks.
+static void animation_rebind_arena(struct animation *animation, struct arena *arena) {
+	struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+	mainline_keys->arena = arena;
+	for (int i = 0; i < mainline_keys->length; i++) {
+		mainline_keys->items[i].object_ref_list.arena = arena;
+		mainline_keys->items[i].bone_ref_list.arena = arena;
+	}
+	
+	struct timeline_list *timelines = &animation->timeline_list;
+	timelines->arena = arena;
+	for (int i = 0; i < timelines->length; i++) {
+		struct timeline_key_list *timeline_keys = &timelines->items[i].timeline_key_list;
+		timeline_keys->arena = arena;
+		for (int j = 0; j < timeline_keys->length; j++) {
+			timeline_keys->items[j].object_list.arena = arena;
+			timeline_keys->items[j].bone_list.arena = arena;
+		}
+	}
+}
+
+// Same result as parse_spriter_buffer. The top-level <animation> elements are
+// found first, with find_element, and each is parsed as a job on `pool`; the
+// calling thread parses what lies between them, folders and entities, then
+// helps with the animations. They are put back in file order, so only files
+// with several large animations gain anything. Each builder orders the bones
+// of the mainline keys it closes, so nothing walks the result afterwards.
+struct spriter_data parse_spriter_buffer_parallel(struct job_pool *pool, const char *buffer, int length, struct arena *arena) {
+	assert(pool != NULL);
+	assert(buffer != NULL || length == 0);
+	
+	int count = 0;
+	int capacity = 0;
+	struct animation_chunk_job *jobs = NULL;
+	
+	int start, end;
+	for (int i = 0; find_element(buffer, length, i, "animation", &start, &end); i = end) {
+		if (count == capacity) {
+			capacity = (capacity == 0) ? 16 : capacity * 2;
+			jobs = realloc(jobs, sizeof(struct animation_chunk_job) * capacity);
+			assert(jobs != NULL);
+		}
+		
+		struct animation_chunk_job *job = &jobs[count++];
+		job->buffer = buffer;
+		job->start = start;
+		job->end = end;
+		job->use_arena = arena != NULL;
+		job->arena = arena_create((arena != NULL) ? arena->block_size : ARENA_DEFAULT_BLOCK_SIZE);
+	}
+	
+	if (count < 2) {
+		free(jobs);
+		return parse_spriter_buffer(buffer, length, arena);
+	}
+	
+	struct job_group group = job_group_create();
+	for (int i = 0; i < count; i++) {
+		job_pool_submit(pool, &group, animation_chunk_job_run, &jobs[i]);
+	}
+	
+	// Each animation gets a placeholder in its entity, replaced once its job is
+	// done.
+	struct scml_builder builder = scml_builder_create(arena);
+	struct xml_handler handler = scml_builder_handler(&builder);
+	
+	int gap_start = 0;
+	for (int i = 0; i < count; i++) {
+		parse_buffer_stream(buffer + gap_start, jobs[i].start - gap_start, &handler);
+		gap_start = jobs[i].end;
+		
+		struct entity_list *entities = &builder.spriter_data.entity_list;
+		assert(entities->length > 0); // an <animation> outside any <entity>
+		
+		struct animation placeholder;
+		memset(&placeholder, 0, sizeof(struct animation));
+		
+		struct entity *entity = entity_list_top(entities);
+		jobs[i].entity_index = entities->length - 1;
+		jobs[i].animation_index = entity->animation_list.length;
+		animation_list_append(&entity->animation_list, placeholder);
+	}
+	parse_buffer_stream(buffer + gap_start, length - gap_start, &handler);
+	scml_builder_finish(&builder);
+	
+	job_pool_wait(pool, &group);
+	
+	struct spriter_data spriter_data = builder.spriter_data;
+	for (int i = 0; i < count; i++) {
+		struct entity *entity = &spriter_data.entity_list.items[jobs[i].entity_index];
+		struct animation *animation = &entity->animation_list.items[jobs[i].animation_index];
+		*animation = jobs[i].animation;
+		
+		if (arena != NULL) {
+			arena_adopt(arena, &jobs[i].arena);
+			animation_rebind_arena(animation, arena);
+		}
+	}
+	
+	scml_builder_destroy(&builder);
+	free(jobs);
+	
+	return spriter_data;
+}
+
+// A file that cannot be opened gives an empty spriter_data. `status`, when not
+// NULL, tells the two apart.
+struct spriter_data parse_spriter_file_parallel(struct job_pool *pool, char *filepath, struct arena *arena, enum spriter_load_status *status) {
+	struct mapped_file mapped_file = mapped_file_open(filepath);
+	if (!mapped_file.is_open) {
+		if (status != NULL) *status = spriter_load_status_unreadable;
+		return spriter_data_create(arena);
+	}
+	
+	struct spriter_data spriter_data = parse_spriter_buffer_parallel(pool, mapped_file.data, mapped_file.length, arena);
+	if (status != NULL) *status = spriter_load_status_ok;
+	mapped_file_close(&mapped_file);
+	
+	return spriter_data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Async loading
+////////////////////////////////////////////////////////////////////////////////
+static void spriter_load_run(void *user_data);
+
+// Called with the loader's mutex held; the caller submits what it returns.
+static struct spriter_load *spriter_loader_start_next(struct spriter_loader *loader) {
+	struct spriter_load *load = loader->queue_head;
+	if ((load == NULL) || (loader->running >= loader->max_running)) return NULL;
+	
+	loader->queue_head = load->next;
+	if (loader->queue_head == NULL) loader->queue_tail = NULL;
+	load->next = NULL;
+	
+	load->state = spriter_load_state_running;
+	loader->running++;
+	return load;
+}
+
+static bool spriter_load_is_cancelled(struct spriter_load *load) {
+	pthread_mutex_lock(&load->loader->mutex);
+	bool cancelled = load->cancelled;
+	pthread_mutex_unlock(&load->loader->mutex);
+	return cancelled;
+}
+
+// A cancelled load is dropped before reading and before building; one
+// cancelled while building is built, then thrown away.
+static void spriter_load_run(void *user_data) {
+	struct spriter_load *load = user_data;
+	struct spriter_loader *loader = load->loader;
+	
+	enum spriter_load_status status = spriter_load_status_cancelled;
+	struct spriter_data spriter_data;
+	bool built = false;
+	
+	if (!spriter_load_is_cancelled(load)) {
+		struct mapped_file mapped_file = mapped_file_open(load->filepath);
+		if (!mapped_file.is_open) {
+			status = spriter_load_status_unreadable;
+		} else {
+			if (!spriter_load_is_cancelled(load)) {
+				spriter_data = parse_spriter_buffer(mapped_file.data, mapped_file.length, load->arena);
+				status = spriter_load_status_ok;
+				built = true;
+			}
+			mapped_file_close(&mapped_file);
+		}
+	}
+	
+	pthread_mutex_lock(&loader->mutex);
+	
+	if (load->cancelled) {
+		if (built) spriter_data_destroy(&spriter_data);
+		built = false;
+		status = spriter_load_status_cancelled;
+	}
+	load->spriter_data = built ? spriter_data : spriter_data_create(load->arena);
+	load->status = status;
+	load->state = spriter_load_state_done;
+	
+	loader->running--;
+	struct spriter_load *next = spriter_loader_start_next(loader);
+	pthread_cond_broadcast(&loader->changed);
+	
+	pthread_mutex_unlock(&loader->mutex);
+	
+	if (next != NULL) job_pool_submit(loader->pool, &loader->group, spriter_load_run, next);
+}
+
+// Loads run on `pool`'s workers, which is why it needs at least one; the
+// pool must outlive the loader. `max_running` of 0 or less means one per
+// worker.
+struct spriter_loader *spriter_loader_create_with_pool(struct job_pool *pool, int max_running) {
+	assert(pool != NULL);
+	assert(pool->thread_count > 0);
+	
+	struct spriter_loader *loader = malloc(sizeof(struct spriter_loader));
+	assert(loader != NULL);
+	
+	loader->pool = pool;
+	loader->owns_pool = false;
+	loader->group = job_group_create();
+	loader->max_running = (max_running > 0) ? max_running : pool->thread_count;
+	
+	pthread_mutex_init(&loader->mutex, NULL);
+	pthread_cond_init(&loader->changed, NULL);
+	loader->running = 0;
+	loader->outstanding = 0;
+	loader->queue_head = NULL;
+	loader->queue_tail = NULL;
+	
+	return loader;
+}
+
+// Same, on `thread_count` background threads of its own (at least one).
+struct spriter_loader *spriter_loader_create(int thread_count, int max_running) {
+	if (thread_count <= 0) thread_count = 1;
+	
+	struct spriter_loader *loader = spriter_loader_create_with_pool(job_pool_create(thread_count), max_running);
+	loader->owns_pool = true;
+	return loader;
+}
+
+// Every load must have been collected.
+void spriter_loader_destroy(struct spriter_loader *loader) {
+	assert(loader != NULL);
+	assert(loader->outstanding == 0);
+	
+	job_pool_wait(loader->pool, &loader->group);
+	if (loader->owns_pool) job_pool_destroy(loader->pool);
+	
+	pthread_cond_destroy(&loader->changed);
+	pthread_mutex_destroy(&loader->mutex);
+	free(loader);
+}
+
+// Returns at once. `arena` is used by the worker until the load is done, and
+// must not be used elsewhere meanwhile.
+struct spriter_load *spriter_load_async(struct spriter_loader *loader, const char *filepath, struct arena *arena) {
+	assert(loader != NULL);
+	assert(filepath != NULL);
+	
+	struct spriter_load *load = malloc(sizeof(struct spriter_load));
+	assert(load != NULL);
+	
+	size_t length = strlen(filepath);
+	load->loader = loader;
+	load->filepath = malloc(length + 1);
+	assert(load->filepath != NULL);
+	memcpy(load->filepath, filepath, length + 1);
+	load->arena = arena;
+	load->state = spriter_load_state_queued;
+	load->cancelled = false;
+	load->status = spriter_load_status_cancelled;
+	load->next = NULL;
+	
+	pthread_mutex_lock(&loader->mutex);
+	
+	loader->outstanding++;
+	if (loader->queue_tail != NULL) {
+		loader->queue_tail->next = load;
+	} else {
+		loader->queue_head = load;
+	}
+	loader->queue_tail = load;
+	struct spriter_load *next = spriter_loader_start_next(loader);
+	
+	pthread_mutex_unlock(&loader->mutex);
+	
+	if (next != NULL) job_pool_submit(loader->pool, &loader->group, spriter_load_run, next);
+	
+	return load;
+}
+
+bool spriter_load_is_done(struct spriter_load *load) {
+	assert(load != NULL);
+	
+	pthread_mutex_lock(&load->loader->mutex);
+	bool done = load->state == spriter_load_state_done;
+	pthread_mutex_unlock(&load->loader->mutex);
+	return done;
+}
+
+void spriter_load_wait(struct spriter_load *load) {
+	assert(load != NULL);
+	
+	struct spriter_loader *loader = load->loader;
+	pthread_mutex_lock(&loader->mutex);
+	while (load->state != spriter_load_state_done) {
+		pthread_cond_wait(&loader->changed, &loader->mutex);
+	}
+	pthread_mutex_unlock(&loader->mutex);
+}
+
+// A queued load is done at once; a running one as soon as its worker notices.
+// Either way it still has to be collected, with spriter_load_status_cancelled.
+// A load that is already done keeps its result.
+void spriter_load_cancel(struct spriter_load *load) {
+	assert(load != NULL);
+	
+	struct spriter_loader *loader = load->loader;
+	pthread_mutex_lock(&loader->mutex);
+	
+	if (load->state == spriter_load_state_queued) {
+		struct spriter_load **link = &loader->queue_head;
+		struct spriter_load *previous = NULL;
+		while (*link != load) {
+			previous = *link;
+			link = &(*link)->next;
+		}
+		*link = load->next;
+		if (loader->queue_tail == load) loader->queue_tail = previous;
+		
+		load->spriter_data = spriter_data_create(load->arena);
+		load->status = spriter_load_status_cancelled;
+		load->state = spriter_load_state_done;
+		pthread_cond_broadcast(&loader->changed);
+	}
+	if (load->state != spriter_load_state_done) load->cancelled = true;
+	
+	pthread_mutex_unlock(&loader->mutex);
+}
+
+// Waits for the load, moves its spriter_data into `spriter_data` and frees the
+// load. The spriter_data is empty unless the status is ok, and is the
+// caller's to destroy either way.
+enum spriter_load_status spriter_load_collect(struct spriter_load *load, struct spriter_data *spriter_data) {
+	assert(load != NULL);
+	assert(spriter_data != NULL);
+	
+	spriter_load_wait(load);
+	
+	struct spriter_loader *loader = load->loader;
+	pthread_mutex_lock(&loader->mutex);
+	loader->outstanding--;
+	pthread_mutex_unlock(&loader->mutex);
+	
+	*spriter_data = load->spriter_data;
+	enum spriter_load_status status = load->status;
+	
+	free(load->filepath);
+	free(load);
+	return status;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "arena.h"
+#include "job.h"
+#include "scml.h"
+#include "xml.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// 							Batch loading
+////////////////////////////////////////////////////////////////////////////////
+// Parses many SCML files at once, one job per file on a job_pool. Files share
+// nothing while parsing, so the only coordination is the pool's. A single
+// large file can also be split: its animations are parsed as separate jobs.
+// A spriter_loader loads in the background while the caller keeps running.
+
+////////////////////////////////////////////////////////////////////////////////
+// Load status
+////////////////////////////////////////////////////////////////////////////////
+enum spriter_load_status {
+	spriter_load_status_ok,
+	spriter_load_status_unreadable, // missing, or could not be opened
+	spriter_load_status_cancelled,
+};
+
+const char *spriter_load_status_name(enum spriter_load_status status);
+
+////////////////////////////////////////////////////////////////////////////////
+// Spriter batch
+////////////////////////////////////////////////////////////////////////////////
+// File i ends up in items[i] with statuses[i]; an item whose file failed is
+// empty but can still be destroyed.
+struct spriter_batch {
+	int length;
+	struct spriter_data *items;
+	enum spriter_load_status *statuses;
+};
+
+struct spriter_batch spriter_batch_load(char **filepaths, int count, int thread_count, struct arena *arenas);
+struct spriter_batch spriter_batch_load_with_pool(struct job_pool *pool, char **filepaths, int count, struct arena *arenas);
+void spriter_batch_destroy(struct spriter_batch *batch);
+
+////////////////////////////////////////////////////////////////////////////////
+// Parallel parsing
+////////////////////////////////////////////////////////////////////////////////
+struct spriter_data parse_spriter_buffer_parallel(struct job_pool *pool, const char *buffer, int length, struct arena *arena);
+struct spriter_data parse_spriter_file_parallel(struct job_pool *pool, char *filepath, struct arena *arena, enum spriter_load_status *status);
+
+////////////////////////////////////////////////////////////////////////////////
+// Async loading
+////////////////////////////////////////////////////////////////////////////////
+// Files are read, tokenized and built on the workers of a job_pool, never on
+// the thread that asks for them. At most `max_running` loads run at once; the
+// others wait in submission order. A load is a handle the caller polls or
+// waits on, then collects, which frees it.
+enum spriter_load_state {
+	spriter_load_state_queued,
+	spriter_load_state_running,
+	spriter_load_state_done,
+};
+
+struct spriter_load {
+	struct spriter_loader *loader;
+	char *filepath; // copied
+	struct arena *arena;
+	
+	// Guarded by the loader's mutex.
+	enum spriter_load_state state;
+	bool cancelled;
+	enum spriter_load_status status;
+	struct spriter_data spriter_data;
+	struct spriter_load *next; // in the queue
+};
+
+struct spriter_loader {
+	struct job_pool *pool;
+	bool owns_pool;
+	struct job_group group; // running loads
+	int max_running;
+	
+	pthread_mutex_t mutex;
+	pthread_cond_t changed; // a load is done
+	int running;
+	int outstanding; // submitted and not collected
+	struct spriter_load *queue_head;
+	struct spriter_load *queue_tail;
+};
+
+struct spriter_loader *spriter_loader_create(int thread_count, int max_running);
+struct spriter_loader *spriter_loader_create_with_pool(struct job_pool *pool, int max_running);
+void spriter_loader_destroy(struct spriter_loader *loader);
+struct spriter_load *spriter_load_async(struct spriter_loader *loader, const char *filepath, struct arena *arena);
+bool spriter_load_is_done(struct spriter_load *load);
+void spriter_load_wait(struct spriter_load *load);
+void spriter_load_cancel(struct spriter_load *load);
+enum spriter_load_status spriter_load_collect(struct spriter_load *load, struct spriter_data *spriter_data);
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "rig.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 								Rigs
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Rig
+////////////////////////////////////////////////////////////////////////////////
+// Takes over `spriter_data` and bakes it, in the same arena if it has one; that
+// arena must then outlive the rig. The rig starts with one reference, the
+// caller's.
+struct rig *rig_create(struct spriter_data spriter_data) {
+	struct rig *rig = malloc(sizeof(struct rig));
+	assert(rig != NULL);
+	
+	rig->references = 1;
+	rig->spriter_data = spriter_data;
+	rig->baked_data = baked_data_create(&rig->spriter_data, spriter_data.arena);
+	rig->memory = sizeof(struct rig) + spriter_data_memory(&rig->spriter_data) + baked_data_memory(&rig->baked_data);
+	
+	return rig;
+}
+
+struct rig *rig_retain(struct rig *rig) {
+	assert(rig != NULL);
+	
+	__atomic_add_fetch(&rig->references, 1, __ATOMIC_RELAXED);
+	return rig;
+}
+
+// The last release destroys the rig. Whatever the other threads wrote before
+// releasing happens before that.
+void rig_release(struct rig *rig) {
+	assert(rig != NULL);
+	
+	if (__atomic_sub_fetch(&rig->references, 1, __ATOMIC_ACQ_REL) > 0) return;
+	
+	baked_data_destroy(&rig->baked_data);
+	spriter_data_destroy(&rig->spriter_data);
+	free(rig);
+}
+
+// Index of the entity's animation called `name`, or -1.
+int rig_find_animation(struct rig *rig, int entity_index, const char *name) {
+	assert(rig != NULL);
+	assert((entity_index >= 0) && (entity_index < rig->spriter_data.entity_list.length));
+	assert(name != NULL);
+	
+	struct animation_list *animations = &rig->spriter_data.entity_list.items[entity_index].animation_list;
+	for (int i = 0; i < animations->length; i++) {
+		if (string_compare(&animations->items[i].name, name)) return i;
+	}
+	
+	return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Rig instance
+////////////////////////////////////////////////////////////////////////////////
+static struct baked_animation *rig_instance_baked_animation(struct rig_instance *instance, int animation_index) {
+	return &instance->rig->baked_data.entities[instance->entity].animations[animation_index];
+}
+
+// Same wrapping as the samplers, so that a time played for hours keeps its
+// precision.
+static float rig_instance_advance(struct baked_animation *baked_animation, float time, float elapsed) {
+	float length = (float)baked_animation->length;
+	if (length <= 0.0f) return 0.0f;
+	
+	time += elapsed;
+	if (!baked_animation->looping) {
+		if (time < 0.0f) return 0.0f;
+		if (time > length) return length;
+		return time;
+	}
+	
+	time = fmodf(time, length);
+	if (time < 0.0f) time += length;
+	return time;
+}
+
+struct rig_instance rig_instance_create(struct rig *rig, int entity_index) {
+	assert(rig != NULL);
+	assert((entity_index >= 0) && (entity_index < rig->baked_data.entity_count));
+	
+	struct rig_instance instance;
+	instance.rig = rig_retain(rig);
+	instance.entity = entity_index;
+	instance.speed = 1.0f;
+	instance.animation = -1;
+	instance.time = 0.0f;
+	instance.cursor = animation_cursor_create();
+	instance.previous_animation = -1;
+	instance.previous_time = 0.0f;
+	instance.previous_cursor = animation_cursor_create();
+	instance.fade_time = 0.0f;
+	instance.fade_duration = 0.0f;
+	return instance;
+}
+
+void rig_instance_destroy(struct rig_instance *instance) {
+	assert(instance != NULL);
+	
+	if (instance->rig != NULL) rig_release(instance->rig);
+	instance->rig = NULL;
+}
+
+// A pose large enough for any animation of the instance's entity. Instances of
+// the same entity can share one per thread.
+struct pose rig_instance_pose_create(struct rig_instance *instance, struct arena *arena) {
+	assert(instance != NULL);
+	
+	struct baked_entity *baked_entity = &instance->rig->baked_data.entities[instance->entity];
+	return pose_create(baked_entity->bone_capacity, baked_entity->object_capacity, arena);
+}
+
+// Starts `animation_index` from its beginning. With a `fade_duration` above 0
+// the animation playing until now keeps playing and fades out over that many
+// milliseconds.
+void rig_instance_play(struct rig_instance *instance, int animation_index, float fade_duration) {
+	assert(instance != NULL);
+	assert((animation_index >= 0) && (animation_index < instance->rig->baked_data.entities[instance->entity].animation_count));
+	
+	if ((fade_duration > 0.0f) && (instance->animation >= 0)) {
+		instance->previous_animation = instance->animation;
+		instance->previous_time = instance->time;
+		instance->previous_cursor = instance->cursor;
+		instance->fade_time = 0.0f;
+		instance->fade_duration = fade_duration;
+	} else {
+		instance->previous_animation = -1;
+		instance->fade_time = 0.0f;
+		instance->fade_duration = 0.0f;
+	}
+	
+	instance->animation = animation_index;
+	instance->time = 0.0f;
+	animation_cursor_reset(&instance->cursor);
+}
+
+// Moves the instance `elapsed` milliseconds forward, scaled by its speed.
+void rig_instance_update(struct rig_instance *instance, float elapsed) {
+	assert(instance != NULL);
+	
+	if (instance->animation < 0) return;
+	
+	elapsed *= instance->speed;
+	instance->time = rig_instance_advance(rig_instance_baked_animation(instance, instance->animation), instance->time, elapsed);
+	
+	if (instance->previous_animation < 0) return;
+	
+	instance->fade_time += elapsed;
+	if (instance->fade_time >= instance->fade_duration) {
+		instance->previous_animation = -1;
+		instance->fade_time = 0.0f;
+		instance->fade_duration = 0.0f;
+		return;
+	}
+	
+	instance->previous_time = rig_instance_advance(rig_instance_baked_animation(instance, instance->previous_animation), instance->previous_time, elapsed);
+}
+
+// Weight of the current animation in the pose, from 0 when a fade starts to 1
+// once it is over.
+float rig_instance_blend_weight(struct rig_instance *instance) {
+	assert(instance != NULL);
+	
+	if ((instance->previous_animation < 0) || (instance->fade_duration <= 0.0f)) return 1.0f;
+	
+	float weight = instance->fade_time / instance->fade_duration;
+	return (weight < 0.0f) ? 0.0f : (weight > 1.0f) ? 1.0f : weight;
+}
+
+// Blends along the shorter way round, as the two angles come from unrelated
+// keys.
+static struct transform rig_instance_blend(struct transform from, struct transform to, float weight) {
+	float turn = fmodf(to.angle - from.angle, 360.0f);
+	if (turn < 0.0f) turn += 360.0f;
+	
+	return transform_lerp(from, to, weight, (turn <= 180.0f) ? 1 : -1);
+}
+
+// Samples the current animation into `pose`. While fading, the previous
+// animation is sampled into `scratch`, which must be as large as `pose`, and
+// blended in: bones and objects are matched by their index in the mainline
+// key, and only when they hang from the same parent. Like the other samplers
+// this leaves world transforms to pose_compute_world.
+void rig_instance_sample_pose(struct rig_instance *instance, struct pose *pose, struct pose *scratch) {
+	assert(instance != NULL);
+	assert(pose != NULL);
+	assert(instance->animation >= 0);
+	
+	baked_animation_sample_pose_with_cursor(rig_instance_baked_animation(instance, instance->animation), instance->time, &instance->cursor, pose);
+	
+	if ((instance->previous_animation < 0) || (scratch == NULL)) return;
+	
+	struct baked_animation *previous = rig_instance_baked_animation(instance, instance->previous_animation);
+	baked_animation_sample_pose_with_cursor(previous, instance->previous_time, &instance->previous_cursor, scratch);
+	
+	float weight = rig_instance_blend_weight(instance);
+	
+	int bone_count = (pose->bone_count < scratch->bone_count) ? pose->bone_count : scratch->bone_count;
+	for (int i = 0; i < bone_count; i++) {
+		struct pose_bone *bone = &pose->bones[i];
+		if (bone->parent != scratch->bones[i].parent) continue;
+		bone->local = rig_instance_blend(scratch->bones[i].local, bone->local, weight);
+	}
+	
+	int object_count = (pose->object_count < scratch->object_count) ? pose->object_count : scratch->object_count;
+	for (int i = 0; i < object_count; i++) {
+		struct pose_object *object = &pose->objects[i];
+		if (object->parent != scratch->objects[i].parent) continue;
+		object->local = rig_instance_blend(scratch->objects[i].local, object->local, weight);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "bake.h"
+#include "runtime.h"
+#include "scml.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// 								Rigs
+////////////////////////////////////////////////////////////////////////////////
+// A rig is the part of a character that every copy shares: the spriter_data
+// it was loaded from and its baked animations. It is reference counted and
+// read-only once created, so any number of threads sample it without locks;
+// only retaining and releasing write to it, atomically. What changes while a
+// character plays (animation, time, cursor, crossfade) is a rig_instance of a
+// few dozen bytes.
+
+////////////////////////////////////////////////////////////////////////////////
+// Rig
+////////////////////////////////////////////////////////////////////////////////
+struct rig {
+	int references; // atomic
+	struct spriter_data spriter_data;
+	struct baked_data baked_data;
+	size_t memory; // of both, see rig_create
+};
+
+struct rig *rig_create(struct spriter_data spriter_data);
+struct rig *rig_retain(struct rig *rig);
+void rig_release(struct rig *rig);
+int rig_find_animation(struct rig *rig, int entity_index, const char *name);
+
+////////////////////////////////////////////////////////////////////////////////
+// Rig instance
+////////////////////////////////////////////////////////////////////////////////
+// Times are in milliseconds of the animation, already wrapped or clamped.
+// While `fade_duration` is above 0, the pose is the previous animation's
+// blended into the current one by rig_instance_blend_weight.
+struct rig_instance {
+	struct rig *rig; // retained
+	int entity;
+	float speed; // 1 plays at the authored rate, 0 pauses
+	
+	int animation; // -1 until the first rig_instance_play
+	float time;
+	struct animation_cursor cursor;
+	
+	int previous_animation; // -1 when not fading
+	float previous_time;
+	struct animation_cursor previous_cursor;
+	float fade_time;
+	float fade_duration;
+};
+
+struct rig_instance rig_instance_create(struct rig *rig, int entity_index);
+void rig_instance_destroy(struct rig_instance *instance);
+struct pose rig_instance_pose_create(struct rig_instance *instance, struct arena *arena);
+void rig_instance_play(struct rig_instance *instance, int animation_index, float fade_duration);
+void rig_instance_update(struct rig_instance *instance, float elapsed);
+float rig_instance_blend_weight(struct rig_instance *instance);
+void rig_instance_sample_pose(struct rig_instance *instance, struct pose *pose, struct pose *scratch);
\ No newline at end of file
@@ -0,0 +1,571 @@
+#include "runtime.h"
+
+#if !defined(RUNTIME_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define RUNTIME_HAS_SSE2 1
+#else
+#define RUNTIME_HAS_SSE2 0
+#endif
+#if !defined(RUNTIME_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RUNTIME_HAS_AVX2 1
+#else
+#define RUNTIME_HAS_AVX2 0
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// 							Runtime
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Transform
+////////////////////////////////////////////////////////////////////////////////
+struct transform transform_create(float x, float y, float angle, float scale_x, float scale_y, float a) {
+	struct transform transform;
+	transform.x = x;
+	transform.y = y;
+	transform.angle = angle;
+	transform.scale_x = scale_x;
+	transform.scale_y = scale_y;
+	transform.a = a;
+	return transform;
+}
+
+// Angles turn the way the key's spin says: 1 counter-clockwise, -1 clockwise
+// and 0 not at all.
+struct transform transform_lerp(struct transform from, struct transform to, float t, int spin) {
+	float angle = from.angle;
+	if (spin != 0) {
+		float end = to.angle;
+		if ((spin > 0) && (end < from.angle)) end += 360.0f;
+		if ((spin < 0) && (end > from.angle)) end -= 360.0f;
+		angle = from.angle + (end - from.angle) * t;
+	}
+	
+	struct transform transform;
+	transform.x = from.x + (to.x - from.x) * t;
+	transform.y = from.y + (to.y - from.y) * t;
+	transform.angle = angle;
+	transform.scale_x = from.scale_x + (to.scale_x - from.scale_x) * t;
+	transform.scale_y = from.scale_y + (to.scale_y - from.scale_y) * t;
+	transform.a = from.a + (to.a - from.a) * t;
+	return transform;
+}
+
+// Places `local`, expressed in its parent's space, into the space the parent
+// itself lives in. A mirrored parent (one negative scale) mirrors the angle.
+struct transform transform_compose(struct transform parent, struct transform local) {
+	float radians = parent.angle * (3.14159265358979f / 180.0f);
+	float c = cosf(radians);
+	float s = sinf(radians);
+	float x = local.x * parent.scale_x;
+	float y = local.y * parent.scale_y;
+	
+	struct transform transform;
+	transform.x = parent.x + x * c - y * s;
+	transform.y = parent.y + x * s + y * c;
+	transform.angle = parent.angle + (((parent.scale_x * parent.scale_y) < 0.0f) ? -local.angle : local.angle);
+	transform.scale_x = parent.scale_x * local.scale_x;
+	transform.scale_y = parent.scale_y * local.scale_y;
+	transform.a = parent.a * local.a;
+	return transform;
+}
+
+static struct transform bone_transform(struct bone *bone) {
+	return transform_create(bone->x, bone->y, bone->angle, bone->scale_x, bone->scale_y, bone->a);
+}
+
+static struct transform object_transform(struct object *object) {
+	return transform_create(object->x, object->y, object->angle, object->scale_x, object->scale_y, object->a);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Pose
+////////////////////////////////////////////////////////////////////////////////
+struct pose pose_create(int bone_capacity, int object_capacity, struct arena *arena) {
+	assert(bone_capacity >= 0);
+	assert(object_capacity >= 0);
+	
+	struct pose pose;
+	pose.bone_count = 0;
+	pose.bone_capacity = bone_capacity;
+	pose.bones = memory_alloc(arena, sizeof(struct pose_bone) * bone_capacity);
+	pose.object_count = 0;
+	pose.object_capacity = object_capacity;
+	pose.objects = memory_alloc(arena, sizeof(struct pose_object) * object_capacity);
+	pose.arena = arena;
+	return pose;
+}
+
+// Sized for the largest mainline key of any of the entity's animations.
+struct pose pose_create_for_entity(struct entity *entity, struct arena *arena) {
+	assert(entity != NULL);
+	
+	int bone_capacity = 0;
+	int object_capacity = 0;
+	
+	for (int i = 0; i < entity->animation_list.length; i++) {
+		struct mainline_key_list *mainline_keys = &entity->animation_list.items[i].mainline.mainline_key_list;
+		
+		for (int j = 0; j < mainline_keys->length; j++) {
+			struct mainline_key *mainline_key = &mainline_keys->items[j];
+			if (mainline_key->bone_ref_list.length > bone_capacity) bone_capacity = mainline_key->bone_ref_list.length;
+			if (mainline_key->object_ref_list.length > object_capacity) object_capacity = mainline_key->object_ref_list.length;
+		}
+	}
+	
+	return pose_create(bone_capacity, object_capacity, arena);
+}
+
+void pose_destroy(struct pose *pose) {
+	assert(pose != NULL);
+	
+	if (pose->arena != NULL) return; // released with the arena
+	
+	memory_free(pose->arena, pose->bones);
+	memory_free(pose->arena, pose->objects);
+}
+
+// One linear pass: bones are stored parents first, so a bone's parent already
+// has its world transform when the bone is reached.
+void pose_compute_world(struct pose *pose) {
+	assert(pose != NULL);
+	
+	struct pose_bone *bones = pose->bones;
+	
+	for (int i = 0; i < pose->bone_count; i++) {
+		int parent = bones[i].parent;
+		assert(parent < i);
+		
+		bones[i].world = (parent < 0) ? bones[i].local : transform_compose(bones[parent].world, bones[i].local);
+	}
+	
+	for (int i = 0; i < pose->object_count; i++) {
+		struct pose_object *object = &pose->objects[i];
+		int parent = object->parent;
+		assert(parent < pose->bone_count);
+		
+		object->world = (parent < 0) ? object->local : transform_compose(bones[parent].world, object->local);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Key search
+////////////////////////////////////////////////////////////////////////////////
+// Looping animations wrap around their length, the others stop at either end.
+static float animation_wrap_time(struct animation *animation, float time) {
+	if (animation->length <= 0) return 0.0f;
+	
+	float length = (float)animation->length;
+	if (!animation->looping) {
+		if (time < 0.0f) return 0.0f;
+		if (time > length) return length;
+		return time;
+	}
+	
+	time = fmodf(time, length);
+	if (time < 0.0f) time += length;
+	return time;
+}
+
+// Index of the last mainline key in [first, length) at or before `time`, or
+// `first` when there is none.
+static int mainline_key_list_search(struct mainline_key_list *mainline_keys, int first, float time) {
+	int low = first + 1;
+	int high = mainline_keys->length;
+	
+	while (low < high) {
+		int middle = low + (high - low) / 2;
+		if ((float)mainline_keys->items[middle].time > time) {
+			high = middle;
+		} else {
+			low = middle + 1;
+		}
+	}
+	
+	return low - 1;
+}
+
+// Index of the last mainline key at or before `time`, which must already be
+// wrapped. Keys are stored in time order.
+int animation_find_mainline_key(struct animation *animation, float time) {
+	assert(animation != NULL);
+	
+	return mainline_key_list_search(&animation->mainline.mainline_key_list, 0, time);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Cursor
+////////////////////////////////////////////////////////////////////////////////
+struct animation_cursor animation_cursor_create(void) {
+	struct animation_cursor cursor;
+	cursor.mainline_key = -1;
+	return cursor;
+}
+
+void animation_cursor_reset(struct animation_cursor *cursor) {
+	assert(cursor != NULL);
+	
+	cursor->mainline_key = -1;
+}
+
+// Steps forward from the remembered key while the next one has started. A
+// time before the remembered key, which is what wrapping around the end of a
+// loop or seeking backwards looks like, restarts the search from the first
+// key; a time many keys ahead finishes with a binary search.
+int animation_cursor_find_mainline_key(struct animation_cursor *cursor, struct animation *animation, float time) {
+	assert(cursor != NULL);
+	assert(animation != NULL);
+	
+	struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+	int found = cursor->mainline_key;
+	
+	if ((found < 0) || (found >= mainline_keys->length) || ((float)mainline_keys->items[found].time > time)) {
+		found = mainline_key_list_search(mainline_keys, 0, time);
+	} else {
+		int steps = 0;
+		while ((found + 1 < mainline_keys->length) && ((float)mainline_keys->items[found + 1].time <= time)) {
+			if (++steps > ANIMATION_CURSOR_STEPS) {
+				found = mainline_key_list_search(mainline_keys, found, time);
+				break;
+			}
+			found++;
+		}
+	}
+	
+	cursor->mainline_key = found;
+	return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sampling
+////////////////////////////////////////////////////////////////////////////////
+
+static struct timeline *animation_timeline(struct animation *animation, int timeline) {
+	assert(timeline >= 0);
+	assert(timeline < animation->timeline_list.length);
+	
+	return &animation->timeline_list.items[timeline];
+}
+
+// Returns the key that `key_index` blends into and stores in `t` how far
+// `time` has moved towards it. The last key of a looping animation blends into
+// the first one at the end of the animation; otherwise it holds.
+static int timeline_next_key(struct animation *animation, struct timeline *timeline, int key_index, float time, float *t) {
+	struct timeline_key_list *keys = &timeline->timeline_key_list;
+	assert(key_index >= 0);
+	assert(key_index < keys->length);
+	
+	struct timeline_key *key = &keys->items[key_index];
+	int next_index = key_index + 1;
+	float next_time = 0.0f;
+	
+	if (next_index < keys->length) {
+		next_time = (float)keys->items[next_index].time;
+	} else if (!animation->looping) {
+		*t = 0.0f;
+		return key_index;
+	} else {
+		next_index = 0;
+		next_time = (float)(animation->length + keys->items[0].time);
+	}
+	
+	if ((next_index == key_index) || (next_time <= (float)key->time)) {
+		*t = 0.0f;
+		return key_index;
+	}
+	
+	float factor = (time - (float)key->time) / (next_time - (float)key->time);
+	if (factor < 0.0f) factor = 0.0f;
+	if (factor > 1.0f) factor = 1.0f;
+	
+	*t = factor;
+	return next_index;
+}
+
+// `time` is already wrapped and `mainline_key` is active at it.
+static void animation_sample_mainline_key(struct animation *animation, struct mainline_key *mainline_key, float time, struct pose *pose) {
+	assert(mainline_key->bone_ref_list.length <= pose->bone_capacity);
+	assert(mainline_key->object_ref_list.length <= pose->object_capacity);
+	
+	for (int i = 0; i < mainline_key->bone_ref_list.length; i++) {
+		struct bone_ref *bone_ref = &mainline_key->bone_ref_list.items[mainline_key_bone_ref_at(mainline_key, i)];
+		struct timeline *timeline = animation_timeline(animation, bone_ref->timeline);
+		
+		float t = 0.0f;
+		int next_index = timeline_next_key(animation, timeline, bone_ref->key, time, &t);
+		struct timeline_key *from = &timeline->timeline_key_list.items[bone_ref->key];
+		struct timeline_key *to = &timeline->timeline_key_list.items[next_index];
+		assert((from->bone_list.length > 0) && (to->bone_list.length > 0));
+		
+		struct pose_bone *bone = &pose->bones[i];
+		bone->local = transform_lerp(bone_transform(&from->bone_list.items[0]), bone_transform(&to->bone_list.items[0]), t, from->spin);
+		bone->parent = mainline_key_bone_parent(mainline_key, i);
+		bone->timeline = bone_ref->timeline;
+	}
+	pose->bone_count = mainline_key->bone_ref_list.length;
+	
+	for (int i = 0; i < mainline_key->object_ref_list.length; i++) {
+		struct object_ref *object_ref = &mainline_key->object_ref_list.items[i];
+		struct timeline *timeline = animation_timeline(animation, object_ref->timeline);
+		
+		float t = 0.0f;
+		int next_index = timeline_next_key(animation, timeline, object_ref->key, time, &t);
+		struct timeline_key *from = &timeline->timeline_key_list.items[object_ref->key];
+		struct timeline_key *to = &timeline->timeline_key_list.items[next_index];
+		assert((from->object_list.length > 0) && (to->object_list.length > 0));
+		
+		struct object *from_object = &from->object_list.items[0];
+		
+		struct pose_object *object = &pose->objects[i];
+		object->local = transform_lerp(object_transform(from_object), object_transform(&to->object_list.items[0]), t, from->spin);
+		object->parent = mainline_key_object_parent(mainline_key, i);
+		object->timeline = object_ref->timeline;
+		object->folder = from_object->folder;
+		object->file = from_object->file;
+		object->z_index = object_ref->z_index;
+	}
+	pose->object_count = mainline_key->object_ref_list.length;
+}
+
+void animation_sample_pose(struct animation *animation, float time, struct pose *pose) {
+	assert(animation != NULL);
+	assert(pose != NULL);
+	
+	pose->bone_count = 0;
+	pose->object_count = 0;
+	
+	struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+	if (mainline_keys->length == 0) return;
+	
+	time = animation_wrap_time(animation, time);
+	animation_sample_mainline_key(animation, &mainline_keys->items[animation_find_mainline_key(animation, time)], time, pose);
+}
+
+// Like animation_sample_pose, with the mainline key found through `cursor`.
+// Give each playing instance its own cursor.
+void animation_sample_pose_with_cursor(struct animation *animation, float time, struct animation_cursor *cursor, struct pose *pose) {
+	assert(animation != NULL);
+	assert(cursor != NULL);
+	assert(pose != NULL);
+	
+	pose->bone_count = 0;
+	pose->object_count = 0;
+	
+	struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+	if (mainline_keys->length == 0) return;
+	
+	time = animation_wrap_time(animation, time);
+	int index = animation_cursor_find_mainline_key(cursor, animation, time);
+	animation_sample_mainline_key(animation, &mainline_keys->items[index], time, pose);
+}
+
+void entity_sample_pose(struct entity *entity, int animation_index, float time, struct pose *pose) {
+	assert(entity != NULL);
+	assert(animation_index >= 0);
+	assert(animation_index < entity->animation_list.length);
+	
+	animation_sample_pose(&entity->animation_list.items[animation_index], time, pose);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Batch
+////////////////////////////////////////////////////////////////////////////////
+struct pose_batch pose_batch_create(int instance_capacity, int bone_capacity, struct arena *arena) {
+	assert(instance_capacity >= 0);
+	assert(bone_capacity >= 0);
+	
+	struct pose_batch batch;
+	batch.instance_count = 0;
+	batch.instance_capacity = instance_capacity;
+	batch.bone_count = 0;
+	batch.bone_capacity = bone_capacity;
+	batch.stride = (instance_capacity + POSE_BATCH_LANES - 1) / POSE_BATCH_LANES * POSE_BATCH_LANES;
+	batch.arena = arena;
+	
+	size_t lanes = (size_t)batch.stride * bone_capacity;
+	for (int c = 0; c < transform_channel_count; c++) {
+		batch.channels[c] = memory_alloc(arena, sizeof(float) * lanes);
+	}
+	batch.keys = memory_alloc(arena, sizeof(int) * POSE_BATCH_BLOCK);
+	batch.next_keys = memory_alloc(arena, sizeof(int) * POSE_BATCH_BLOCK);
+	batch.t = memory_alloc(arena, sizeof(float) * POSE_BATCH_BLOCK);
+	batch.spin = memory_alloc(arena, sizeof(float) * POSE_BATCH_BLOCK);
+	batch.parents = memory_alloc(arena, sizeof(int) * lanes);
+	batch.times = memory_alloc(arena, sizeof(float) * batch.stride);
+	batch.mainline_keys = memory_alloc(arena, sizeof(int) * batch.stride);
+	return batch;
+}
+
+void pose_batch_destroy(struct pose_batch *batch) {
+	assert(batch != NULL);
+	
+	if (batch->arena != NULL) return; // released with the arena
+	
+	for (int c = 0; c < transform_channel_count; c++) {
+		memory_free(batch->arena, batch->channels[c]);
+	}
+	memory_free(batch->arena, batch->keys);
+	memory_free(batch->arena, batch->next_keys);
+	memory_free(batch->arena, batch->t);
+	memory_free(batch->arena, batch->spin);
+	memory_free(batch->arena, batch->parents);
+	memory_free(batch->arena, batch->times);
+	memory_free(batch->arena, batch->mainline_keys);
+}
+
+struct transform pose_batch_bone(struct pose_batch *batch, int instance, int bone) {
+	assert(batch != NULL);
+	assert((instance >= 0) && (instance < batch->instance_count));
+	assert((bone >= 0) && (bone < batch->bone_count));
+	
+	int lane = bone * batch->stride + instance;
+	return transform_create(batch->channels[transform_channel_x][lane], batch->channels[transform_channel_y][lane],
+		batch->channels[transform_channel_angle][lane], batch->channels[transform_channel_scale_x][lane],
+		batch->channels[transform_channel_scale_y][lane], batch->channels[transform_channel_a][lane]);
+}
+
+typedef void (*pose_batch_kernel)(struct pose_batch *batch, float *const *key_channels, int lane, int start, int end);
+
+// Same rule as transform_lerp: spin picks the direction, 0 holds the angle.
+static void pose_batch_interpolate_lanes_scalar(struct pose_batch *batch, float *const *key_channels, int lane, int start, int end) {
+	const int *keys = batch->keys;
+	const int *next_keys = batch->next_keys;
+	const float *ts = batch->t;
+	const float *spins = batch->spin;
+	
+	for (int c = 0; c < transform_channel_count; c++) {
+		const float *values = key_channels[c];
+		float *out = batch->channels[c] + lane;
+		
+		if (c != transform_channel_angle) {
+			for (int i = start; i < end; i++) {
+				float from = values[keys[i]];
+				out[i] = from + (values[next_keys[i]] - from) * ts[i];
+			}
+			continue;
+		}
+		
+		// Selects rather than branches: the spin and the key order change
+		// from lane to lane and would mispredict.
+		for (int i = start; i < end; i++) {
+			float from = values[keys[i]];
+			float to = values[next_keys[i]];
+			
+			float turns = (float)((spins[i] > 0.0f) & (to < from)) - (float)((spins[i] < 0.0f) & (to > from));
+			float t = (spins[i] != 0.0f) ? ts[i] : 0.0f;
+			out[i] = from + ((to + turns * 360.0f) - from) * t;
+		}
+	}
+}
+
+#if RUNTIME_HAS_SSE2
+// Without a gather instruction the lanes are loaded one by one; the lerp is
+// vectorized.
+static void pose_batch_interpolate_lanes_sse2(struct pose_batch *batch, float *const *key_channels, int lane, int start, int end) {
+	__m128 zero = _mm_setzero_ps();
+	__m128 turn = _mm_set1_ps(360.0f);
+	const int *keys = batch->keys;
+	const int *next_keys = batch->next_keys;
+	
+	int vector_end = start + (end - start) / 4 * 4;
+	for (int c = 0; c < transform_channel_count; c++) {
+		const float *values = key_channels[c];
+		float *out = batch->channels[c] + lane;
+		
+		for (int i = start; i < vector_end; i += 4) {
+			__m128 from = _mm_setr_ps(values[keys[i]], values[keys[i + 1]], values[keys[i + 2]], values[keys[i + 3]]);
+			__m128 to = _mm_setr_ps(values[next_keys[i]], values[next_keys[i + 1]], values[next_keys[i + 2]], values[next_keys[i + 3]]);
+			__m128 t = _mm_loadu_ps(batch->t + i);
+			
+			if (c == transform_channel_angle) {
+				__m128 spin = _mm_loadu_ps(batch->spin + i);
+				__m128 ccw = _mm_and_ps(_mm_cmpgt_ps(spin, zero), _mm_cmplt_ps(to, from));
+				__m128 cw = _mm_and_ps(_mm_cmplt_ps(spin, zero), _mm_cmpgt_ps(to, from));
+				to = _mm_sub_ps(_mm_add_ps(to, _mm_and_ps(ccw, turn)), _mm_and_ps(cw, turn));
+				t = _mm_andnot_ps(_mm_cmpeq_ps(spin, zero), t);
+			}
+			
+			_mm_storeu_ps(out + i, _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), t)));
+		}
+	}
+	
+	pose_batch_interpolate_lanes_scalar(batch, key_channels, lane, vector_end, end);
+}
+#endif
+
+#if RUNTIME_HAS_AVX2
+__attribute__((target("avx2")))
+static void pose_batch_interpolate_lanes_avx2(struct pose_batch *batch, float *const *key_channels, int lane, int start, int end) {
+	__m256 zero = _mm256_setzero_ps();
+	__m256 turn = _mm256_set1_ps(360.0f);
+	
+	int vector_end = start + (end - start) / 8 * 8;
+	for (int c = 0; c < transform_channel_count; c++) {
+		const float *values = key_channels[c];
+		float *out = batch->channels[c] + lane;
+		
+		for (int i = start; i < vector_end; i += 8) {
+			__m256 from = _mm256_i32gather_ps(values, _mm256_loadu_si256((const __m256i *)(batch->keys + i)), 4);
+			__m256 to = _mm256_i32gather_ps(values, _mm256_loadu_si256((const __m256i *)(batch->next_keys + i)), 4);
+			__m256 t = _mm256_loadu_ps(batch->t + i);
+			
+			if (c == transform_channel_angle) {
+				__m256 spin = _mm256_loadu_ps(batch->spin + i);
+				__m256 ccw = _mm256_and_ps(_mm256_cmp_ps(spin, zero, _CMP_GT_OQ), _mm256_cmp_ps(to, from, _CMP_LT_OQ));
+				__m256 cw = _mm256_and_ps(_mm256_cmp_ps(spin, zero, _CMP_LT_OQ), _mm256_cmp_ps(to, from, _CMP_GT_OQ));
+				to = _mm256_sub_ps(_mm256_add_ps(to, _mm256_and_ps(ccw, turn)), _mm256_and_ps(cw, turn));
+				t = _mm256_andnot_ps(_mm256_cmp_ps(spin, zero, _CMP_EQ_OQ), t);
+			}
+			
+			_mm256_storeu_ps(out + i, _mm256_add_ps(from, _mm256_mul_ps(_mm256_sub_ps(to, from), t)));
+		}
+	}
+	
+	pose_batch_interpolate_lanes_scalar(batch, key_channels, lane, vector_end, end);
+}
+#endif
+
+static pose_batch_kernel pose_batch_kernel_select(const char **name) {
+#if RUNTIME_HAS_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		*name = "avx2";
+		return pose_batch_interpolate_lanes_avx2;
+	}
+#endif
+#if RUNTIME_HAS_SSE2
+	*name = "sse2";
+	return pose_batch_interpolate_lanes_sse2;
+#else
+	*name = "scalar";
+	return pose_batch_interpolate_lanes_scalar;
+#endif
+}
+
+// The kernel pose_batch_interpolate runs on this processor.
+const char *pose_batch_kernel_name(void) {
+	const char *name;
+	pose_batch_kernel_select(&name);
+	return name;
+}
+
+// Interpolates `count` lanes of a row starting at `lane`, from the keys,
+// next_keys, t and spin resolved for them. `key_channels` are the baked
+// animation's channel arrays, indexed by key.
+void pose_batch_interpolate(struct pose_batch *batch, float *const *key_channels, int lane, int count) {
+	assert(batch != NULL);
+	assert(key_channels != NULL);
+	assert((count >= 0) && (count <= POSE_BATCH_BLOCK));
+	
+	const char *name;
+	pose_batch_kernel kernel = pose_batch_kernel_select(&name);
+	kernel(batch, key_channels, lane, 0, count);
+}
+
+void pose_batch_interpolate_scalar(struct pose_batch *batch, float *const *key_channels, int lane, int count) {
+	assert(batch != NULL);
+	assert(key_channels != NULL);
+	assert((count >= 0) && (count <= POSE_BATCH_BLOCK));
+	
+	pose_batch_interpolate_lanes_scalar(batch, key_channels, lane, 0, count);
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "arena.h"
+#include "scml.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// 							Runtime
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Transform
+////////////////////////////////////////////////////////////////////////////////
+struct transform {
+	float x;
+	float y;
+	float angle; // degrees, counter-clockwise
+	float scale_x;
+	float scale_y;
+	float a;
+};
+
+// The fields of a transform, for layouts that keep one array per field.
+enum transform_channels {
+	transform_channel_x,
+	transform_channel_y,
+	transform_channel_angle,
+	transform_channel_scale_x,
+	transform_channel_scale_y,
+	transform_channel_a,
+	transform_channel_count
+};
+
+struct transform transform_create(float x, float y, float angle, float scale_x, float scale_y, float a);
+struct transform transform_lerp(struct transform from, struct transform to, float t, int spin);
+struct transform transform_compose(struct transform parent, struct transform local);
+
+////////////////////////////////////////////////////////////////////////////////
+// Pose
+////////////////////////////////////////////////////////////////////////////////
+// Bones and objects of one sampled frame, in mainline order. Bones come
+// parents first (see mainline_key_order_bones); parents index into `bones`,
+// -1 for the root. `world` is filled in by pose_compute_world.
+struct pose_bone {
+	struct transform local;
+	struct transform world;
+	int parent;
+	int timeline;
+};
+
+struct pose_object {
+	struct transform local;
+	struct transform world;
+	int parent;
+	int timeline;
+	int folder;
+	int file;
+	int z_index;
+};
+
+struct pose {
+	int bone_count;
+	int bone_capacity;
+	struct pose_bone *bones;
+	
+	int object_count;
+	int object_capacity;
+	struct pose_object *objects;
+	
+	struct arena *arena;
+};
+
+struct pose pose_create(int bone_capacity, int object_capacity, struct arena *arena);
+struct pose pose_create_for_entity(struct entity *entity, struct arena *arena);
+void pose_destroy(struct pose *pose);
+void pose_compute_world(struct pose *pose);
+
+////////////////////////////////////////////////////////////////////////////////
+// Cursor
+////////////////////////////////////////////////////////////////////////////////
+// The mainline key one playback instance found last. Playing forward then
+// finds the next key in a step or two instead of a search; wrapping around and
+// seeking fall back to the binary search.
+#define ANIMATION_CURSOR_STEPS 4
+
+struct animation_cursor {
+	int mainline_key; // -1 until the first lookup
+};
+
+struct animation_cursor animation_cursor_create(void);
+void animation_cursor_reset(struct animation_cursor *cursor);
+int animation_cursor_find_mainline_key(struct animation_cursor *cursor, struct animation *animation, float time);
+
+////////////////////////////////////////////////////////////////////////////////
+// Sampling
+////////////////////////////////////////////////////////////////////////////////
+// Sampling writes into a pose created beforehand and never allocates. Times
+// are in milliseconds; they wrap around the length of looping animations and
+// are clamped to it otherwise.
+int animation_find_mainline_key(struct animation *animation, float time);
+void animation_sample_pose(struct animation *animation, float time, struct pose *pose);
+void animation_sample_pose_with_cursor(struct animation *animation, float time, struct animation_cursor *cursor, struct pose *pose);
+void entity_sample_pose(struct entity *entity, int animation_index, float time, struct pose *pose);
+
+////////////////////////////////////////////////////////////////////////////////
+// Batch
+////////////////////////////////////////////////////////////////////////////////
+// Bone transforms of many instances of one baked animation, one float lane per
+// instance. Channel c of bone b for instance i is
+// channels[c][b * stride + i]; stride is the instance capacity rounded up to
+// a whole vector so rows stay aligned. Sampling (baked_animation_sample_batch)
+// resolves, for up to POSE_BATCH_BLOCK lanes of a row, the key each lane
+// blends from, the key it blends into and how far, then interpolates the row
+// straight from the baked channel arrays. The kernel is picked at run time:
+// AVX2 gathers when the processor has them, SSE2 otherwise, and plain C on
+// other targets or with RUNTIME_NO_SIMD defined.
+#define POSE_BATCH_LANES 8
+#define POSE_BATCH_BLOCK 256
+
+struct pose_batch {
+	int instance_count;
+	int instance_capacity;
+	int bone_count; // of the largest mainline key sampled
+	int bone_capacity;
+	int stride;
+	
+	float *channels[transform_channel_count];
+	int *keys;      // [POSE_BATCH_BLOCK], the key each lane of the row blends from
+	int *next_keys; // [POSE_BATCH_BLOCK], and into
+	float *t;       // [POSE_BATCH_BLOCK]
+	float *spin;    // [POSE_BATCH_BLOCK]
+	int *parents; // [b * stride + i], like pose_bone.parent
+	float *times; // [i], wrapped
+	int *mainline_keys; // [i]
+	
+	struct arena *arena;
+};
+
+struct pose_batch pose_batch_create(int instance_capacity, int bone_capacity, struct arena *arena);
+void pose_batch_destroy(struct pose_batch *batch);
+struct transform pose_batch_bone(struct pose_batch *batch, int instance, int bone);
+const char *pose_batch_kernel_name(void);
+void pose_batch_interpolate(struct pose_batch *batch, float *const *key_channels, int lane, int count);
+void pose_batch_interpolate_scalar(struct pose_batch *batch, float *const *key_channels, int lane, int count);
\ No newline at end of file
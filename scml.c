@@ -30,30 +30,46 @@ void file_destroy(struct file *file) {
 ////////////////////////////////////////////////////////////////////////////////
 // File list
 ////////////////////////////////////////////////////////////////////////////////
-struct file_list file_list_create() {
+struct file_list file_list_create(struct arena *arena) {
 	struct file_list file_list;
 	file_list.length = 0;
+	file_list.capacity = 0;
 	file_list.items = NULL;
+	file_list.arena = arena;
 	return file_list;
 }
 
 void file_list_destroy(struct file_list *file_list) {
 	assert(file_list != NULL);
 	
+	if (file_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < file_list->length; i++) {
 		struct file file = file_list->items[i];
 		file_destroy(&file);
 	}
 	
-	free(file_list->items);
+	memory_free(file_list->arena, file_list->items);
 }
 
 void file_list_append(struct file_list *file_list, struct file file) {
 	assert(file_list != NULL);
 	
+	file_list->items = array_grow(file_list->items, file_list->length, &file_list->capacity, sizeof(struct file), file_list->arena);
+	file_list->items[file_list->length] = file;
 	file_list->length++;
-	file_list->items = realloc(file_list->items, sizeof(struct file) * file_list->length);
-	file_list->items[file_list->length - 1] = file;
+}
+
+void file_list_reserve(struct file_list *file_list, int capacity) {
+	assert(file_list != NULL);
+	
+	file_list->items = array_reserve(file_list->items, file_list->length, &file_list->capacity, capacity, sizeof(struct file), file_list->arena);
+}
+
+void file_list_shrink_to_fit(struct file_list *file_list) {
+	assert(file_list != NULL);
+	
+	file_list->items = array_shrink_to_fit(file_list->items, file_list->length, &file_list->capacity, sizeof(struct file), file_list->arena);
 }
 
 struct file* file_list_top(struct file_list *file_list) {
@@ -66,10 +82,10 @@ struct file* file_list_top(struct file_list *file_list) {
 ////////////////////////////////////////////////////////////////////////////////
 // Folder
 ////////////////////////////////////////////////////////////////////////////////
-struct folder folder_create(int id) {
+struct folder folder_create(int id, struct arena *arena) {
 	struct folder folder;
 	folder.id = id;
-	folder.file_list = file_list_create();
+	folder.file_list = file_list_create(arena);
 	return folder;
 }
 
@@ -83,30 +99,46 @@ void folder_destroy(struct folder *folder) {
 // Folder list
 ////////////////////////////////////////////////////////////////////////////////
 
-struct folder_list folder_list_create() {
+struct folder_list folder_list_create(struct arena *arena) {
 	struct folder_list folder_list;
 	folder_list.length = 0;
+	folder_list.capacity = 0;
 	folder_list.items = NULL;
+	folder_list.arena = arena;
 	return folder_list;
 }
 
 void folder_list_destroy(struct folder_list *folder_list) {
 	assert(folder_list != NULL);
 	
+	if (folder_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < folder_list->length; i++) {
 		struct folder folder = folder_list->items[i];
 		folder_destroy(&folder);
 	}
 	
-	free(folder_list->items);
+	memory_free(folder_list->arena, folder_list->items);
 }
 
 void folder_list_append(struct folder_list *folder_list, struct folder folder) {
 	assert(folder_list != NULL);
 	
+	folder_list->items = array_grow(folder_list->items, folder_list->length, &folder_list->capacity, sizeof(struct folder), folder_list->arena);
+	folder_list->items[folder_list->length] = folder;
 	folder_list->length++;
-	folder_list->items = realloc(folder_list->items, sizeof(struct file) * folder_list->length);
-	folder_list->items[folder_list->length - 1] = folder;
+}
+
+void folder_list_reserve(struct folder_list *folder_list, int capacity) {
+	assert(folder_list != NULL);
+	
+	folder_list->items = array_reserve(folder_list->items, folder_list->length, &folder_list->capacity, capacity, sizeof(struct folder), folder_list->arena);
+}
+
+void folder_list_shrink_to_fit(struct folder_list *folder_list) {
+	assert(folder_list != NULL);
+	
+	folder_list->items = array_shrink_to_fit(folder_list->items, folder_list->length, &folder_list->capacity, sizeof(struct folder), folder_list->arena);
 }
 
 struct folder* folder_list_top(struct folder_list *folder_list) {
@@ -119,9 +151,10 @@ struct folder* folder_list_top(struct folder_list *folder_list) {
 ////////////////////////////////////////////////////////////////////////////////
 // Object ref
 ////////////////////////////////////////////////////////////////////////////////
-struct object_ref object_ref_create(int id, int timeline, int key, int z_index) {
+struct object_ref object_ref_create(int id, int parent, int timeline, int key, int z_index) {
 	struct object_ref object_ref;
 	object_ref.id = id;
+	object_ref.parent = parent;
 	object_ref.timeline = timeline;
 	object_ref.key = key;
 	object_ref.z_index = z_index;
@@ -135,25 +168,41 @@ void object_ref_destroy(struct object_ref *object_ref) {
 ////////////////////////////////////////////////////////////////////////////////
 // Object ref list
 ////////////////////////////////////////////////////////////////////////////////
-struct object_ref_list object_ref_list_create() {
+struct object_ref_list object_ref_list_create(struct arena *arena) {
 	struct object_ref_list object_ref_list;
 	object_ref_list.length = 0;
+	object_ref_list.capacity = 0;
 	object_ref_list.items = NULL;
+	object_ref_list.arena = arena;
 	return object_ref_list;
 }
 
 void object_ref_list_destroy(struct object_ref_list *object_ref_list) {
 	assert(object_ref_list != NULL);
 	
-	free(object_ref_list->items);
+	if (object_ref_list->arena != NULL) return; // released with the arena
+	
+	memory_free(object_ref_list->arena, object_ref_list->items);
 }
 
 void object_ref_list_append(struct object_ref_list *object_ref_list, struct object_ref object_ref) {
 	assert(object_ref_list != NULL);
 	
+	object_ref_list->items = array_grow(object_ref_list->items, object_ref_list->length, &object_ref_list->capacity, sizeof(struct object_ref), object_ref_list->arena);
+	object_ref_list->items[object_ref_list->length] = object_ref;
 	object_ref_list->length++;
-	object_ref_list->items = realloc(object_ref_list->items, sizeof(struct object_ref) * object_ref_list->length);
-	object_ref_list->items[object_ref_list->length - 1] = object_ref;
+}
+
+void object_ref_list_reserve(struct object_ref_list *object_ref_list, int capacity) {
+	assert(object_ref_list != NULL);
+	
+	object_ref_list->items = array_reserve(object_ref_list->items, object_ref_list->length, &object_ref_list->capacity, capacity, sizeof(struct object_ref), object_ref_list->arena);
+}
+
+void object_ref_list_shrink_to_fit(struct object_ref_list *object_ref_list) {
+	assert(object_ref_list != NULL);
+	
+	object_ref_list->items = array_shrink_to_fit(object_ref_list->items, object_ref_list->length, &object_ref_list->capacity, sizeof(struct object_ref), object_ref_list->arena);
 }
 
 struct object_ref* object_ref_list_top(struct object_ref_list *object_ref_list) {
@@ -182,25 +231,41 @@ void bone_ref_destroy(struct bone_ref *bone_ref) {
 ////////////////////////////////////////////////////////////////////////////////
 // Bone ref list
 ////////////////////////////////////////////////////////////////////////////////
-struct bone_ref_list bone_ref_list_create() {
+struct bone_ref_list bone_ref_list_create(struct arena *arena) {
 	struct bone_ref_list bone_ref_list;
 	bone_ref_list.length = 0;
+	bone_ref_list.capacity = 0;
 	bone_ref_list.items = NULL;
+	bone_ref_list.arena = arena;
 	return bone_ref_list;
 }
 
 void bone_ref_list_destroy(struct bone_ref_list *bone_ref_list) {
 	assert(bone_ref_list != NULL);
 	
-	free(bone_ref_list->items);
+	if (bone_ref_list->arena != NULL) return; // released with the arena
+	
+	memory_free(bone_ref_list->arena, bone_ref_list->items);
 }
 
 void bone_ref_list_append(struct bone_ref_list *bone_ref_list, struct bone_ref bone_ref) {
 	assert(bone_ref_list != NULL);
 	
+	bone_ref_list->items = array_grow(bone_ref_list->items, bone_ref_list->length, &bone_ref_list->capacity, sizeof(struct bone_ref), bone_ref_list->arena);
+	bone_ref_list->items[bone_ref_list->length] = bone_ref;
 	bone_ref_list->length++;
-	bone_ref_list->items = realloc(bone_ref_list->items, sizeof(struct bone_ref) * bone_ref_list->length);
-	bone_ref_list->items[bone_ref_list->length - 1] = bone_ref;
+}
+
+void bone_ref_list_reserve(struct bone_ref_list *bone_ref_list, int capacity) {
+	assert(bone_ref_list != NULL);
+	
+	bone_ref_list->items = array_reserve(bone_ref_list->items, bone_ref_list->length, &bone_ref_list->capacity, capacity, sizeof(struct bone_ref), bone_ref_list->arena);
+}
+
+void bone_ref_list_shrink_to_fit(struct bone_ref_list *bone_ref_list) {
+	assert(bone_ref_list != NULL);
+	
+	bone_ref_list->items = array_shrink_to_fit(bone_ref_list->items, bone_ref_list->length, &bone_ref_list->capacity, sizeof(struct bone_ref), bone_ref_list->arena);
 }
 
 struct bone_ref* bone_ref_list_top(struct bone_ref_list *bone_ref_list) {
@@ -210,51 +275,235 @@ struct bone_ref* bone_ref_list_top(struct bone_ref_list *bone_ref_list) {
 	return &(bone_ref_list->items[bone_ref_list->length - 1]);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Bone order scratch
+////////////////////////////////////////////////////////////////////////////////
+struct bone_order_scratch bone_order_scratch_create(void) {
+	struct bone_order_scratch scratch;
+	scratch.capacity = 0;
+	scratch.parents = NULL;
+	scratch.positions = NULL;
+	scratch.ids = NULL;
+	return scratch;
+}
+
+void bone_order_scratch_destroy(struct bone_order_scratch *scratch) {
+	assert(scratch != NULL);
+	
+	memory_free(NULL, scratch->parents);
+	memory_free(NULL, scratch->positions);
+	memory_free(NULL, scratch->ids);
+}
+
+static void bone_order_scratch_reserve(struct bone_order_scratch *scratch, int capacity) {
+	if (capacity <= scratch->capacity) return;
+	
+	size_t old_size = sizeof(int) * scratch->capacity;
+	size_t new_size = sizeof(int) * capacity;
+	scratch->parents = memory_realloc(NULL, scratch->parents, old_size, new_size);
+	scratch->positions = memory_realloc(NULL, scratch->positions, old_size, new_size);
+	scratch->ids = memory_realloc(NULL, scratch->ids, 2 * old_size, 2 * new_size);
+	scratch->capacity = capacity;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Mainline key
 ////////////////////////////////////////////////////////////////////////////////
-struct mainline_key mainline_key_create(int id) {
+struct mainline_key mainline_key_create(int id, int time, struct arena *arena) {
 	struct mainline_key mainline_key;
 	mainline_key.id = id;
-	mainline_key.object_ref_list = object_ref_list_create();
-	mainline_key.bone_ref_list = bone_ref_list_create();
+	mainline_key.time = time;
+	mainline_key.object_ref_list = object_ref_list_create(arena);
+	mainline_key.bone_ref_list = bone_ref_list_create(arena);
+	mainline_key.bone_order = NULL;
+	mainline_key.bone_parents = NULL;
+	mainline_key.object_parents = NULL;
 	return mainline_key;
 }
 
+static void mainline_key_clear_bone_order(struct mainline_key *mainline_key) {
+	struct arena *arena = mainline_key->bone_ref_list.arena;
+	
+	memory_free(arena, mainline_key->bone_order);
+	memory_free(arena, mainline_key->bone_parents);
+	memory_free(arena, mainline_key->object_parents);
+	mainline_key->bone_order = NULL;
+	mainline_key->bone_parents = NULL;
+	mainline_key->object_parents = NULL;
+}
+
 void mainline_key_destroy(struct mainline_key *mainline_key) {
 	assert(mainline_key != NULL);
 	
+	mainline_key_clear_bone_order(mainline_key);
 	object_ref_list_destroy(&mainline_key->object_ref_list);
 	bone_ref_list_destroy(&mainline_key->bone_ref_list);
 }
 
+static bool mainline_key_bone_refs_are_ordered(struct mainline_key *mainline_key) {
+	struct bone_ref_list *bone_refs = &mainline_key->bone_ref_list;
+	
+	for (int i = 0; i < bone_refs->length; i++) {
+		struct bone_ref bone_ref = bone_refs->items[i];
+		if ((bone_ref.id != i) || (bone_ref.parent >= i)) return false;
+	}
+	
+	struct object_ref_list *object_refs = &mainline_key->object_ref_list;
+	for (int i = 0; i < object_refs->length; i++) {
+		if (object_refs->items[i].parent >= bone_refs->length) return false;
+	}
+	return true;
+}
+
+static int bone_order_compare_ids(const void *a, const void *b) {
+	const int *left = a;
+	const int *right = b;
+	
+	if (left[0] != right[0]) return (left[0] < right[0]) ? -1 : 1;
+	return (left[1] < right[1]) ? -1 : (left[1] > right[1]);
+}
+
+// The index of the first ref with `id` in the sorted (id, index) pairs, -1 for
+// the root.
+static int bone_order_index_of(int *ids, int count, int id) {
+	if (id < 0) return -1;
+	
+	int low = 0;
+	int high = count;
+	while (low < high) {
+		int middle = (low + high) / 2;
+		if (ids[2 * middle] < id) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	assert((low < count) && (ids[2 * low] == id)); // a parent outside the key
+	return ids[2 * low + 1];
+}
+
+// Works out the parents first order of the bones, stable by depth so siblings
+// keep their order, and the parents of bones and objects as positions in it.
+void mainline_key_order_bones(struct mainline_key *mainline_key, struct bone_order_scratch *scratch) {
+	assert(mainline_key != NULL);
+	assert(scratch != NULL);
+	
+	mainline_key_clear_bone_order(mainline_key);
+	if (mainline_key_bone_refs_are_ordered(mainline_key)) return;
+	
+	struct bone_ref_list *bone_refs = &mainline_key->bone_ref_list;
+	struct object_ref_list *object_refs = &mainline_key->object_ref_list;
+	int count = bone_refs->length;
+	
+	bone_order_scratch_reserve(scratch, count);
+	int *parents = scratch->parents;
+	int *positions = scratch->positions;
+	int *ids = scratch->ids;
+	
+	for (int i = 0; i < count; i++) {
+		ids[2 * i] = bone_refs->items[i].id;
+		ids[2 * i + 1] = i;
+	}
+	qsort(ids, count, 2 * sizeof(int), bone_order_compare_ids);
+	
+	int max_depth = 0;
+	for (int i = 0; i < count; i++) {
+		parents[i] = bone_order_index_of(ids, count, bone_refs->items[i].parent);
+	}
+	for (int i = 0; i < count; i++) {
+		int depth = 0;
+		for (int parent = parents[i]; (parent >= 0) && (depth <= count); parent = parents[parent]) {
+			depth++;
+		}
+		assert(depth <= count); // a cycle
+		positions[i] = depth;
+		if (depth > max_depth) max_depth = depth;
+	}
+	
+	struct arena *arena = bone_refs->arena;
+	mainline_key->bone_order = memory_alloc(arena, sizeof(int) * count);
+	mainline_key->bone_parents = memory_alloc(arena, sizeof(int) * count);
+	mainline_key->object_parents = memory_alloc(arena, sizeof(int) * object_refs->length);
+	
+	int position = 0;
+	for (int depth = 0; depth <= max_depth; depth++) {
+		for (int i = 0; i < count; i++) {
+			if (positions[i] != depth) continue;
+			mainline_key->bone_order[position] = i;
+			positions[i] = position++;
+		}
+	}
+	
+	for (int i = 0; i < count; i++) {
+		int parent = parents[mainline_key->bone_order[i]];
+		mainline_key->bone_parents[i] = (parent >= 0) ? positions[parent] : -1;
+	}
+	
+	for (int i = 0; i < object_refs->length; i++) {
+		int parent = bone_order_index_of(ids, count, object_refs->items[i].parent);
+		mainline_key->object_parents[i] = (parent >= 0) ? positions[parent] : -1;
+	}
+}
+
+// The index into the bone refs of the bone at `position` in parents first
+// order.
+int mainline_key_bone_ref_at(struct mainline_key *mainline_key, int position) {
+	return (mainline_key->bone_order != NULL) ? mainline_key->bone_order[position] : position;
+}
+
+// The position of the parent of the bone at `position`, -1 for a root.
+int mainline_key_bone_parent(struct mainline_key *mainline_key, int position) {
+	return (mainline_key->bone_parents != NULL) ? mainline_key->bone_parents[position] : mainline_key->bone_ref_list.items[position].parent;
+}
+
+// The position of the bone an object ref hangs from, -1 for none.
+int mainline_key_object_parent(struct mainline_key *mainline_key, int object_ref) {
+	return (mainline_key->object_parents != NULL) ? mainline_key->object_parents[object_ref] : mainline_key->object_ref_list.items[object_ref].parent;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Mainline key list
 ////////////////////////////////////////////////////////////////////////////////
-struct mainline_key_list mainline_key_list_create() {
+struct mainline_key_list mainline_key_list_create(struct arena *arena) {
 	struct mainline_key_list mainline_key_list;
 	mainline_key_list.length = 0;
+	mainline_key_list.capacity = 0;
 	mainline_key_list.items = NULL;
+	mainline_key_list.arena = arena;
 	return mainline_key_list;
 }
 
 void mainline_key_list_destroy(struct mainline_key_list *mainline_key_list) {
 	assert(mainline_key_list != NULL);
 	
+	if (mainline_key_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < mainline_key_list->length; i++) {
 		struct mainline_key mainline_key = mainline_key_list->items[i];
 		mainline_key_destroy(&mainline_key);
 	}
 	
-	free(mainline_key_list->items);
+	memory_free(mainline_key_list->arena, mainline_key_list->items);
 }
 
 void mainline_key_list_append(struct mainline_key_list *mainline_key_list, struct mainline_key mainline_key) {
 	assert(mainline_key_list != NULL);
 	
+	mainline_key_list->items = array_grow(mainline_key_list->items, mainline_key_list->length, &mainline_key_list->capacity, sizeof(struct mainline_key), mainline_key_list->arena);
+	mainline_key_list->items[mainline_key_list->length] = mainline_key;
 	mainline_key_list->length++;
-	mainline_key_list->items = realloc(mainline_key_list->items, sizeof(struct mainline_key) * mainline_key_list->length);
-	mainline_key_list->items[mainline_key_list->length - 1] = mainline_key;
+}
+
+void mainline_key_list_reserve(struct mainline_key_list *mainline_key_list, int capacity) {
+	assert(mainline_key_list != NULL);
+	
+	mainline_key_list->items = array_reserve(mainline_key_list->items, mainline_key_list->length, &mainline_key_list->capacity, capacity, sizeof(struct mainline_key), mainline_key_list->arena);
+}
+
+void mainline_key_list_shrink_to_fit(struct mainline_key_list *mainline_key_list) {
+	assert(mainline_key_list != NULL);
+	
+	mainline_key_list->items = array_shrink_to_fit(mainline_key_list->items, mainline_key_list->length, &mainline_key_list->capacity, sizeof(struct mainline_key), mainline_key_list->arena);
 }
 
 struct mainline_key* mainline_key_list_top(struct mainline_key_list *mainline_key_list) {
@@ -267,9 +516,9 @@ struct mainline_key* mainline_key_list_top(struct mainline_key_list *mainline_ke
 ////////////////////////////////////////////////////////////////////////////////
 // Mainline
 ////////////////////////////////////////////////////////////////////////////////
-struct mainline mainline_create() {
+struct mainline mainline_create(struct arena *arena) {
 	struct mainline mainline;
-	mainline.mainline_key_list = mainline_key_list_create();
+	mainline.mainline_key_list = mainline_key_list_create(arena);
 	return mainline;
 }
 
@@ -281,13 +530,16 @@ void mainline_destroy(struct mainline *mainline) {
 ////////////////////////////////////////////////////////////////////////////////
 // Object
 ////////////////////////////////////////////////////////////////////////////////
-struct object object_create(int folder, int file, float angle, float scale_x, float scale_y) {
+struct object object_create(int folder, int file, float x, float y, float angle, float scale_x, float scale_y, float a) {
 	struct object object;
 	object.folder = folder;
 	object.file = file;
+	object.x = x;
+	object.y = y;
 	object.angle = angle;
 	object.scale_x = scale_x;
 	object.scale_y = scale_y;
+	object.a = a;
 	return object;
 }
 
@@ -298,30 +550,46 @@ void object_destroy(struct object *object) {
 ////////////////////////////////////////////////////////////////////////////////
 // Object list
 ////////////////////////////////////////////////////////////////////////////////
-struct object_list object_list_create() {
+struct object_list object_list_create(struct arena *arena) {
 	struct object_list object_list;
 	object_list.length = 0;
+	object_list.capacity = 0;
 	object_list.items = NULL;
+	object_list.arena = arena;
 	return object_list;
 }
 
 void object_list_destroy(struct object_list *object_list) {
 	assert(object_list != NULL);
 	
+	if (object_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < object_list->length; i++) {
 		struct object object = object_list->items[i];
 		object_destroy(&object);
 	}
 	
-	free(object_list->items);
+	memory_free(object_list->arena, object_list->items);
 }
 
 void object_list_append(struct object_list *object_list, struct object object) {
 	assert(object_list != NULL);
 	
+	object_list->items = array_grow(object_list->items, object_list->length, &object_list->capacity, sizeof(struct object), object_list->arena);
+	object_list->items[object_list->length] = object;
 	object_list->length++;
-	object_list->items = realloc(object_list->items, sizeof(struct object) * object_list->length);
-	object_list->items[object_list->length - 1] = object;
+}
+
+void object_list_reserve(struct object_list *object_list, int capacity) {
+	assert(object_list != NULL);
+	
+	object_list->items = array_reserve(object_list->items, object_list->length, &object_list->capacity, capacity, sizeof(struct object), object_list->arena);
+}
+
+void object_list_shrink_to_fit(struct object_list *object_list) {
+	assert(object_list != NULL);
+	
+	object_list->items = array_shrink_to_fit(object_list->items, object_list->length, &object_list->capacity, sizeof(struct object), object_list->arena);
 }
 
 struct object* object_list_top(struct object_list *object_list) {
@@ -341,6 +609,7 @@ struct bone bone_create(float x, float y, float angle, float scale_x, float scal
 	bone.angle = angle;
 	bone.scale_x = scale_x;
 	bone.scale_y = scale_y;
+	bone.a = a;
 	return bone;
 }
 
@@ -351,30 +620,46 @@ void bone_destroy(struct bone *bone) {
 ////////////////////////////////////////////////////////////////////////////////
 // Bone list
 ////////////////////////////////////////////////////////////////////////////////
-struct bone_list bone_list_create() {
+struct bone_list bone_list_create(struct arena *arena) {
 	struct bone_list bone_list;
 	bone_list.length = 0;
+	bone_list.capacity = 0;
 	bone_list.items = NULL;
+	bone_list.arena = arena;
 	return bone_list;
 }
 
 void bone_list_destroy(struct bone_list *bone_list) {
 	assert(bone_list != NULL);
 	
+	if (bone_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < bone_list->length; i++) {
 		struct bone bone = bone_list->items[i];
 		bone_destroy(&bone);
 	}
 	
-	free(bone_list->items);
+	memory_free(bone_list->arena, bone_list->items);
 }
 
 void bone_list_append(struct bone_list *bone_list, struct bone bone) {
 	assert(bone_list != NULL);
 	
+	bone_list->items = array_grow(bone_list->items, bone_list->length, &bone_list->capacity, sizeof(struct bone), bone_list->arena);
+	bone_list->items[bone_list->length] = bone;
 	bone_list->length++;
-	bone_list->items = realloc(bone_list->items, sizeof(struct bone) * bone_list->length);
-	bone_list->items[bone_list->length - 1] = bone;
+}
+
+void bone_list_reserve(struct bone_list *bone_list, int capacity) {
+	assert(bone_list != NULL);
+	
+	bone_list->items = array_reserve(bone_list->items, bone_list->length, &bone_list->capacity, capacity, sizeof(struct bone), bone_list->arena);
+}
+
+void bone_list_shrink_to_fit(struct bone_list *bone_list) {
+	assert(bone_list != NULL);
+	
+	bone_list->items = array_shrink_to_fit(bone_list->items, bone_list->length, &bone_list->capacity, sizeof(struct bone), bone_list->arena);
 }
 
 struct bone* bone_list_top(struct bone_list *bone_list) {
@@ -387,13 +672,13 @@ struct bone* bone_list_top(struct bone_list *bone_list) {
 ////////////////////////////////////////////////////////////////////////////////
 // Timeline key
 ////////////////////////////////////////////////////////////////////////////////
-struct timeline_key timeline_key_create(int id, int time, int spin) {
+struct timeline_key timeline_key_create(int id, int time, int spin, struct arena *arena) {
 	struct timeline_key timeline_key;
 	timeline_key.id = id;
 	timeline_key.time = time;
 	timeline_key.spin = spin;
-	timeline_key.object_list = object_list_create();
-	timeline_key.bone_list = bone_list_create();
+	timeline_key.object_list = object_list_create(arena);
+	timeline_key.bone_list = bone_list_create(arena);
 	return timeline_key;
 }
 
@@ -407,30 +692,46 @@ void timeline_key_destroy(struct timeline_key *timeline_key) {
 ////////////////////////////////////////////////////////////////////////////////
 // Timeline key list
 ////////////////////////////////////////////////////////////////////////////////
-struct timeline_key_list timeline_key_list_create() {
+struct timeline_key_list timeline_key_list_create(struct arena *arena) {
 	struct timeline_key_list timeline_key_list;
 	timeline_key_list.length = 0;
+	timeline_key_list.capacity = 0;
 	timeline_key_list.items = NULL;
+	timeline_key_list.arena = arena;
 	return timeline_key_list;
 }
 
 void timeline_key_list_destroy(struct timeline_key_list *timeline_key_list) {
 	assert(timeline_key_list != NULL);
 	
+	if (timeline_key_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < timeline_key_list->length; i++) {
 		struct timeline_key timeline_key = timeline_key_list->items[i];
 		timeline_key_destroy(&timeline_key);
 	}
 	
-	free(timeline_key_list->items);
+	memory_free(timeline_key_list->arena, timeline_key_list->items);
 }
 
 void timeline_key_list_append(struct timeline_key_list *timeline_key_list, struct timeline_key timeline_key) {
 	assert(timeline_key_list != NULL);
 	
+	timeline_key_list->items = array_grow(timeline_key_list->items, timeline_key_list->length, &timeline_key_list->capacity, sizeof(struct timeline_key), timeline_key_list->arena);
+	timeline_key_list->items[timeline_key_list->length] = timeline_key;
 	timeline_key_list->length++;
-	timeline_key_list->items = realloc(timeline_key_list->items, sizeof(struct timeline_key) * timeline_key_list->length);
-	timeline_key_list->items[timeline_key_list->length - 1] = timeline_key;
+}
+
+void timeline_key_list_reserve(struct timeline_key_list *timeline_key_list, int capacity) {
+	assert(timeline_key_list != NULL);
+	
+	timeline_key_list->items = array_reserve(timeline_key_list->items, timeline_key_list->length, &timeline_key_list->capacity, capacity, sizeof(struct timeline_key), timeline_key_list->arena);
+}
+
+void timeline_key_list_shrink_to_fit(struct timeline_key_list *timeline_key_list) {
+	assert(timeline_key_list != NULL);
+	
+	timeline_key_list->items = array_shrink_to_fit(timeline_key_list->items, timeline_key_list->length, &timeline_key_list->capacity, sizeof(struct timeline_key), timeline_key_list->arena);
 }
 
 struct timeline_key* timeline_key_list_top(struct timeline_key_list *timeline_key_list) {
@@ -443,11 +744,11 @@ struct timeline_key* timeline_key_list_top(struct timeline_key_list *timeline_ke
 ////////////////////////////////////////////////////////////////////////////////
 // Timeline
 ////////////////////////////////////////////////////////////////////////////////
-struct timeline timeline_create(int id, struct string name) {
+struct timeline timeline_create(int id, struct string name, struct arena *arena) {
 	struct timeline timeline;
 	timeline.id = id;
 	timeline.name = name;
-	timeline.timeline_key_list = timeline_key_list_create();
+	timeline.timeline_key_list = timeline_key_list_create(arena);
 	return timeline;
 }
 
@@ -455,17 +756,73 @@ void timeline_destroy(struct timeline *timeline) {
 	assert(timeline != NULL);
 	
 	string_destroy(&timeline->name);
+	timeline_key_list_destroy(&timeline->timeline_key_list);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Timeline list
+////////////////////////////////////////////////////////////////////////////////
+struct timeline_list timeline_list_create(struct arena *arena) {
+	struct timeline_list timeline_list;
+	timeline_list.length = 0;
+	timeline_list.capacity = 0;
+	timeline_list.items = NULL;
+	timeline_list.arena = arena;
+	return timeline_list;
+}
+
+void timeline_list_destroy(struct timeline_list *timeline_list) {
+	assert(timeline_list != NULL);
+	
+	if (timeline_list->arena != NULL) return; // released with the arena
+	
+	for (int i = 0; i < timeline_list->length; i++) {
+		struct timeline timeline = timeline_list->items[i];
+		timeline_destroy(&timeline);
+	}
+	
+	memory_free(timeline_list->arena, timeline_list->items);
+}
+
+void timeline_list_append(struct timeline_list *timeline_list, struct timeline timeline) {
+	assert(timeline_list != NULL);
+	
+	timeline_list->items = array_grow(timeline_list->items, timeline_list->length, &timeline_list->capacity, sizeof(struct timeline), timeline_list->arena);
+	timeline_list->items[timeline_list->length] = timeline;
+	timeline_list->length++;
+}
+
+void timeline_list_reserve(struct timeline_list *timeline_list, int capacity) {
+	assert(timeline_list != NULL);
+	
+	timeline_list->items = array_reserve(timeline_list->items, timeline_list->length, &timeline_list->capacity, capacity, sizeof(struct timeline), timeline_list->arena);
+}
+
+void timeline_list_shrink_to_fit(struct timeline_list *timeline_list) {
+	assert(timeline_list != NULL);
+	
+	timeline_list->items = array_shrink_to_fit(timeline_list->items, timeline_list->length, &timeline_list->capacity, sizeof(struct timeline), timeline_list->arena);
+}
+
+struct timeline* timeline_list_top(struct timeline_list *timeline_list) {
+	assert(timeline_list != NULL);
+	assert(timeline_list->length > 0);
+	
+	return &(timeline_list->items[timeline_list->length - 1]);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Animation
 ////////////////////////////////////////////////////////////////////////////////
-struct animation animation_create(int id, struct string name, int length, int interval) {
+struct animation animation_create(int id, struct string name, int length, int interval, bool looping, struct arena *arena) {
 	struct animation animation;
 	animation.id = id;
 	animation.name = name;
 	animation.length = length;
 	animation.interval = interval;
+	animation.looping = looping;
+	animation.mainline = mainline_create(arena);
+	animation.timeline_list = timeline_list_create(arena);
 	return animation;
 }
 
@@ -474,36 +831,52 @@ void animation_destroy(struct animation *animation) {
 	
 	string_destroy(&animation->name);
 	mainline_destroy(&animation->mainline);
-	timeline_destroy(&animation->timeline);
+	timeline_list_destroy(&animation->timeline_list);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Animation list
 ////////////////////////////////////////////////////////////////////////////////
-struct animation_list animation_list_create() {
+struct animation_list animation_list_create(struct arena *arena) {
 	struct animation_list animation_list;
 	animation_list.length = 0;
+	animation_list.capacity = 0;
 	animation_list.items = NULL;
+	animation_list.arena = arena;
 	return animation_list;
 }
 
 void animation_list_destroy(struct animation_list *animation_list) {
 	assert(animation_list != NULL);
 	
+	if (animation_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < animation_list->length; i++) {
 		struct animation animation = animation_list->items[i];
 		animation_destroy(&animation);
 	}
 	
-	free(animation_list->items);
+	memory_free(animation_list->arena, animation_list->items);
 }
 
 void animation_list_append(struct animation_list *animation_list, struct animation animation) {
 	assert(animation_list != NULL);
 	
+	animation_list->items = array_grow(animation_list->items, animation_list->length, &animation_list->capacity, sizeof(struct animation), animation_list->arena);
+	animation_list->items[animation_list->length] = animation;
 	animation_list->length++;
-	animation_list->items = realloc(animation_list->items, sizeof(struct animation) * animation_list->length);
-	animation_list->items[animation_list->length - 1] = animation;
+}
+
+void animation_list_reserve(struct animation_list *animation_list, int capacity) {
+	assert(animation_list != NULL);
+	
+	animation_list->items = array_reserve(animation_list->items, animation_list->length, &animation_list->capacity, capacity, sizeof(struct animation), animation_list->arena);
+}
+
+void animation_list_shrink_to_fit(struct animation_list *animation_list) {
+	assert(animation_list != NULL);
+	
+	animation_list->items = array_shrink_to_fit(animation_list->items, animation_list->length, &animation_list->capacity, sizeof(struct animation), animation_list->arena);
 }
 
 struct animation* animation_list_top(struct animation_list *animation_list) {
@@ -516,11 +889,11 @@ struct animation* animation_list_top(struct animation_list *animation_list) {
 ////////////////////////////////////////////////////////////////////////////////
 // Entity
 ////////////////////////////////////////////////////////////////////////////////
-struct entity entity_create(int id, struct string name) {
+struct entity entity_create(int id, struct string name, struct arena *arena) {
 	struct entity entity;
 	entity.id = id;
 	entity.name = name;
-	entity.animation_list = animation_list_create();
+	entity.animation_list = animation_list_create(arena);
 	return entity;
 }
 
@@ -534,30 +907,46 @@ void entity_destroy(struct entity *entity) {
 ////////////////////////////////////////////////////////////////////////////////
 // Entity list
 ////////////////////////////////////////////////////////////////////////////////
-struct entity_list entity_list_create() {
+struct entity_list entity_list_create(struct arena *arena) {
 	struct entity_list entity_list;
 	entity_list.length = 0;
+	entity_list.capacity = 0;
 	entity_list.items = NULL;
+	entity_list.arena = arena;
 	return entity_list;
 }
 
 void entity_list_destroy(struct entity_list *entity_list) {
 	assert(entity_list != NULL);
 	
+	if (entity_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < entity_list->length; i++) {
 		struct entity entity = entity_list->items[i];
 		entity_destroy(&entity);
 	}
 	
-	free(entity_list->items);
+	memory_free(entity_list->arena, entity_list->items);
 }
 
 void entity_list_append(struct entity_list *entity_list, struct entity entity) {
 	assert(entity_list != NULL);
 	
+	entity_list->items = array_grow(entity_list->items, entity_list->length, &entity_list->capacity, sizeof(struct entity), entity_list->arena);
+	entity_list->items[entity_list->length] = entity;
 	entity_list->length++;
-	entity_list->items = realloc(entity_list->items, sizeof(struct entity) * entity_list->length);
-	entity_list->items[entity_list->length - 1] = entity;
+}
+
+void entity_list_reserve(struct entity_list *entity_list, int capacity) {
+	assert(entity_list != NULL);
+	
+	entity_list->items = array_reserve(entity_list->items, entity_list->length, &entity_list->capacity, capacity, sizeof(struct entity), entity_list->arena);
+}
+
+void entity_list_shrink_to_fit(struct entity_list *entity_list) {
+	assert(entity_list != NULL);
+	
+	entity_list->items = array_shrink_to_fit(entity_list->items, entity_list->length, &entity_list->capacity, sizeof(struct entity), entity_list->arena);
 }
 
 struct entity* entity_list_top(struct entity_list *entity_list) {
@@ -570,14 +959,42 @@ struct entity* entity_list_top(struct entity_list *entity_list) {
 ////////////////////////////////////////////////////////////////////////////////
 // Spriter Data
 ////////////////////////////////////////////////////////////////////////////////
-struct spriter_data spriter_data_create() {
+struct spriter_data spriter_data_create(struct arena *arena) {
 	struct spriter_data spriter_data;
-	spriter_data.folder_list = folder_list_create();
-	spriter_data.entity_list = entity_list_create();
+	spriter_data.version = string_create_from_view(string_view_create("", 0), arena);
+	spriter_data.generator = string_create_from_view(string_view_create("", 0), arena);
+	spriter_data.generator_version = string_create_from_view(string_view_create("", 0), arena);
+	spriter_data.folder_list = folder_list_create(arena);
+	spriter_data.entity_list = entity_list_create(arena);
+	spriter_data.arena = arena;
 	return spriter_data;
 }
 
+// Applies mainline_key_order_bones to every mainline key, for a spriter_data
+// put together other than by the builder, which orders each key as it closes.
+void spriter_data_order_bones(struct spriter_data *spriter_data) {
+	assert(spriter_data != NULL);
+	
+	struct bone_order_scratch scratch = bone_order_scratch_create();
+	for (int i = 0; i < spriter_data->entity_list.length; i++) {
+		struct entity *entity = &spriter_data->entity_list.items[i];
+		
+		for (int j = 0; j < entity->animation_list.length; j++) {
+			struct mainline_key_list *mainline_keys = &entity->animation_list.items[j].mainline.mainline_key_list;
+			
+			for (int k = 0; k < mainline_keys->length; k++) {
+				mainline_key_order_bones(&mainline_keys->items[k], &scratch);
+			}
+		}
+	}
+	bone_order_scratch_destroy(&scratch);
+}
+
 void spriter_data_destroy(struct spriter_data *spriter_data) {
+	assert(spriter_data != NULL);
+	
+	if (spriter_data->arena != NULL) return; // a single arena_reset frees the whole rig
+	
 	string_destroy(&spriter_data->version);
 	string_destroy(&spriter_data->generator);
 	string_destroy(&spriter_data->generator_version);
@@ -585,284 +1002,748 @@ void spriter_data_destroy(struct spriter_data *spriter_data) {
 	entity_list_destroy(&spriter_data->entity_list);
 }
 
+static size_t string_memory(struct string *str) {
+	return (str->characters != NULL) ? (size_t)string_length(str) + 1 : 0;
+}
 
-struct spriter_data parse_tags(struct tag_list tags) {
-	struct spriter_data spriter_data = spriter_data_create();
+// Bytes held by the lists and strings of a spriter_data, counting the capacity
+// of every list rather than its length.
+size_t spriter_data_memory(struct spriter_data *spriter_data) {
+	assert(spriter_data != NULL);
 	
-	bool enclosed_in_timeline = false; // used to determine what type of key
-	bool enclosed_in_mainline = false;
+	size_t memory = string_memory(&spriter_data->version) + string_memory(&spriter_data->generator) + string_memory(&spriter_data->generator_version);
 	
-	for (int i = 0; i < tags.length; i++) {
-		struct tag tag = tags.items[i];
+	struct folder_list *folders = &spriter_data->folder_list;
+	memory += sizeof(struct folder) * folders->capacity;
+	for (int i = 0; i < folders->length; i++) {
+		struct file_list *files = &folders->items[i].file_list;
+		memory += sizeof(struct file) * files->capacity;
+		for (int j = 0; j < files->length; j++) {
+			memory += string_memory(&files->items[j].name);
+		}
+	}
+	
+	struct entity_list *entities = &spriter_data->entity_list;
+	memory += sizeof(struct entity) * entities->capacity;
+	for (int i = 0; i < entities->length; i++) {
+		struct entity *entity = &entities->items[i];
+		memory += string_memory(&entity->name) + sizeof(struct animation) * entity->animation_list.capacity;
 		
-		if (string_compare(&tag.identifier.text, "file")) {
-			printf("Parsing file\r\n");
-			
-			struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-			struct attribute attr_name = attribute_list_find_by_name(&tag.attributes, "name");
-			struct attribute attr_width = attribute_list_find_by_name(&tag.attributes, "width");
-			struct attribute attr_height = attribute_list_find_by_name(&tag.attributes, "height");
-			struct attribute attr_pivot_x = attribute_list_find_by_name(&tag.attributes, "pivot_x");
-			struct attribute attr_pivot_y = attribute_list_find_by_name(&tag.attributes, "pivot_y");
+		for (int j = 0; j < entity->animation_list.length; j++) {
+			struct animation *animation = &entity->animation_list.items[j];
+			memory += string_memory(&animation->name);
 			
+			struct mainline_key_list *mainline_keys = &animation->mainline.mainline_key_list;
+			memory += sizeof(struct mainline_key) * mainline_keys->capacity;
+			for (int k = 0; k < mainline_keys->length; k++) {
+				memory += sizeof(struct object_ref) * mainline_keys->items[k].object_ref_list.capacity;
+				memory += sizeof(struct bone_ref) * mainline_keys->items[k].bone_ref_list.capacity;
+				if (mainline_keys->items[k].bone_order != NULL) {
+					memory += sizeof(int) * (2 * mainline_keys->items[k].bone_ref_list.length + mainline_keys->items[k].object_ref_list.length);
+				}
+			}
 			
-			int id = string_to_int(&attr_id.value.text);
-			struct string name = attr_name.value.text;
-			int width = string_to_int(&attr_width.value.text);
-			int height = string_to_int(&attr_height.value.text);
-			float pivot_x = string_to_float(&attr_pivot_x.value.text);
-			float pivot_y = string_to_float(&attr_pivot_y.value.text);
+			struct timeline_list *timelines = &animation->timeline_list;
+			memory += sizeof(struct timeline) * timelines->capacity;
+			for (int k = 0; k < timelines->length; k++) {
+				struct timeline_key_list *timeline_keys = &timelines->items[k].timeline_key_list;
+				memory += string_memory(&timelines->items[k].name) + sizeof(struct timeline_key) * timeline_keys->capacity;
+				for (int l = 0; l < timeline_keys->length; l++) {
+					memory += sizeof(struct object) * timeline_keys->items[l].object_list.capacity;
+					memory += sizeof(struct bone) * timeline_keys->items[l].bone_list.capacity;
+				}
+			}
+		}
+	}
+	
+	return memory;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Attribute slots
+////////////////////////////////////////////////////////////////////////////////
+#define TAG_SCHEMA_MAX_ATTRIBUTES 8
+
+struct attribute_schema {
+	enum attribute_types type;
+	const char *default_value; // NULL when the attribute is required
+};
+
+struct tag_schema {
+	int count;
+	struct attribute_schema attributes[TAG_SCHEMA_MAX_ATTRIBUTES];
+};
+
+// The attributes the builder reads from each tag. A <key> is read for both
+// the mainline and timelines, so its schema covers both.
+static const struct tag_schema tag_schemas[tag_type_count] = {
+	[tag_type_spriter_data] = { 3, {
+		{ attribute_type_scml_version, NULL },
+		{ attribute_type_generator, NULL },
+		{ attribute_type_generator_version, NULL } } },
+	[tag_type_folder] = { 1, {
+		{ attribute_type_id, NULL } } },
+	[tag_type_file] = { 6, {
+		{ attribute_type_id, NULL },
+		{ attribute_type_name, NULL },
+		{ attribute_type_width, NULL },
+		{ attribute_type_height, NULL },
+		{ attribute_type_pivot_x, "0" },
+		{ attribute_type_pivot_y, "1" } } },
+	[tag_type_entity] = { 2, {
+		{ attribute_type_id, NULL },
+		{ attribute_type_name, NULL } } },
+	[tag_type_animation] = { 5, {
+		{ attribute_type_id, NULL },
+		{ attribute_type_name, NULL },
+		{ attribute_type_length, NULL },
+		{ attribute_type_interval, NULL },
+		{ attribute_type_looping, "true" } } },
+	[tag_type_key] = { 3, {
+		{ attribute_type_id, NULL },
+		{ attribute_type_time, "0" },
+		{ attribute_type_spin, "1" } } },
+	[tag_type_object_ref] = { 5, {
+		{ attribute_type_id, NULL },
+		{ attribute_type_parent, "-1" },
+		{ attribute_type_timeline, NULL },
+		{ attribute_type_key, NULL },
+		{ attribute_type_z_index, NULL } } },
+	[tag_type_bone_ref] = { 4, {
+		{ attribute_type_id, NULL },
+		{ attribute_type_parent, "-1" },
+		{ attribute_type_timeline, NULL },
+		{ attribute_type_key, NULL } } },
+	[tag_type_timeline] = { 2, {
+		{ attribute_type_id, NULL },
+		{ attribute_type_name, NULL } } },
+	[tag_type_object] = { 8, {
+		{ attribute_type_folder, NULL },
+		{ attribute_type_file, NULL },
+		{ attribute_type_x, "0" },
+		{ attribute_type_y, "0" },
+		{ attribute_type_angle, "0" },
+		{ attribute_type_scale_x, "1" },
+		{ attribute_type_scale_y, "1" },
+		{ attribute_type_a, "1" } } },
+	[tag_type_bone] = { 6, {
+		{ attribute_type_x, "0" },
+		{ attribute_type_y, "0" },
+		{ attribute_type_angle, "0" },
+		{ attribute_type_scale_x, "1" },
+		{ attribute_type_scale_y, "1" },
+		{ attribute_type_a, "1" } } },
+};
+
+void attribute_slots_reset(struct attribute_slots *slots, enum tag_types tag_type) {
+	assert(slots != NULL);
+	
+	const struct tag_schema *schema = &tag_schemas[tag_type];
+	
+	for (int i = 0; i < schema->count; i++) {
+		struct attribute_schema attribute = schema->attributes[i];
+		
+		slots->present[attribute.type] = false;
+		if (attribute.default_value != NULL) {
+			slots->values[attribute.type] = string_view_create(attribute.default_value, strlen(attribute.default_value));
+		} else {
+			slots->values[attribute.type] = string_view_create("", 0);
+		}
+	}
+}
+
+void attribute_slots_set(struct attribute_slots *slots, enum attribute_types attribute_type, struct string_view value) {
+	assert(slots != NULL);
+	
+	if (attribute_type == attribute_type_unknown) return;
+	
+	slots->values[attribute_type] = value;
+	slots->present[attribute_type] = true;
+}
+
+// Every required attribute of the schema must have been set.
+void attribute_slots_validate(struct attribute_slots *slots, enum tag_types tag_type) {
+	assert(slots != NULL);
+	
+	const struct tag_schema *schema = &tag_schemas[tag_type];
+	
+	for (int i = 0; i < schema->count; i++) {
+		struct attribute_schema attribute = schema->attributes[i];
+		assert(slots->present[attribute.type] || (attribute.default_value != NULL));
+	}
+}
+
+bool attribute_slots_has(struct attribute_slots *slots, enum attribute_types attribute_type) {
+	assert(slots != NULL);
+	
+	return slots->present[attribute_type];
+}
+
+int attribute_slots_int(struct attribute_slots *slots, enum attribute_types attribute_type) {
+	assert(slots != NULL);
+	
+	return string_to_int(slots->values[attribute_type]);
+}
+
+float attribute_slots_float(struct attribute_slots *slots, enum attribute_types attribute_type) {
+	assert(slots != NULL);
+	
+	return string_to_float(slots->values[attribute_type]);
+}
+
+// Reads several float attributes of the tag in one string_to_floats call.
+void attribute_slots_floats(struct attribute_slots *slots, const enum attribute_types *attribute_types, float *values, int count) {
+	assert(slots != NULL);
+	assert(count <= attribute_type_count);
+	
+	struct string_view views[attribute_type_count];
+	for (int i = 0; i < count; i++) {
+		views[i] = slots->values[attribute_types[i]];
+	}
+	
+	string_to_floats(views, values, count);
+}
+
+// Anything but "false" is true, like Spriter itself reads it.
+bool attribute_slots_bool(struct attribute_slots *slots, enum attribute_types attribute_type) {
+	assert(slots != NULL);
+	
+	return !string_view_compare(slots->values[attribute_type], "false");
+}
+
+struct string attribute_slots_string(struct attribute_slots *slots, enum attribute_types attribute_type, struct arena *arena) {
+	assert(slots != NULL);
+	
+	return string_create_from_view(slots->values[attribute_type], arena);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Parse stats
+////////////////////////////////////////////////////////////////////////////////
+struct parse_stats parse_stats_create(void) {
+	struct parse_stats stats;
+	memset(&stats, 0, sizeof(struct parse_stats));
+	return stats;
+}
+
+static double parse_stats_now(void) {
+#ifndef _WIN32
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+// Only tag types that were seen are listed.
+void parse_stats_print(struct parse_stats *stats, FILE *file) {
+	assert(stats != NULL);
+	assert(file != NULL);
+	
+	fprintf(file, "%ld tags, %ld bytes tokenized, %ld allocations (%ld bytes), %.3f ms", stats->tag_count, stats->bytes_tokenized, stats->allocations, stats->bytes_allocated, stats->total_seconds * 1e3);
+	if (stats->time_phases) {
+		fprintf(file, " (tokenize %.3f ms, build %.3f ms)", stats->tokenize_seconds * 1e3, stats->build_seconds * 1e3);
+	}
+	fprintf(file, "\r\n");
+	
+	for (int i = 0; i < tag_type_count; i++) {
+		if (stats->tag_counts[i] > 0) {
+			fprintf(file, "  %-14s %ld\r\n", tag_type_name((enum tag_types)i), stats->tag_counts[i]);
+		}
+	}
+}
+
+// A trace sink printing a line per tag to the FILE * in `user_data`, stdout
+// when NULL.
+void parse_trace_print(void *user_data, enum tag_types tag_type) {
+	FILE *file = (user_data != NULL) ? user_data : stdout;
+	fprintf(file, "Parsing %s\r\n", tag_type_name(tag_type));
+}
+
+// What a parse procedure needs to fill in a parse_stats around its work.
+struct parse_stats_session {
+	struct parse_stats *stats;
+	struct memory_counters counters;
+	struct memory_counters *previous_counters;
+	double start;
+	double build_seconds; // of the stats, at the start
+};
+
+// The session binds its counters, so it stays where it is until the end.
+static void parse_stats_begin(struct parse_stats_session *session, struct parse_stats *stats) {
+	memset(session, 0, sizeof(struct parse_stats_session));
+	session->stats = stats;
+
+#if SPRITER_STATS
+	if (stats != NULL) {
+		session->previous_counters = memory_counters_bind(&session->counters);
+		session->build_seconds = stats->build_seconds;
+		session->start = parse_stats_now();
+	}
+#endif
+}
+
+// Time not spent building tags went to tokenizing, of which there was
+// `bytes_tokenized`.
+static void parse_stats_end(struct parse_stats_session *session, long bytes_tokenized) {
+#if SPRITER_STATS
+	struct parse_stats *stats = session->stats;
+	if (stats == NULL) return;
+	
+	double elapsed = parse_stats_now() - session->start;
+	memory_counters_bind(session->previous_counters);
+	
+	stats->bytes_tokenized += bytes_tokenized;
+	stats->allocations += session->counters.allocations;
+	stats->bytes_allocated += session->counters.bytes;
+	stats->total_seconds += elapsed;
+	
+	if (stats->time_phases) {
+		double building = stats->build_seconds - session->build_seconds;
+		stats->tokenize_seconds += (bytes_tokenized > 0) ? elapsed - building : 0.0;
+	}
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Builder
+////////////////////////////////////////////////////////////////////////////////
+struct scml_builder scml_builder_create(struct arena *arena) {
+	struct scml_builder builder;
+	builder.spriter_data = spriter_data_create(arena);
+	builder.arena = arena;
+	builder.tag_type = tag_type_unknown;
+	builder.building = false;
+	memset(&builder.attributes, 0, sizeof(struct attribute_slots));
+	builder.depth = 0;
+	builder.bone_order = bone_order_scratch_create();
+	builder.stats = NULL;
+	return builder;
+}
+
+void scml_builder_destroy(struct scml_builder *builder) {
+	assert(builder != NULL);
+	
+	bone_order_scratch_destroy(&builder->bone_order);
+}
+
+static struct animation* scml_builder_animation(struct scml_builder *builder) {
+	struct entity* entity = entity_list_top(&builder->spriter_data.entity_list);
+	return animation_list_top(&entity->animation_list);
+}
+
+// Opens a tag built as `tag_type`, or skipped when tag_type_unknown. Called
+// directly, it lets a builder start inside a file, as if the tags enclosing
+// the part it is given had been read.
+void scml_builder_enter(struct scml_builder *builder, enum tag_types tag_type) {
+	assert(builder != NULL);
+	
+	if (builder->depth < SCML_BUILDER_MAX_DEPTH) {
+		builder->open_tags[builder->depth] = tag_type;
+	}
+	builder->depth++;
+}
+
+// Closes the innermost tag. A mainline key is complete once it closes, so its
+// bones are ordered there rather than in a pass over the whole file after.
+void scml_builder_leave(struct scml_builder *builder) {
+	assert(builder != NULL);
+	
+	if (builder->depth == 0) return;
+	builder->depth--;
+	
+	int depth = builder->depth;
+	if ((depth >= 1) && (depth < SCML_BUILDER_MAX_DEPTH) && (builder->open_tags[depth] == tag_type_key) && (builder->open_tags[depth - 1] == tag_type_mainline)) {
+		struct animation *animation = scml_builder_animation(builder);
+		struct mainline_key *mainline_key = mainline_key_list_top(&animation->mainline.mainline_key_list);
+		mainline_key_order_bones(mainline_key, &builder->bone_order);
+	}
+}
+
+// Closes every tag still open, as the end of a truncated input would.
+void scml_builder_finish(struct scml_builder *builder) {
+	assert(builder != NULL);
+	
+	while (builder->depth > 0) {
+		scml_builder_leave(builder);
+	}
+}
+
+// What the tag `generations` levels above the one being opened was built as.
+static enum tag_types scml_builder_enclosing(struct scml_builder *builder, int generations) {
+	int index = builder->depth - 1 - generations;
+	if ((index < 0) || (index >= SCML_BUILDER_MAX_DEPTH)) return tag_type_unknown;
+	return builder->open_tags[index];
+}
+
+// Whether a tag opened here is one the builder reads. A <key> is a mainline
+// or a timeline key only directly under those, and refs and transforms only
+// belong to the keys of the matching line.
+static bool scml_builder_accepts(struct scml_builder *builder, enum tag_types tag_type) {
+	enum tag_types parent = scml_builder_enclosing(builder, 0);
+	enum tag_types grandparent = scml_builder_enclosing(builder, 1);
+	
+	switch (tag_type) {
+		case tag_type_spriter_data:
+			return builder->depth == 0;
+		case tag_type_folder:
+		case tag_type_entity:
+			return parent == tag_type_spriter_data;
+		case tag_type_file:
+			return parent == tag_type_folder;
+		case tag_type_animation:
+			return parent == tag_type_entity;
+		case tag_type_mainline:
+		case tag_type_timeline:
+			return parent == tag_type_animation;
+		case tag_type_key:
+			return (parent == tag_type_mainline) || (parent == tag_type_timeline);
+		case tag_type_object_ref:
+		case tag_type_bone_ref:
+			return (parent == tag_type_key) && (grandparent == tag_type_mainline);
+		case tag_type_object:
+		case tag_type_bone:
+			return (parent == tag_type_key) && (grandparent == tag_type_timeline);
+		default:
+			return false;
+	}
+}
+
+// The float attributes shared by <object> and <bone>, in constructor order.
+static const enum attribute_types scml_transform_attributes[6] = {
+	attribute_type_x, attribute_type_y, attribute_type_angle, attribute_type_scale_x, attribute_type_scale_y, attribute_type_a
+};
+
+static void scml_builder_build_tag(struct scml_builder *builder) {
+	struct arena *arena = builder->arena;
+	struct spriter_data *spriter_data = &builder->spriter_data;
+	struct attribute_slots *attributes = &builder->attributes;
+	
+	attribute_slots_validate(attributes, builder->tag_type);
+	
+	switch (builder->tag_type) {
+		case tag_type_file: {
+			int id = attribute_slots_int(attributes, attribute_type_id);
+			struct string name = attribute_slots_string(attributes, attribute_type_name, arena);
+			int width = attribute_slots_int(attributes, attribute_type_width);
+			int height = attribute_slots_int(attributes, attribute_type_height);
+			float pivot_x = attribute_slots_float(attributes, attribute_type_pivot_x);
+			float pivot_y = attribute_slots_float(attributes, attribute_type_pivot_y);
 			
 			struct file file = file_create(id, name, width, height, pivot_x, pivot_y);
 			
-			struct folder* folder = folder_list_top(&spriter_data.folder_list);
+			struct folder* folder = folder_list_top(&spriter_data->folder_list);
 			file_list_append(&folder->file_list, file);
+			break;
+		}
+		case tag_type_folder: {
+			int id = attribute_slots_int(attributes, attribute_type_id);
 			
-		} else if (string_compare(&tag.identifier.text, "folder")) {
-			printf("Parsing folder\r\n");
-			
-			struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-			
-			int id = string_to_int(&attr_id.value.text);
-			
-			struct folder folder = folder_create(id);
-			
-			folder_list_append(&spriter_data.folder_list, folder);
-			
-		} else if (string_compare(&tag.identifier.text, "object_ref")) {
-			printf("Parsing object ref\r\n");
-			
-			struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-			struct attribute attr_timeline = attribute_list_find_by_name(&tag.attributes, "timeline");
-			struct attribute attr_key = attribute_list_find_by_name(&tag.attributes, "key");
-			struct attribute attr_z_index = attribute_list_find_by_name(&tag.attributes, "z_index");
-			
-			int id = string_to_int(&attr_id.value.text);
-			int timeline = string_to_int(&attr_timeline.value.text);
-			int key = string_to_int(&attr_key.value.text);
-			int z_index = string_to_int(&attr_z_index.value.text);
-			
-			struct object_ref object_ref = object_ref_create(id, timeline, key, z_index);
-			
-			struct entity* entity = entity_list_top(&spriter_data.entity_list);
-			struct animation* animation = animation_list_top(&entity->animation_list);
-			struct mainline* mainline = &animation->mainline;
-			struct mainline_key_list* mainline_key_list = &(mainline->mainline_key_list);
-			struct mainline_key* mainline_key = mainline_key_list_top(mainline_key_list);
-			struct object_ref_list object_ref_list = mainline_key->object_ref_list;
-			object_ref_list_append(&object_ref_list, object_ref);
+			struct folder folder = folder_create(id, arena);
 			
-		} else if (string_compare(&tag.identifier.text, "bone")) {
-			printf("Parsing bone\r\n");
+			folder_list_append(&spriter_data->folder_list, folder);
+			break;
+		}
+		case tag_type_object_ref: {
+			int id = attribute_slots_int(attributes, attribute_type_id);
+			int parent = attribute_slots_int(attributes, attribute_type_parent);
+			int timeline = attribute_slots_int(attributes, attribute_type_timeline);
+			int key = attribute_slots_int(attributes, attribute_type_key);
+			int z_index = attribute_slots_int(attributes, attribute_type_z_index);
 			
-			float x = 0.0f;
-			float y = 0.0f;
-			float angle = 0.0f;
-			float scale_x = 1.0f;
-			float scale_y = 1.0f;
-			float a = 1.0f;
+			struct object_ref object_ref = object_ref_create(id, parent, timeline, key, z_index);
 			
-			struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-			struct attribute attr_parent = attribute_list_find_by_name(&tag.attributes, "parent");
-			struct attribute attr_timeline = attribute_list_find_by_name(&tag.attributes, "timeline");
-			struct attribute attr_key = attribute_list_find_by_name(&tag.attributes, "key");
+			struct animation* animation = scml_builder_animation(builder);
+			struct mainline_key* mainline_key = mainline_key_list_top(&animation->mainline.mainline_key_list);
+			object_ref_list_append(&mainline_key->object_ref_list, object_ref);
+			break;
+		}
+		case tag_type_bone: {
+			float transform[6];
+			attribute_slots_floats(attributes, scml_transform_attributes, transform, 6);
 			
-			struct bone bone = bone_create(x, y, angle, scale_x, scale_y, a);
+			struct bone bone = bone_create(transform[0], transform[1], transform[2], transform[3], transform[4], transform[5]);
 			
-			struct entity* entity = entity_list_top(&spriter_data.entity_list);
-			struct animation* animation = animation_list_top(&entity->animation_list);
-			struct timeline* timeline = &animation->timeline;
-			struct timeline_key_list* timeline_key_list = &(timeline->timeline_key_list);
-			struct timeline_key* timeline_key = timeline_key_list_top(timeline_key_list);
+			struct animation* animation = scml_builder_animation(builder);
+			struct timeline* timeline = timeline_list_top(&animation->timeline_list);
+			struct timeline_key* timeline_key = timeline_key_list_top(&timeline->timeline_key_list);
 			bone_list_append(&timeline_key->bone_list, bone);
-			
-		} else if (string_compare(&tag.identifier.text, "bone_ref")) {
-			printf("Parsing bone_ref\r\n");
-			
-			int id = 0;
-			int parent = -1;
-			int timeline = 0;
-			int key = 0;
-			
-			struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-			if (attribute_list_contains_name(&tag.attributes, "parent")) {
-				struct attribute attr_parent = attribute_list_find_by_name(&tag.attributes, "parent");
-				parent = string_to_int(&attr_parent.value.text);
-			}
-			struct attribute attr_timeline = attribute_list_find_by_name(&tag.attributes, "timeline");
-			struct attribute attr_key = attribute_list_find_by_name(&tag.attributes, "key");
-			
-			timeline = string_to_int(&attr_timeline.value.text);
-			key = string_to_int(&attr_key.value.text);
+			break;
+		}
+		case tag_type_bone_ref: {
+			int id = attribute_slots_int(attributes, attribute_type_id);
+			int parent = attribute_slots_int(attributes, attribute_type_parent);
+			int timeline = attribute_slots_int(attributes, attribute_type_timeline);
+			int key = attribute_slots_int(attributes, attribute_type_key);
 			
 			struct bone_ref bone_ref = bone_ref_create(id, parent, timeline, key);
 			
-			struct entity* entity = entity_list_top(&spriter_data.entity_list);
-			struct animation* animation = animation_list_top(&entity->animation_list);
-			struct mainline* mainline = &animation->mainline;
-			struct mainline_key_list* mainline_key_list = &(mainline->mainline_key_list);
-			struct mainline_key* mainline_key = mainline_key_list_top(mainline_key_list);
+			struct animation* animation = scml_builder_animation(builder);
+			struct mainline_key* mainline_key = mainline_key_list_top(&animation->mainline.mainline_key_list);
 			bone_ref_list_append(&mainline_key->bone_ref_list, bone_ref);
+			break;
+		}
+		case tag_type_object: {
+			int folder = attribute_slots_int(attributes, attribute_type_folder);
+			int file = attribute_slots_int(attributes, attribute_type_file);
+			float transform[6];
+			attribute_slots_floats(attributes, scml_transform_attributes, transform, 6);
 			
-		} else if (string_compare(&tag.identifier.text, "mainline")) {
-			printf("Parsing mainline\r\n");
-			
-			struct mainline mainline = mainline_create();
-			
-			struct entity* entity = entity_list_top(&spriter_data.entity_list);
-			struct animation* animation = animation_list_top(&entity->animation_list);
-			animation->mainline = mainline;
-			
-			enclosed_in_timeline = false;
-			enclosed_in_mainline = true;
-			
-		} else if (string_compare(&tag.identifier.text, "object")) {
-			printf("Parsing object\r\n");
-			
-			int folder = 0;
-			int file = 0;
-			float angle = 0.0f;
-			float scale_x = 1.0f;
-			float scale_y = 1.0f;
-			
-			struct attribute attr_folder = attribute_list_find_by_name(&tag.attributes, "folder");
-			struct attribute attr_file = attribute_list_find_by_name(&tag.attributes, "file");
-			if (attribute_list_contains_name(&tag.attributes, "scale_y")) {
-				struct attribute attr_angle = attribute_list_find_by_name(&tag.attributes, "angle");
-				angle = string_to_float(&attr_angle.value.text);
-			}
-			if (attribute_list_contains_name(&tag.attributes, "scale_x")) {
-				struct attribute attr_scale_x = attribute_list_find_by_name(&tag.attributes, "scale_x");
-				scale_x = string_to_float(&attr_scale_x.value.text);
-			}
-			if (attribute_list_contains_name(&tag.attributes, "scale_y")) {
-				struct attribute attr_scale_y = attribute_list_find_by_name(&tag.attributes, "scale_y");
-				scale_y = string_to_float(&attr_scale_y.value.text);
-			}
-			
-			folder = string_to_int(&attr_folder.value.text);
-			file = string_to_int(&attr_file.value.text);
-			
-			struct object object = object_create(folder, file, angle, scale_x, scale_y);
+			struct object object = object_create(folder, file, transform[0], transform[1], transform[2], transform[3], transform[4], transform[5]);
 			
-			struct entity* entity = entity_list_top(&spriter_data.entity_list);
-			struct animation* animation = animation_list_top(&entity->animation_list);
-			struct timeline timeline = animation->timeline;
-			struct timeline_key* timeline_key = timeline_key_list_top(&timeline.timeline_key_list);
+			struct animation* animation = scml_builder_animation(builder);
+			struct timeline* timeline = timeline_list_top(&animation->timeline_list);
+			struct timeline_key* timeline_key = timeline_key_list_top(&timeline->timeline_key_list);
 			object_list_append(&timeline_key->object_list, object);
-			
-		} else if (string_compare(&tag.identifier.text, "key")) {
-			printf("Parsing key!\r\n");
-			
-			if (enclosed_in_mainline) {
-				printf("Parsing mainline key\r\n");
-				
-				int id = 0;
-				
-				struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-				
-				id = string_to_int(&attr_id.value.text);
-				
-				struct mainline_key mainline_key = mainline_key_create(id);
-				
-				struct entity* entity = entity_list_top(&spriter_data.entity_list);
-				struct animation* animation = animation_list_top(&entity->animation_list);
-				struct mainline* mainline = &animation->mainline;
-				mainline_key_list_append(&mainline->mainline_key_list, mainline_key);
-				
-			} else if (enclosed_in_timeline) {
-				printf("Parsing timeline key\r\n");
-				
-				int id = 0;
-				int time = 0;
-				int spin = 0;
+			break;
+		}
+		case tag_type_key: {
+			if (scml_builder_enclosing(builder, 0) == tag_type_mainline) {
+				int id = attribute_slots_int(attributes, attribute_type_id);
+				int time = attribute_slots_int(attributes, attribute_type_time);
 				
-				struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-				if (attribute_list_contains_name(&tag.attributes, "time")) {
-					struct attribute attr_time = attribute_list_find_by_name(&tag.attributes, "time");
-					time = string_to_int(&attr_time.value.text);
-				}
-				struct attribute attr_spin = attribute_list_find_by_name(&tag.attributes, "spin");
+				struct mainline_key mainline_key = mainline_key_create(id, time, arena);
 				
-				id = string_to_int(&attr_id.value.text);
-				spin = string_to_int(&attr_spin.value.text);
+				struct animation* animation = scml_builder_animation(builder);
+				mainline_key_list_append(&animation->mainline.mainline_key_list, mainline_key);
+			
+			} else {
+				int id = attribute_slots_int(attributes, attribute_type_id);
+				int time = attribute_slots_int(attributes, attribute_type_time);
+				int spin = attribute_slots_int(attributes, attribute_type_spin);
 				
-				struct timeline_key timeline_key = timeline_key_create(id, time, spin);
+				struct timeline_key timeline_key = timeline_key_create(id, time, spin, arena);
 				
-				struct entity *entity = entity_list_top(&spriter_data.entity_list);
-				struct animation *animation = animation_list_top(&entity->animation_list);
-				struct timeline* timeline = &animation->timeline;
+				struct animation* animation = scml_builder_animation(builder);
+				struct timeline* timeline = timeline_list_top(&animation->timeline_list);
 				timeline_key_list_append(&timeline->timeline_key_list, timeline_key);
-				
-			}
-		} else if (string_compare(&tag.identifier.text, "timeline")) {
-			printf("Parsing timeline\r\n");
-			
-			int id = 0;
-			struct string name = string_create("");
-			
-			struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-			struct attribute attr_name = attribute_list_find_by_name(&tag.attributes, "name");
-			
-			struct timeline timeline = timeline_create(id, name);
-			
-			struct entity* entity = entity_list_top(&spriter_data.entity_list);
-			struct animation* animation = animation_list_top(&entity->animation_list);
-			animation->timeline = timeline;
 			
-			enclosed_in_timeline = true;
-			enclosed_in_mainline = false;
-			
-		} else if (string_compare(&tag.identifier.text, "animation")) {
-			printf("Parsing animation\r\n");
-			
-			int id = 0;
-			struct string name = string_create("");
-			int length = 0;
-			int interval = 0;
+			}
+			break;
+		}
+		case tag_type_timeline: {
+			int id = attribute_slots_int(attributes, attribute_type_id);
+			struct string name = attribute_slots_string(attributes, attribute_type_name, arena);
 			
-			struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-			struct attribute attr_name = attribute_list_find_by_name(&tag.attributes, "name");
-			struct attribute attr_length = attribute_list_find_by_name(&tag.attributes, "length");
-			struct attribute attr_interval = attribute_list_find_by_name(&tag.attributes, "interval");
+			struct timeline timeline = timeline_create(id, name, arena);
 			
-			id = string_to_int(&attr_id.value.text);
-			name = attr_name.value.text;
-			length = string_to_int(&attr_length.value.text);
-			interval = string_to_int(&attr_interval.value.text);
+			struct animation* animation = scml_builder_animation(builder);
+			timeline_list_append(&animation->timeline_list, timeline);
+			break;
+		}
+		case tag_type_animation: {
+			int id = attribute_slots_int(attributes, attribute_type_id);
+			struct string name = attribute_slots_string(attributes, attribute_type_name, arena);
+			int length = attribute_slots_int(attributes, attribute_type_length);
+			int interval = attribute_slots_int(attributes, attribute_type_interval);
+			bool looping = attribute_slots_bool(attributes, attribute_type_looping);
 			
-			struct animation animation = animation_create(id, name, length, interval);
+			struct animation animation = animation_create(id, name, length, interval, looping, arena);
 			
-			struct entity* entity = entity_list_top(&spriter_data.entity_list);
+			struct entity* entity = entity_list_top(&spriter_data->entity_list);
 			animation_list_append(&entity->animation_list, animation);
+			break;
+		}
+		case tag_type_entity: {
+			int id = attribute_slots_int(attributes, attribute_type_id);
+			struct string name = attribute_slots_string(attributes, attribute_type_name, arena);
 			
-		} else if (string_compare(&tag.identifier.text, "entity")) {
-			printf("Parsing entity\r\n");
-			
-			int id = 0;
-			struct string name = string_create("");
-			
-			struct attribute attr_id = attribute_list_find_by_name(&tag.attributes, "id");
-			struct attribute attr_name = attribute_list_find_by_name(&tag.attributes, "name");
-			
-			id = string_to_int(&attr_id.value.text);
-			name = attr_name.value.text;
-			
-			struct entity entity = entity_create(id, name);
-			entity_list_append(&spriter_data.entity_list, entity);
-			
-		} else if (string_compare(&tag.identifier.text, "spriter_data")) {
-			printf("Parsing spriter data\r\n");
-			
-			struct attribute attr_version = attribute_list_find_by_name(&tag.attributes, "scml_version");
-			struct attribute attr_generator = attribute_list_find_by_name(&tag.attributes, "generator");
-			struct attribute attr_generator_version = attribute_list_find_by_name(&tag.attributes, "generator_version");
+			struct entity entity = entity_create(id, name, arena);
+			entity_list_append(&spriter_data->entity_list, entity);
+			break;
+		}
+		case tag_type_spriter_data: {
+			if (arena == NULL) {
+				string_destroy(&spriter_data->version);
+				string_destroy(&spriter_data->generator);
+				string_destroy(&spriter_data->generator_version);
+			}
 			
-			spriter_data.version = attr_version.value.text;
-			spriter_data.generator = attr_generator.value.text;
-			spriter_data.generator_version = attr_generator.value.text;
+			spriter_data->version = attribute_slots_string(attributes, attribute_type_scml_version, arena);
+			spriter_data->generator = attribute_slots_string(attributes, attribute_type_generator, arena);
+			spriter_data->generator_version = attribute_slots_string(attributes, attribute_type_generator_version, arena);
+			break;
 		}
+		default:
+			break;
+	}
+}
+
+void scml_builder_on_open_tag(void *user_data, enum tag_types tag_type, struct string_view identifier) {
+	struct scml_builder *builder = user_data;
+	(void)identifier;
+	
+	builder->tag_type = tag_type;
+	builder->building = scml_builder_accepts(builder, tag_type);
+	if (builder->building) {
+		attribute_slots_reset(&builder->attributes, tag_type);
+	}
+}
+
+void scml_builder_on_attribute(void *user_data, enum attribute_types attribute_type, struct string_view name, struct string_view value) {
+	struct scml_builder *builder = user_data;
+	(void)name;
+	
+	if (!builder->building) {
+		return; // nothing is built from tags the builder skips
 	}
 	
+	attribute_slots_set(&builder->attributes, attribute_type, value);
+}
+
+// Every tag is counted and traced, built or not.
+void scml_builder_on_open_tag_end(void *user_data) {
+	struct scml_builder *builder = user_data;
+	bool timed = false;
+
+#if SPRITER_STATS
+	struct parse_stats *stats = builder->stats;
+	if (stats != NULL) {
+		stats->tag_counts[builder->tag_type]++;
+		stats->tag_count++;
+		if (stats->trace != NULL) stats->trace(stats->trace_user_data, builder->tag_type);
+		timed = stats->time_phases;
+	}
+#endif
+
+	if (builder->building && timed) {
+		double start = parse_stats_now();
+		scml_builder_build_tag(builder);
+		builder->stats->build_seconds += parse_stats_now() - start;
+	} else if (builder->building) {
+		scml_builder_build_tag(builder);
+	}
+	
+	scml_builder_enter(builder, builder->building ? builder->tag_type : tag_type_unknown);
+}
+
+void scml_builder_on_close_tag(void *user_data, enum tag_types tag_type, struct string_view identifier) {
+	struct scml_builder *builder = user_data;
+	(void)tag_type;
+	(void)identifier;
+	
+	scml_builder_leave(builder);
+}
+
+struct xml_handler scml_builder_handler(struct scml_builder *builder) {
+	assert(builder != NULL);
+	
+	struct xml_handler handler;
+	handler.user_data = builder;
+	handler.on_open_tag = scml_builder_on_open_tag;
+	handler.on_attribute = scml_builder_on_attribute;
+	handler.on_open_tag_end = scml_builder_on_open_tag_end;
+	handler.on_close_tag = scml_builder_on_close_tag;
+	return handler;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Push parser
+////////////////////////////////////////////////////////////////////////////////
+struct spriter_push_parser spriter_push_parser_create(struct arena *arena) {
+	struct spriter_push_parser parser;
+	parser.builder = scml_builder_create(arena);
+	parser.xml = xml_push_parser_create();
+	return parser;
+}
+
+// The handler is made for each chunk, as it points at the parser, which may
+// have moved since the last one.
+void spriter_push_parser_feed(struct spriter_push_parser *parser, const char *data, int length) {
+	assert(parser != NULL);
+	
+	struct xml_handler handler = scml_builder_handler(&parser->builder);
+	xml_push_parser_feed(&parser->xml, data, length, &handler);
+}
+
+// Returns what was built and frees the parser. `complete`, when not NULL, is
+// set to false if the input stopped inside a tag.
+struct spriter_data spriter_push_parser_finish(struct spriter_push_parser *parser, bool *complete) {
+	assert(parser != NULL);
+	
+	bool finished = xml_push_parser_finish(&parser->xml);
+	if (complete != NULL) *complete = finished;
+	
+	scml_builder_finish(&parser->builder);
+	struct spriter_data spriter_data = parser->builder.spriter_data;
+	scml_builder_destroy(&parser->builder);
+	xml_push_parser_destroy(&parser->xml);
+	
+	return spriter_data;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Procedures
+///////////////////////////////////////////////////////////////////////////////
+// Replays an already tokenized file through the builder. The tag list holds
+// no closing tags; the depth of each tag closes whatever it is not inside.
+// Nothing is tokenized here, so the stats only get building time.
+struct spriter_data parse_tags_with_stats(struct tag_list tags, struct arena *arena, struct parse_stats *stats) {
+	struct parse_stats_session session;
+	parse_stats_begin(&session, stats);
+	struct scml_builder builder = scml_builder_create(arena);
+	builder.stats = stats;
+	
+	for (int i = 0; i < tags.length; i++) {
+		struct tag tag = tags.items[i];
+		
+		while (builder.depth > tag.depth) {
+			scml_builder_leave(&builder);
+		}
+		scml_builder_on_open_tag(&builder, tag.identifier.type, tag.identifier.text);
+		for (int j = 0; j < tag.attributes.length; j++) {
+			struct attribute attribute = tag.attributes.items[j];
+			scml_builder_on_attribute(&builder, attribute.name.type, attribute.name.text, attribute.value.text);
+		}
+		scml_builder_on_open_tag_end(&builder);
+	}
+	
+	scml_builder_finish(&builder);
+	struct spriter_data spriter_data = builder.spriter_data;
+	scml_builder_destroy(&builder);
+	
+	parse_stats_end(&session, 0);
 	return spriter_data;
+}
+
+// Builds the spriter_data while the buffer is tokenized; no tag list is held.
+struct spriter_data parse_spriter_buffer_with_stats(const char *buffer, int length, struct arena *arena, struct parse_stats *stats) {
+	struct parse_stats_session session;
+	parse_stats_begin(&session, stats);
+	struct scml_builder builder = scml_builder_create(arena);
+	builder.stats = stats;
+	struct xml_handler handler = scml_builder_handler(&builder);
+	
+	parse_buffer_stream(buffer, length, &handler);
+	
+	scml_builder_finish(&builder);
+	struct spriter_data spriter_data = builder.spriter_data;
+	scml_builder_destroy(&builder);
+	
+	parse_stats_end(&session, length);
+	return spriter_data;
+}
+
+struct spriter_data parse_spriter_file_with_stats(char *filepath, struct arena *arena, struct parse_stats *stats) {
+	struct mapped_file mapped_file = mapped_file_open(filepath);
+	assert(mapped_file.is_open);
+	
+	struct spriter_data spriter_data = parse_spriter_buffer_with_stats(mapped_file.data, mapped_file.length, arena, stats);
+	mapped_file_close(&mapped_file);
+	
+	return spriter_data;
+}
+
+struct spriter_data parse_tags(struct tag_list tags, struct arena *arena) {
+	return parse_tags_with_stats(tags, arena, NULL);
+}
+
+struct spriter_data parse_spriter_buffer(const char *buffer, int length, struct arena *arena) {
+	return parse_spriter_buffer_with_stats(buffer, length, arena, NULL);
+}
+
+struct spriter_data parse_spriter_file(char *filepath, struct arena *arena) {
+	return parse_spriter_file_with_stats(filepath, arena, NULL);
 }
\ No newline at end of file
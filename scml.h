@@ -1,5 +1,7 @@
 #pragma once
 
+#include "arena.h"
+#include "array.h"
 #include "string.h"
 #include "xml.h"
 
@@ -8,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 
 
@@ -35,12 +38,16 @@ void file_destroy(struct file *file);
 ////////////////////////////////////////////////////////////////////////////////
 struct file_list {
 	int length;
+	int capacity;
 	struct file *items;
+	struct arena *arena;
 };
 
-struct file_list file_list_create();
+struct file_list file_list_create(struct arena *arena);
 void file_list_destroy(struct file_list *file_list);
 void file_list_append(struct file_list *file_list, struct file file);
+void file_list_reserve(struct file_list *file_list, int capacity);
+void file_list_shrink_to_fit(struct file_list *file_list);
 struct file* file_list_top(struct file_list *file_list);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -52,7 +59,7 @@ struct folder {
 	struct file_list file_list;
 };
 
-struct folder folder_create(int id);
+struct folder folder_create(int id, struct arena *arena);
 void folder_destroy(struct folder *folder);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,12 +67,16 @@ void folder_destroy(struct folder *folder);
 ////////////////////////////////////////////////////////////////////////////////
 struct folder_list {
 	int length;
+	int capacity;
 	struct folder *items;
+	struct arena *arena;
 };
 
-struct folder_list folder_list_create();
+struct folder_list folder_list_create(struct arena *arena);
 void folder_list_destroy(struct folder_list *folder_list);
 void folder_list_append(struct folder_list *folder_list, struct folder folder);
+void folder_list_reserve(struct folder_list *folder_list, int capacity);
+void folder_list_shrink_to_fit(struct folder_list *folder_list);
 struct folder* folder_list_top(struct folder_list *folder_list);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -73,12 +84,13 @@ struct folder* folder_list_top(struct folder_list *folder_list);
 ////////////////////////////////////////////////////////////////////////////////
 struct object_ref {
 	int id;
+	int parent; // bone_ref id, -1 for the root
 	int timeline;
 	int key;
 	int z_index;
 };
 
-struct object_ref object_ref_create(int id, int timeline, int key, int z_index);
+struct object_ref object_ref_create(int id, int parent, int timeline, int key, int z_index);
 void object_ref_destroy(struct object_ref *object_ref);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -86,12 +98,16 @@ void object_ref_destroy(struct object_ref *object_ref);
 ////////////////////////////////////////////////////////////////////////////////
 struct object_ref_list {
 	int length;
+	int capacity;
 	struct object_ref *items;
+	struct arena *arena;
 };
 
-struct object_ref_list object_ref_list_create();
+struct object_ref_list object_ref_list_create(struct arena *arena);
 void object_ref_list_destroy(struct object_ref_list *object_ref_list);
 void object_ref_list_append(struct object_ref_list *object_ref_list, struct object_ref object_ref);
+void object_ref_list_reserve(struct object_ref_list *object_ref_list, int capacity);
+void object_ref_list_shrink_to_fit(struct object_ref_list *object_ref_list);
 struct object_ref* object_ref_list_top(struct object_ref_list *object_ref_list);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -112,37 +128,75 @@ void bone_ref_destroy(struct bone_ref *bone_ref);
 ////////////////////////////////////////////////////////////////////////////////
 struct bone_ref_list {
 	int length;
+	int capacity;
 	struct bone_ref *items;
+	struct arena *arena;
 };
 
-struct bone_ref_list bone_ref_list_create();
+struct bone_ref_list bone_ref_list_create(struct arena *arena);
 void bone_ref_list_destroy(struct bone_ref_list *bone_ref_list);
 void bone_ref_list_append(struct bone_ref_list *bone_ref_list, struct bone_ref bone_ref);
+void bone_ref_list_reserve(struct bone_ref_list *bone_ref_list, int capacity);
+void bone_ref_list_shrink_to_fit(struct bone_ref_list *bone_ref_list);
 struct bone_ref* bone_ref_list_top(struct bone_ref_list *bone_ref_list);
 
+////////////////////////////////////////////////////////////////////////////////
+// Bone order scratch
+////////////////////////////////////////////////////////////////////////////////
+// Scratch memory for mainline_key_order_bones, grown to the largest key and
+// kept, so ordering a whole file allocates it only a few times.
+struct bone_order_scratch {
+	int capacity;
+	int *parents;   // index of each ref's parent ref
+	int *positions; // depth of each ref, then its position
+	int *ids;       // (id, index) pairs sorted by id
+};
+
+struct bone_order_scratch bone_order_scratch_create(void);
+void bone_order_scratch_destroy(struct bone_order_scratch *scratch);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Mainline key
 ////////////////////////////////////////////////////////////////////////////////
+// The refs keep their authored order and ids. Bones are also visited parents
+// first, so world transforms compose in one pass: `bone_order` gives the ref at
+// each position, `bone_parents` the position of its parent and
+// `object_parents` the position of each object's bone, -1 for a root. All
+// three are NULL while the refs already are in that order with ids equal to
+// their index; read them through the accessors below.
 struct mainline_key {
 	int id;
+	int time;
 	struct object_ref_list object_ref_list;
 	struct bone_ref_list bone_ref_list;
+	
+	int *bone_order;     // [bone_ref_list.length]
+	int *bone_parents;   // [bone_ref_list.length]
+	int *object_parents; // [object_ref_list.length]
 };
 
-struct mainline_key mainline_key_create(int id);
+struct mainline_key mainline_key_create(int id, int time, struct arena *arena);
 void mainline_key_destroy(struct mainline_key *mainline_key);
+void mainline_key_order_bones(struct mainline_key *mainline_key, struct bone_order_scratch *scratch);
+int mainline_key_bone_ref_at(struct mainline_key *mainline_key, int position);
+int mainline_key_bone_parent(struct mainline_key *mainline_key, int position);
+int mainline_key_object_parent(struct mainline_key *mainline_key, int object_ref);
 
 ////////////////////////////////////////////////////////////////////////////////
 // Mainline key list
 ////////////////////////////////////////////////////////////////////////////////
 struct mainline_key_list {
 	int length;
+	int capacity;
 	struct mainline_key *items;
+	struct arena *arena;
 };
 
-struct mainline_key_list mainline_key_list_create();
+struct mainline_key_list mainline_key_list_create(struct arena *arena);
 void mainline_key_list_destroy(struct mainline_key_list *mainline_key_list);
 void mainline_key_list_append(struct mainline_key_list *mainline_key_list, struct mainline_key mainline_key);
+void mainline_key_list_reserve(struct mainline_key_list *mainline_key_list, int capacity);
+void mainline_key_list_shrink_to_fit(struct mainline_key_list *mainline_key_list);
 struct mainline_key* mainline_key_list_top(struct mainline_key_list *mainline_key_list);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -152,7 +206,7 @@ struct mainline {
 	struct mainline_key_list mainline_key_list;
 };
 
-struct mainline mainline_create();
+struct mainline mainline_create(struct arena *arena);
 void mainline_destroy(struct mainline *mainline);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -162,12 +216,15 @@ void mainline_destroy(struct mainline *mainline);
 struct object {
 	int folder;
 	int file;
+	float x;
+	float y;
 	float angle;
 	float scale_x;
 	float scale_y;
+	float a;
 };
 
-struct object object_create(int folder, int file, float angle, float scale_x, float scale_y);
+struct object object_create(int folder, int file, float x, float y, float angle, float scale_x, float scale_y, float a);
 void object_destroy(struct object *object);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -175,12 +232,16 @@ void object_destroy(struct object *object);
 ////////////////////////////////////////////////////////////////////////////////
 struct object_list {
 	int length;
+	int capacity;
 	struct object *items;
+	struct arena *arena;
 };
 
-struct object_list object_list_create();
+struct object_list object_list_create(struct arena *arena);
 void object_list_destroy(struct object_list *object_list);
 void object_list_append(struct object_list *object_list, struct object object);
+void object_list_reserve(struct object_list *object_list, int capacity);
+void object_list_shrink_to_fit(struct object_list *object_list);
 struct object* object_list_top(struct object_list *object_list);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -204,12 +265,16 @@ void bone_destroy(struct bone *bone);
 ////////////////////////////////////////////////////////////////////////////////
 struct bone_list {
 	int length;
+	int capacity;
 	struct bone *items;
+	struct arena *arena;
 };
 
-struct bone_list bone_list_create();
+struct bone_list bone_list_create(struct arena *arena);
 void bone_list_destroy(struct bone_list *bone_list);
 void bone_list_append(struct bone_list *bone_list, struct bone bone);
+void bone_list_reserve(struct bone_list *bone_list, int capacity);
+void bone_list_shrink_to_fit(struct bone_list *bone_list);
 struct bone* bone_list_top(struct bone_list *bone_list);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -223,7 +288,7 @@ struct timeline_key {
 	struct bone_list bone_list;
 };
 
-struct timeline_key timeline_key_create(int id, int time, int spin);
+struct timeline_key timeline_key_create(int id, int time, int spin, struct arena *arena);
 void timeline_key_destroy(struct timeline_key *timeline_key);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -231,12 +296,16 @@ void timeline_key_destroy(struct timeline_key *timeline_key);
 ////////////////////////////////////////////////////////////////////////////////
 struct timeline_key_list {
 	int length;
+	int capacity;
 	struct timeline_key *items;
+	struct arena *arena;
 };
 
-struct timeline_key_list timeline_key_list_create();
+struct timeline_key_list timeline_key_list_create(struct arena *arena);
 void timeline_key_list_destroy(struct timeline_key_list *timeline_key_list);
 void timeline_key_list_append(struct timeline_key_list *timeline_key_list, struct timeline_key timeline_key);
+void timeline_key_list_reserve(struct timeline_key_list *timeline_key_list, int capacity);
+void timeline_key_list_shrink_to_fit(struct timeline_key_list *timeline_key_list);
 struct timeline_key* timeline_key_list_top(struct timeline_key_list *timeline_key_list);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -248,9 +317,26 @@ struct timeline {
 	struct timeline_key_list timeline_key_list;
 };
 
-struct timeline timeline_create(int id, struct string name);
+struct timeline timeline_create(int id, struct string name, struct arena *arena);
 void timeline_destroy(struct timeline *timeline);
 
+////////////////////////////////////////////////////////////////////////////////
+// Timeline list
+////////////////////////////////////////////////////////////////////////////////
+struct timeline_list {
+	int length;
+	int capacity;
+	struct timeline *items;
+	struct arena *arena;
+};
+
+struct timeline_list timeline_list_create(struct arena *arena);
+void timeline_list_destroy(struct timeline_list *timeline_list);
+void timeline_list_append(struct timeline_list *timeline_list, struct timeline timeline);
+void timeline_list_reserve(struct timeline_list *timeline_list, int capacity);
+void timeline_list_shrink_to_fit(struct timeline_list *timeline_list);
+struct timeline* timeline_list_top(struct timeline_list *timeline_list);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Animation
 ////////////////////////////////////////////////////////////////////////////////
@@ -260,12 +346,13 @@ struct animation {
 	struct string name;
 	int length;
 	int interval;
+	bool looping; // otherwise playback holds the last frame
 	
 	struct mainline mainline;
-	struct timeline timeline;
+	struct timeline_list timeline_list;
 };
 
-struct animation animation_create(int id, struct string name, int length, int interval);
+struct animation animation_create(int id, struct string name, int length, int interval, bool looping, struct arena *arena);
 void animation_destroy(struct animation *animation);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -273,12 +360,16 @@ void animation_destroy(struct animation *animation);
 ////////////////////////////////////////////////////////////////////////////////
 struct animation_list {
 	int length;
+	int capacity;
 	struct animation *items;
+	struct arena *arena;
 };
 
-struct animation_list animation_list_create();
+struct animation_list animation_list_create(struct arena *arena);
 void animation_list_destroy(struct animation_list *animation_list);
 void animation_list_append(struct animation_list *animation_list, struct animation animation);
+void animation_list_reserve(struct animation_list *animation_list, int capacity);
+void animation_list_shrink_to_fit(struct animation_list *animation_list);
 struct animation* animation_list_top(struct animation_list *animation_list);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -290,7 +381,7 @@ struct entity {
 	struct animation_list animation_list;
 };
 
-struct entity entity_create(int id, struct string name);
+struct entity entity_create(int id, struct string name, struct arena *arena);
 void entity_destroy(struct entity *entity);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -298,12 +389,16 @@ void entity_destroy(struct entity *entity);
 ////////////////////////////////////////////////////////////////////////////////
 struct entity_list {
 	int length;
+	int capacity;
 	struct entity *items;
+	struct arena *arena;
 };
 
-struct entity_list entity_list_create();
+struct entity_list entity_list_create(struct arena *arena);
 void entity_list_destroy(struct entity_list *entity_list);
 void entity_list_append(struct entity_list *entity_list, struct entity entity);
+void entity_list_reserve(struct entity_list *entity_list, int capacity);
+void entity_list_shrink_to_fit(struct entity_list *entity_list);
 struct entity* entity_list_top(struct entity_list *entity_list);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -317,12 +412,123 @@ struct spriter_data {
 	
 	struct folder_list folder_list;
 	struct entity_list entity_list;
+	
+	struct arena *arena; // when set, spriter_data_destroy is a no-op and the arena owns everything
 };
 
-struct spriter_data spriter_data_create();
+struct spriter_data spriter_data_create(struct arena *arena);
 void spriter_data_destroy(struct spriter_data *spriter_data);
+void spriter_data_order_bones(struct spriter_data *spriter_data);
+size_t spriter_data_memory(struct spriter_data *spriter_data);
+
+////////////////////////////////////////////////////////////////////////////////
+// Attribute slots
+////////////////////////////////////////////////////////////////////////////////
+// The attributes of one tag, indexed by type. Resetting for a tag type loads
+// the defaults of that tag's schema; only attributes in the schema are valid.
+struct attribute_slots {
+	struct string_view values[attribute_type_count];
+	bool present[attribute_type_count]; // false when the value is the default
+};
+
+void attribute_slots_reset(struct attribute_slots *slots, enum tag_types tag_type);
+void attribute_slots_set(struct attribute_slots *slots, enum attribute_types attribute_type, struct string_view value);
+void attribute_slots_validate(struct attribute_slots *slots, enum tag_types tag_type);
+bool attribute_slots_has(struct attribute_slots *slots, enum attribute_types attribute_type);
+int attribute_slots_int(struct attribute_slots *slots, enum attribute_types attribute_type);
+float attribute_slots_float(struct attribute_slots *slots, enum attribute_types attribute_type);
+void attribute_slots_floats(struct attribute_slots *slots, const enum attribute_types *attribute_types, float *values, int count);
+bool attribute_slots_bool(struct attribute_slots *slots, enum attribute_types attribute_type);
+struct string attribute_slots_string(struct attribute_slots *slots, enum attribute_types attribute_type, struct arena *arena);
+
+////////////////////////////////////////////////////////////////////////////////
+// Parse stats
+////////////////////////////////////////////////////////////////////////////////
+// Where a load went. The *_with_stats procedures add to a parse_stats; the
+// others, or a NULL parse_stats, cost nothing and print nothing. Defining
+// SPRITER_STATS as 0 compiles the hooks out.
+#ifndef SPRITER_STATS
+#define SPRITER_STATS 1
+#endif
+
+// Receives every tag before it is built.
+typedef void (*parse_trace_sink)(void *user_data, enum tag_types tag_type);
+
+struct parse_stats {
+	long tag_counts[tag_type_count]; // tags built, by type
+	long tag_count;
+	long bytes_tokenized;
+	long allocations; // memory_alloc and growing memory_realloc calls
+	long bytes_allocated;
+	
+	double total_seconds;
+	bool time_phases; // splits total_seconds below; reads the clock twice per tag
+	double tokenize_seconds;
+	double build_seconds;
+	
+	parse_trace_sink trace;
+	void *trace_user_data;
+};
+
+struct parse_stats parse_stats_create(void);
+void parse_stats_print(struct parse_stats *stats, FILE *file);
+void parse_trace_print(void *user_data, enum tag_types tag_type);
+
+////////////////////////////////////////////////////////////////////////////////
+// Builder
+////////////////////////////////////////////////////////////////////////////////
+// Consumes xml_handler events and assembles a spriter_data from them. A tag is
+// built only where Spriter puts it, judged by the tags it is opened in; any
+// other tag is skipped together with everything inside it, so the keys of a
+// <varline> or the objects of a <soundline> never reach the timelines.
+#define SCML_BUILDER_MAX_DEPTH 16
+
+struct scml_builder {
+	struct spriter_data spriter_data;
+	struct arena *arena;
+	
+	enum tag_types tag_type;           // of the tag being opened
+	bool building;                     // whether the tag being opened is built
+	struct attribute_slots attributes; // of the tag being opened
+	
+	enum tag_types open_tags[SCML_BUILDER_MAX_DEPTH]; // outermost first, tag_type_unknown when skipped
+	int depth; // open tags, including any past SCML_BUILDER_MAX_DEPTH
+	
+	struct bone_order_scratch bone_order; // for each mainline key as it closes
+	
+	struct parse_stats *stats; // NULL unless the load is measured
+};
+
+struct scml_builder scml_builder_create(struct arena *arena);
+void scml_builder_destroy(struct scml_builder *builder);
+void scml_builder_enter(struct scml_builder *builder, enum tag_types tag_type);
+void scml_builder_leave(struct scml_builder *builder);
+void scml_builder_finish(struct scml_builder *builder);
+void scml_builder_on_open_tag(void *user_data, enum tag_types tag_type, struct string_view identifier);
+void scml_builder_on_attribute(void *user_data, enum attribute_types attribute_type, struct string_view name, struct string_view value);
+void scml_builder_on_open_tag_end(void *user_data);
+void scml_builder_on_close_tag(void *user_data, enum tag_types tag_type, struct string_view identifier);
+struct xml_handler scml_builder_handler(struct scml_builder *builder);
+
+////////////////////////////////////////////////////////////////////////////////
+// Push parser
+////////////////////////////////////////////////////////////////////////////////
+// Builds a spriter_data from chunks fed in order, see xml_push_parser.
+struct spriter_push_parser {
+	struct scml_builder builder;
+	struct xml_push_parser xml;
+};
+
+struct spriter_push_parser spriter_push_parser_create(struct arena *arena);
+void spriter_push_parser_feed(struct spriter_push_parser *parser, const char *data, int length);
+struct spriter_data spriter_push_parser_finish(struct spriter_push_parser *parser, bool *complete);
 
 ///////////////////////////////////////////////////////////////////////////////
 // Procedures
 ///////////////////////////////////////////////////////////////////////////////
-struct spriter_data parse_tags(struct tag_list tags);
\ No newline at end of file
+struct spriter_data parse_tags(struct tag_list tags, struct arena *arena);
+struct spriter_data parse_spriter_buffer(const char *buffer, int length, struct arena *arena);
+struct spriter_data parse_spriter_file(char *filepath, struct arena *arena);
+struct spriter_data parse_tags_with_stats(struct tag_list tags, struct arena *arena, struct parse_stats *stats);
+struct spriter_data parse_spriter_buffer_with_stats(const char *buffer, int length, struct arena *arena, struct parse_stats *stats);
+struct spriter_data parse_spriter_file_with_stats(char *filepath, struct arena *arena, struct parse_stats *stats);
\ No newline at end of file
@@ -10,6 +10,18 @@ struct string string_create(const char *content) {
 	return str;
 }
 
+struct string string_create_length(const char *content, int length) {
+	assert(content != NULL || length == 0);
+	assert(length >= 0);
+	
+	struct string str;
+	str.characters = calloc(length + 1, sizeof(char));
+	if (length > 0) {
+		memcpy(str.characters, content, length);
+	}
+	return str;
+}
+
 void string_destroy(struct string *str) {
 	assert(str != NULL);
 	assert(str->characters != NULL);
@@ -92,24 +104,233 @@ void string_copy(struct string *dest_str, struct string *src_str) {
 	dest_str->characters[string_length(src_str)] = '\0';
 }
 
-int string_to_int(struct string *str) {
+void string_reset(struct string *str) {
 	assert(str != NULL);
 	assert(str->characters != NULL);
 	
-	return atoi(str->characters);
+	memset(str, 0, sizeof(struct string));
+	str->characters = NULL;
 }
 
-float string_to_float(struct string *str) {
-	assert(str != NULL);
-	assert(str->characters != NULL);
+
+////////////////////////////////////////////////////////////////////////////////
+// String view
+////////////////////////////////////////////////////////////////////////////////
+struct string_view string_view_create(const char *characters, int length) {
+	assert(characters != NULL || length == 0);
+	assert(length >= 0);
 	
-	return atof(str->characters);
+	struct string_view view;
+	view.characters = characters;
+	view.length = length;
+	return view;
 }
 
-void string_reset(struct string *str) {
+struct string_view string_view_from_string(struct string *str) {
 	assert(str != NULL);
 	assert(str->characters != NULL);
 	
-	memset(str, 0, sizeof(struct string));
-	str->characters = NULL;
+	return string_view_create(str->characters, strlen(str->characters));
 }
+
+// Strings taken from an arena are released with it and must not be passed to
+// string_destroy.
+struct string string_create_from_view(struct string_view view, struct arena *arena) {
+	struct string str;
+	str.characters = memory_alloc(arena, view.length + 1); // zeroed, so terminated
+	assert(str.characters != NULL);
+	if (view.length > 0) {
+		memcpy(str.characters, view.characters, view.length);
+	}
+	return str;
+}
+
+bool string_view_compare(struct string_view view, const char *char_array) {
+	assert(char_array != NULL);
+	
+	return (strncmp(view.characters, char_array, view.length) == 0) && (char_array[view.length] == '\0');
+}
+
+void string_view_print(struct string_view view) {
+	printf("\"%.*s\"\r\n", view.length, view.characters);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Numbers
+////////////////////////////////////////////////////////////////////////////////
+// SCML numbers are plain decimals such as "-12.345678", read straight from the
+// span without the C locale. A float is exact or correctly rounded: the
+// digits are gathered into a 64-bit integer and scaled by an exact power of
+// ten in double precision, which is correctly rounded. Narrowing that double
+// rounds a second time, which can only go wrong when the double lies exactly
+// halfway between two floats; that case is settled with integers. Anything
+// else, such as more than 19 digits, is left to strtof.
+#define STRING_NUMBER_CAPACITY 64
+#define STRING_NUMBER_MAX_DIGITS 19
+
+static const double string_powers_of_ten[23] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static bool string_is_space(char c) {
+	return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == '\f') || (c == '\v');
+}
+
+static bool string_is_digit(char c) {
+	return (c >= '0') && (c <= '9');
+}
+
+// Like atoi, but values past the range of int saturate.
+int string_to_int(struct string_view view) {
+	const char *c = view.characters;
+	const char *end = c + view.length;
+	
+	while ((c < end) && string_is_space(*c)) c++;
+	
+	bool negative = (c < end) && (*c == '-');
+	if ((c < end) && ((*c == '-') || (*c == '+'))) c++;
+	
+	long long value = 0;
+	for (; (c < end) && string_is_digit(*c); c++) {
+		value = value * 10 + (*c - '0');
+		if (value > (long long)INT_MAX + 1) value = (long long)INT_MAX + 1;
+	}
+	
+	if (negative) value = -value;
+	if (value > INT_MAX) value = INT_MAX;
+	return (int)value;
+}
+
+// The locale's decimal point replaces the '.' so that strtof reads SCML under
+// any locale.
+static float string_to_float_slow(struct string_view view) {
+	char terminated[STRING_NUMBER_CAPACITY];
+	
+	int length = view.length < STRING_NUMBER_CAPACITY ? view.length : STRING_NUMBER_CAPACITY - 1;
+	memcpy(terminated, view.characters, length);
+	terminated[length] = '\0';
+	
+	char decimal_point = localeconv()->decimal_point[0];
+	char *dot = memchr(terminated, '.', length);
+	if (dot != NULL) *dot = decimal_point;
+	
+	return strtof(terminated, NULL);
+}
+
+// Whether `mantissa / 10^exponent`, whose nearest double is `rounded`, lies
+// below (-1), at (0) or above (1) it. `rounded` is a float midpoint, so its
+// significand has at most 25 bits.
+static int string_compare_quotient(uint64_t mantissa, int exponent, double rounded) {
+	uint64_t bits;
+	memcpy(&bits, &rounded, sizeof(bits));
+	
+	// rounded = significand * 2^binary_exponent
+	uint64_t significand = ((bits & (((uint64_t)1 << 52) - 1)) | ((uint64_t)1 << 52)) >> 28;
+	int binary_exponent = (int)((bits >> 52) & 0x7FF) - 1075 + 28;
+	
+	// mantissa / (5^exponent * 2^exponent) against significand * 2^binary_exponent,
+	// so mantissa against significand * 5^exponent * 2^shift.
+	uint64_t scaled = significand;
+	for (int i = 0; i < exponent; i++) {
+		scaled *= 5;
+	}
+	
+	int shift = exponent + binary_exponent;
+	uint64_t left = (shift < 0) ? mantissa << -shift : mantissa;
+	uint64_t right = (shift > 0) ? scaled << shift : scaled;
+	
+	if (left < right) return -1;
+	return (left > right) ? 1 : 0;
+}
+
+float string_to_float(struct string_view view) {
+	const char *c = view.characters;
+	const char *end = c + view.length;
+	
+	while ((c < end) && string_is_space(*c)) c++;
+	
+	bool negative = (c < end) && (*c == '-');
+	if ((c < end) && ((*c == '-') || (*c == '+'))) c++;
+	
+	uint64_t mantissa = 0;
+	int digit_count = 0; // significant ones
+	int exponent = 0;
+	bool has_digits = false;
+	
+	for (; (c < end) && string_is_digit(*c); c++) {
+		has_digits = true;
+		if ((mantissa == 0) && (*c == '0')) continue;
+		if (digit_count++ == STRING_NUMBER_MAX_DIGITS) return string_to_float_slow(view);
+		mantissa = mantissa * 10 + (*c - '0');
+	}
+	
+	if ((c < end) && (*c == '.')) {
+		for (c++; (c < end) && string_is_digit(*c); c++) {
+			has_digits = true;
+			exponent--;
+			if ((mantissa == 0) && (*c == '0')) continue;
+			if (digit_count++ == STRING_NUMBER_MAX_DIGITS) return string_to_float_slow(view);
+			mantissa = mantissa * 10 + (*c - '0');
+		}
+	}
+	
+	if (!has_digits) return string_to_float_slow(view); // "inf", "nan" or no number
+	
+	if ((c < end) && ((*c == 'e') || (*c == 'E'))) {
+		const char *e = c + 1;
+		bool exponent_negative = (e < end) && (*e == '-');
+		if ((e < end) && ((*e == '-') || (*e == '+'))) e++;
+		
+		if ((e < end) && string_is_digit(*e)) {
+			int written = 0;
+			for (; (e < end) && string_is_digit(*e); e++) {
+				if (written < 10000) written = written * 10 + (*e - '0');
+			}
+			exponent += exponent_negative ? -written : written;
+		}
+	}
+	
+	float value;
+	if (mantissa == 0) {
+		value = 0.0f;
+	} else if ((exponent >= 0) && (exponent <= STRING_NUMBER_MAX_DIGITS) && (mantissa <= UINT64_MAX / (uint64_t)string_powers_of_ten[exponent])) {
+		value = (float)(mantissa * (uint64_t)string_powers_of_ten[exponent]); // one rounding
+	} else if ((exponent < 0) && (exponent >= -22) && (mantissa <= ((uint64_t)1 << 53))) {
+		double rounded = (double)mantissa / string_powers_of_ten[-exponent];
+		if ((rounded < FLT_MIN) || (rounded > FLT_MAX)) return string_to_float_slow(view);
+		
+		uint64_t bits;
+		memcpy(&bits, &rounded, sizeof(bits));
+		if ((bits & 0x1FFFFFFF) == 0x10000000) { // halfway between two floats
+			if (-exponent > 13) return string_to_float_slow(view); // 5^exponent overflows
+			
+			int side = string_compare_quotient(mantissa, -exponent, rounded);
+			bits += side;
+			memcpy(&rounded, &bits, sizeof(bits));
+		}
+		
+		value = (float)rounded;
+	} else {
+		return string_to_float_slow(view);
+	}
+	
+	return negative ? -value : value;
+}
+
+// Converts `count` spans at once, as for the numeric attributes of one tag.
+void string_to_floats(const struct string_view *views, float *values, int count) {
+	assert((views != NULL && values != NULL) || (count == 0));
+	
+	for (int i = 0; i < count; i++) {
+		values[i] = string_to_float(views[i]);
+	}
+}
+
+void string_to_ints(const struct string_view *views, int *values, int count) {
+	assert((views != NULL && values != NULL) || (count == 0));
+	
+	for (int i = 0; i < count; i++) {
+		values[i] = string_to_int(views[i]);
+	}
+}
\ No newline at end of file
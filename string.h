@@ -1,7 +1,13 @@
 #pragma once
 
+#include "arena.h"
+
 #include <assert.h>
+#include <float.h>
+#include <limits.h>
+#include <locale.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,6 +20,7 @@ struct string {
 };
 
 struct string string_create(const char *content);
+struct string string_create_length(const char *content, int length);
 void string_destroy(struct string *str);
 int string_length(struct string *str);
 char string_at(struct string *str, int index);
@@ -23,6 +30,26 @@ void string_print(struct string *str);
 void string_print_raw(struct string *str);
 bool string_compare(struct string *str, const char *char_array);
 void string_copy(struct string *dest_str, struct string *src_str);
-int string_to_int(struct string *str);
-float string_to_float(struct string *str);
-void string_reset(struct string *str);
\ No newline at end of file
+void string_reset(struct string *str);
+
+////////////////////////////////////////////////////////////////////////////////
+// String view
+////////////////////////////////////////////////////////////////////////////////
+struct string_view {
+	const char *characters; // not null-terminated
+	int length;
+};
+
+struct string_view string_view_create(const char *characters, int length);
+struct string_view string_view_from_string(struct string *str);
+struct string string_create_from_view(struct string_view view, struct arena *arena);
+bool string_view_compare(struct string_view view, const char *char_array);
+void string_view_print(struct string_view view);
+
+////////////////////////////////////////////////////////////////////////////////
+// Numbers
+////////////////////////////////////////////////////////////////////////////////
+int string_to_int(struct string_view view);
+float string_to_float(struct string_view view);
+void string_to_ints(const struct string_view *views, int *values, int count);
+void string_to_floats(const struct string_view *views, float *values, int count);
\ No newline at end of file
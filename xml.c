@@ -1,13 +1,108 @@
 #include "xml.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 // 								XML
 ////////////////////////////////////////////////////////////////////////////////
 
+////////////////////////////////////////////////////////////////////////////////
+// Mapped file
+////////////////////////////////////////////////////////////////////////////////
+struct mapped_file mapped_file_open(const char *filepath) {
+	assert(filepath != NULL);
+	
+	struct mapped_file mapped_file;
+	mapped_file.data = NULL;
+	mapped_file.length = 0;
+	mapped_file.is_open = false;
+	mapped_file.is_mapped = false;
+
+#ifndef _WIN32
+	int fd = open(filepath, O_RDONLY);
+	if (fd < 0) {
+		return mapped_file;
+	}
+	
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+		void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED) {
+			mapped_file.data = data;
+			mapped_file.length = info.st_size;
+			mapped_file.is_open = true;
+			mapped_file.is_mapped = true;
+		}
+	}
+	
+	close(fd);
+	
+	if (mapped_file.is_open) {
+		return mapped_file;
+	}
+#endif
+
+	// Not mappable (empty file, pipe, no mmap): fall back to one bulk read.
+	FILE *f = fopen(filepath, "rb");
+	if (f == NULL) {
+		return mapped_file;
+	}
+	
+	int capacity = 64 * 1024;
+	mapped_file.data = malloc(capacity);
+	
+	size_t read_count;
+	while ((read_count = fread(mapped_file.data + mapped_file.length, 1, capacity - mapped_file.length, f)) > 0) {
+		mapped_file.length += read_count;
+		if (mapped_file.length == capacity) {
+			capacity *= 2;
+			mapped_file.data = realloc(mapped_file.data, capacity);
+		}
+	}
+	
+	fclose(f);
+	
+	mapped_file.is_open = true;
+	return mapped_file;
+}
+
+void mapped_file_close(struct mapped_file *mapped_file) {
+	assert(mapped_file != NULL);
+	
+	if (!mapped_file->is_open) return;
+
+#ifndef _WIN32
+	if (mapped_file->is_mapped) {
+		munmap(mapped_file->data, mapped_file->length);
+	} else {
+		free(mapped_file->data);
+	}
+#else
+	free(mapped_file->data);
+#endif
+
+	mapped_file->data = NULL;
+	mapped_file->length = 0;
+	mapped_file->is_open = false;
+	mapped_file->is_mapped = false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Value
 ////////////////////////////////////////////////////////////////////////////////
-struct value value_create(struct string text) {
+struct value value_create(struct string_view text) {
 	struct value value;
 	value.text = text;
 	return value;
@@ -15,23 +110,90 @@ struct value value_create(struct string text) {
 
 void value_destroy(struct value *value) {
 	assert(value != NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Attribute type
+////////////////////////////////////////////////////////////////////////////////
+struct attribute_type_entry {
+	const char *text;
+	int length;
+	enum attribute_types type;
+};
+
+// Perfect hash over the attribute names, built the same way as the tag type
+// table below.
+#define ATTRIBUTE_TYPE_TABLE_SIZE 128
+
+static const struct attribute_type_entry attribute_type_table[ATTRIBUTE_TYPE_TABLE_SIZE] = {
+	[0] = { "file", 4, attribute_type_file },
+	[2] = { "parent", 6, attribute_type_parent },
+	[3] = { "spin", 4, attribute_type_spin },
+	[10] = { "height", 6, attribute_type_height },
+	[14] = { "time", 4, attribute_type_time },
+	[16] = { "angle", 5, attribute_type_angle },
+	[18] = { "timeline", 8, attribute_type_timeline },
+	[19] = { "c1", 2, attribute_type_c1 },
+	[22] = { "length", 6, attribute_type_length },
+	[28] = { "folder", 6, attribute_type_folder },
+	[30] = { "w", 1, attribute_type_w },
+	[33] = { "c2", 2, attribute_type_c2 },
+	[41] = { "x", 1, attribute_type_x },
+	[43] = { "encoding", 8, attribute_type_encoding },
+	[44] = { "a", 1, attribute_type_a },
+	[45] = { "z_index", 7, attribute_type_z_index },
+	[47] = { "c3", 2, attribute_type_c3 },
+	[48] = { "width", 5, attribute_type_width },
+	[51] = { "curve_type", 10, attribute_type_curve_type },
+	[52] = { "y", 1, attribute_type_y },
+	[53] = { "looping", 7, attribute_type_looping },
+	[54] = { "scale_x", 7, attribute_type_scale_x },
+	[60] = { "key", 3, attribute_type_key },
+	[61] = { "c4", 2, attribute_type_c4 },
+	[64] = { "scale_y", 7, attribute_type_scale_y },
+	[75] = { "pivot_x", 7, attribute_type_pivot_x },
+	[85] = { "pivot_y", 7, attribute_type_pivot_y },
+	[87] = { "scml_version", 12, attribute_type_scml_version },
+	[88] = { "generator_version", 17, attribute_type_generator_version },
+	[93] = { "version", 7, attribute_type_version },
+	[97] = { "interval", 8, attribute_type_interval },
+	[99] = { "id", 2, attribute_type_id },
+	[104] = { "name", 4, attribute_type_name },
+	[116] = { "object_type", 11, attribute_type_object_type },
+	[120] = { "generator", 9, attribute_type_generator },
+	[121] = { "h", 1, attribute_type_h },
+};
+
+static unsigned int attribute_type_hash(struct string_view name) {
+	const unsigned char *c = (const unsigned char *)name.characters;
+	unsigned int second = (name.length > 1) ? c[1] : 0;
 	
-	string_destroy(&value->text);
+	return (c[0] + second * 4 + c[name.length - 1] * 10 + name.length) & (ATTRIBUTE_TYPE_TABLE_SIZE - 1);
+}
+
+enum attribute_types attribute_type_from_name(struct string_view name) {
+	if (name.length == 0) return attribute_type_unknown;
+	
+	const struct attribute_type_entry *entry = &attribute_type_table[attribute_type_hash(name)];
+	
+	if ((entry->length == name.length) && (memcmp(entry->text, name.characters, name.length) == 0)) {
+		return entry->type;
+	}
+	return attribute_type_unknown;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Name
 ////////////////////////////////////////////////////////////////////////////////
-struct name name_create(struct string text) {
+struct name name_create(struct string_view text, enum attribute_types type) {
 	struct name name;
 	name.text = text;
+	name.type = type;
 	return name;
 }
 
 void name_destroy(struct name *name) {
 	assert(name != NULL);
-	
-	string_destroy(&name->text);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,30 +222,46 @@ void attribute_reset(struct attribute *attr) {
 ////////////////////////////////////////////////////////////////////////////////
 // Attribute list
 ////////////////////////////////////////////////////////////////////////////////
-struct attribute_list attribute_list_create() {
+struct attribute_list attribute_list_create(struct arena *arena) {
 	struct attribute_list attribute_list;
 	attribute_list.length = 0;
+	attribute_list.capacity = 0;
 	attribute_list.items = NULL;
+	attribute_list.arena = arena;
 	return attribute_list;
 }
 
 void attribute_list_destroy(struct attribute_list *attr_list) {
 	assert(attr_list != NULL);
 	
+	if (attr_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < attr_list->length; i++) {
 		struct attribute attr = attr_list->items[i];
 		attribute_destroy(&attr);
 	}
 	
-	free(attr_list->items);
+	memory_free(attr_list->arena, attr_list->items);
 }
 
 void attribute_list_append(struct attribute_list *attr_list, struct attribute attr) {
 	assert(attr_list != NULL);
 	
+	attr_list->items = array_grow(attr_list->items, attr_list->length, &attr_list->capacity, sizeof(struct attribute), attr_list->arena);
+	attr_list->items[attr_list->length] = attr;
 	attr_list->length++;
-	attr_list->items = realloc(attr_list->items, sizeof(struct attribute) * attr_list->length);
-	attr_list->items[attr_list->length - 1] = attr;
+}
+
+void attribute_list_reserve(struct attribute_list *attr_list, int capacity) {
+	assert(attr_list != NULL);
+	
+	attr_list->items = array_reserve(attr_list->items, attr_list->length, &attr_list->capacity, capacity, sizeof(struct attribute), attr_list->arena);
+}
+
+void attribute_list_shrink_to_fit(struct attribute_list *attr_list) {
+	assert(attr_list != NULL);
+	
+	attr_list->items = array_shrink_to_fit(attr_list->items, attr_list->length, &attr_list->capacity, sizeof(struct attribute), attr_list->arena);
 }
 
 struct attribute attribute_list_find_by_name(struct attribute_list *attr_list, const char *name) {
@@ -95,7 +273,7 @@ struct attribute attribute_list_find_by_name(struct attribute_list *attr_list, c
 	
 	for (int i = 0; i < attr_list->length; i++) {
 		struct attribute curr_attr = attr_list->items[i];
-		if (string_compare(&curr_attr.name.text, name)) {
+		if (string_view_compare(curr_attr.name.text, name)) {
 			attr = curr_attr;
 			attribute_found = true;
 			break;
@@ -115,7 +293,7 @@ bool attribute_list_contains_name(struct attribute_list *attr_list, const char *
 	
 	for (int i = 0; i < attr_list->length; i++) {
 		struct attribute curr_attr = attr_list->items[i];
-		if (string_compare(&curr_attr.name.text, name)) {
+		if (string_view_compare(curr_attr.name.text, name)) {
 			attribute_found = true;
 			break;
 		}
@@ -138,19 +316,90 @@ struct attribute attribute_list_at(struct attribute_list *attribute_list, int in
 	return attribute_list->items[index];
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Tag type
+////////////////////////////////////////////////////////////////////////////////
+struct tag_type_entry {
+	const char *text;
+	int length;
+	enum tag_types type;
+};
+
+// Perfect hash over the SCML vocabulary: every word lands in its own slot, so
+// one probe and one compare decide the type. Keep the table in sync with
+// enum tag_types when adding words; a collision means re-picking the factors.
+#define TAG_TYPE_TABLE_SIZE 64
+
+static const struct tag_type_entry tag_type_table[TAG_TYPE_TABLE_SIZE] = {
+	[0] = { "map", 3, tag_type_map },
+	[1] = { "spriter_data", 12, tag_type_spriter_data },
+	[5] = { "valline", 7, tag_type_valline },
+	[8] = { "var_defs", 8, tag_type_var_defs },
+	[11] = { "object", 6, tag_type_object },
+	[13] = { "tag_list", 8, tag_type_tag_list },
+	[14] = { "i", 1, tag_type_i },
+	[15] = { "varline", 7, tag_type_varline },
+	[16] = { "tagline", 7, tag_type_tagline },
+	[17] = { "animation", 9, tag_type_animation },
+	[19] = { "soundline", 9, tag_type_soundline },
+	[20] = { "tag", 3, tag_type_tag },
+	[21] = { "eventline", 9, tag_type_eventline },
+	[23] = { "object_ref", 10, tag_type_object_ref },
+	[27] = { "timeline", 8, tag_type_timeline },
+	[28] = { "bone", 4, tag_type_bone },
+	[31] = { "xml", 3, tag_type_xml },
+	[33] = { "meta", 4, tag_type_meta },
+	[36] = { "bone_ref", 8, tag_type_bone_ref },
+	[38] = { "atlas", 5, tag_type_atlas },
+	[39] = { "character_map", 13, tag_type_character_map },
+	[40] = { "folder", 6, tag_type_folder },
+	[47] = { "frames", 6, tag_type_frames },
+	[49] = { "key", 3, tag_type_key },
+	[50] = { "file", 4, tag_type_file },
+	[56] = { "mainline", 8, tag_type_mainline },
+	[57] = { "obj_info", 8, tag_type_obj_info },
+	[59] = { "entity", 6, tag_type_entity },
+};
+
+static unsigned int tag_type_hash(struct string_view identifier) {
+	const unsigned char *c = (const unsigned char *)identifier.characters;
+	unsigned int third = (identifier.length > 2) ? c[2] : 0;
+	
+	return (c[0] + third * 23 + c[identifier.length - 1] * 4 + identifier.length) & (TAG_TYPE_TABLE_SIZE - 1);
+}
+
+enum tag_types tag_type_from_identifier(struct string_view identifier) {
+	if (identifier.length == 0) return tag_type_unknown;
+	
+	const struct tag_type_entry *entry = &tag_type_table[tag_type_hash(identifier)];
+	
+	if ((entry->length == identifier.length) && (memcmp(entry->text, identifier.characters, identifier.length) == 0)) {
+		return entry->type;
+	}
+	return tag_type_unknown;
+}
+
+const char *tag_type_name(enum tag_types tag_type) {
+	for (int i = 0; i < TAG_TYPE_TABLE_SIZE; i++) {
+		if ((tag_type_table[i].text != NULL) && (tag_type_table[i].type == tag_type)) {
+			return tag_type_table[i].text;
+		}
+	}
+	return "unknown";
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Identifier
 ////////////////////////////////////////////////////////////////////////////////
-struct identifier identifier_create(struct string text) {
+struct identifier identifier_create(struct string_view text, enum tag_types type) {
 	struct identifier identifier;
 	identifier.text = text;
+	identifier.type = type;
 	return identifier;
 }
 
 void identifier_destroy(struct identifier *identifier) {
 	assert(identifier != NULL);
-	
-	string_destroy(&identifier->text);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -160,6 +409,7 @@ struct tag tag_create(struct identifier identifier, struct attribute_list attrib
 	struct tag tag;
 	tag.identifier = identifier;
 	tag.attributes = attributes;
+	tag.depth = 0;
 	return tag;
 }
 
@@ -172,30 +422,52 @@ void tag_destroy(struct tag *tag) {
 
 ////////////////////////////////////////////////////////////////////////////////
 // Tag list
-////////////////////////////////////////////////////////////////////////////////s
-struct tag_list tag_list_create() {
+////////////////////////////////////////////////////////////////////////////////
+struct tag_list tag_list_create(struct arena *arena) {
 	struct tag_list tag_list;
 	tag_list.length = 0;
+	tag_list.capacity = 0;
 	tag_list.items = NULL;
+	tag_list.arena = arena;
+	tag_list.source.data = NULL;
+	tag_list.source.length = 0;
+	tag_list.source.is_open = false;
+	tag_list.source.is_mapped = false;
 	return tag_list;
 }
 
 void tag_list_destroy(struct tag_list *tag_list) {
 	assert(tag_list != NULL);
 	
+	mapped_file_close(&tag_list->source);
+	
+	if (tag_list->arena != NULL) return; // released with the arena
+	
 	for (int i = 0; i < tag_list->length; i++) {
 		struct tag tag = tag_list->items[i];
 		tag_destroy(&tag);
 	}
-	free(tag_list->items);
+	memory_free(tag_list->arena, tag_list->items);
 }
 
 void tag_list_append(struct tag_list *tag_list, struct tag tag) {
 	assert(tag_list != NULL);
 	
+	tag_list->items = array_grow(tag_list->items, tag_list->length, &tag_list->capacity, sizeof(struct tag), tag_list->arena);
+	tag_list->items[tag_list->length] = tag;
 	tag_list->length++;
-	tag_list->items = realloc(tag_list->items, sizeof(struct tag) * tag_list->length);
-	tag_list->items[tag_list->length - 1] = tag;
+}
+
+void tag_list_reserve(struct tag_list *tag_list, int capacity) {
+	assert(tag_list != NULL);
+	
+	tag_list->items = array_reserve(tag_list->items, tag_list->length, &tag_list->capacity, capacity, sizeof(struct tag), tag_list->arena);
+}
+
+void tag_list_shrink_to_fit(struct tag_list *tag_list) {
+	assert(tag_list != NULL);
+	
+	tag_list->items = array_shrink_to_fit(tag_list->items, tag_list->length, &tag_list->capacity, sizeof(struct tag), tag_list->arena);
 }
 
 struct tag* tag_list_top(struct tag_list *tag_list) {
@@ -220,177 +492,673 @@ struct tag tag_list_at(struct tag_list *tag_list, int index) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Procedures
+// Structural index
 ////////////////////////////////////////////////////////////////////////////////
-struct attribute_list parse_attributes(struct string line) {
-	struct attribute_list attribute_list = attribute_list_create();
+// The characters that delimit markup, '<', '>', '=' and both quotes, are found
+// 64 bytes at a time as one bit mask per block, like the first stage of
+// simdjson. The tokenizer then jumps from one to the next instead of testing
+// every byte. The kernel building the masks is picked at run time.
+#define STRUCTURAL_BLOCK_SIZE 64
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STRUCTURAL_HAS_AVX2 1
+#else
+#define STRUCTURAL_HAS_AVX2 0
+#endif
+
+typedef uint64_t (*structural_kernel)(const char *block);
+
+#ifndef __SSE2__
+static bool is_structural(char c) {
+	return (c == '<') || (c == '>') || (c == '=') || (c == '"') || (c == '\'');
+}
+
+static uint64_t structural_mask_scalar(const char *block) {
+	uint64_t mask = 0;
+	for (int i = 0; i < STRUCTURAL_BLOCK_SIZE; i++) {
+		if (is_structural(block[i])) mask |= (uint64_t)1 << i;
+	}
+	return mask;
+}
+#endif
+
+#ifdef __SSE2__
+static uint64_t structural_mask_sse2(const char *block) {
+	__m128i less_than = _mm_set1_epi8('<');
+	__m128i greater_than = _mm_set1_epi8('>');
+	__m128i equals = _mm_set1_epi8('=');
+	__m128i double_quote = _mm_set1_epi8('"');
+	__m128i single_quote = _mm_set1_epi8('\'');
 	
-	struct string name_str = string_create("");
-	struct string value_str = string_create("");
+	uint64_t mask = 0;
+	for (int i = 0; i < STRUCTURAL_BLOCK_SIZE; i += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i *)(block + i));
+		__m128i brackets = _mm_or_si128(_mm_cmpeq_epi8(bytes, less_than), _mm_cmpeq_epi8(bytes, greater_than));
+		__m128i quotes = _mm_or_si128(_mm_cmpeq_epi8(bytes, double_quote), _mm_cmpeq_epi8(bytes, single_quote));
+		__m128i hits = _mm_or_si128(_mm_or_si128(brackets, quotes), _mm_cmpeq_epi8(bytes, equals));
+		mask |= (uint64_t)(unsigned int)_mm_movemask_epi8(hits) << i;
+	}
+	return mask;
+}
+#endif
+
+#if STRUCTURAL_HAS_AVX2
+__attribute__((target("avx2")))
+static uint64_t structural_mask_avx2(const char *block) {
+	__m256i less_than = _mm256_set1_epi8('<');
+	__m256i greater_than = _mm256_set1_epi8('>');
+	__m256i equals = _mm256_set1_epi8('=');
+	__m256i double_quote = _mm256_set1_epi8('"');
+	__m256i single_quote = _mm256_set1_epi8('\'');
 	
-	bool past_whitespace = false;
+	uint64_t mask = 0;
+	for (int i = 0; i < STRUCTURAL_BLOCK_SIZE; i += 32) {
+		__m256i bytes = _mm256_loadu_si256((const __m256i *)(block + i));
+		__m256i brackets = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, less_than), _mm256_cmpeq_epi8(bytes, greater_than));
+		__m256i quotes = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, double_quote), _mm256_cmpeq_epi8(bytes, single_quote));
+		__m256i hits = _mm256_or_si256(_mm256_or_si256(brackets, quotes), _mm256_cmpeq_epi8(bytes, equals));
+		mask |= (uint64_t)(unsigned int)_mm256_movemask_epi8(hits) << i;
+	}
+	return mask;
+}
+#endif
+
+static structural_kernel structural_kernel_select(const char **name) {
+#if STRUCTURAL_HAS_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		*name = "avx2";
+		return structural_mask_avx2;
+	}
+#endif
+#ifdef __SSE2__
+	*name = "sse2";
+	return structural_mask_sse2;
+#else
+	*name = "scalar";
+	return structural_mask_scalar;
+#endif
+}
+
+// The kernel parse_buffer_stream runs on this processor.
+const char *structural_kernel_name(void) {
+	const char *name;
+	structural_kernel_select(&name);
+	return name;
+}
+
+static int lowest_bit(uint64_t mask) {
+#ifdef __GNUC__
+	return __builtin_ctzll(mask);
+#else
+	int bit = 0;
+	while ((mask & 1) == 0) {
+		mask >>= 1;
+		bit++;
+	}
+	return bit;
+#endif
+}
+
+// Walks the structural characters of a buffer in order. `mask` holds those of
+// the block at `block` not returned yet.
+struct structural_scanner {
+	const char *buffer;
+	int length;
+	structural_kernel kernel;
+	int block;
+	uint64_t mask;
+};
+
+// The last block is copied to a padded one so kernels always read 64 bytes.
+static uint64_t structural_scanner_load(struct structural_scanner *scanner, int block) {
+	if (block >= scanner->length) return 0;
+	if (block + STRUCTURAL_BLOCK_SIZE <= scanner->length) return scanner->kernel(scanner->buffer + block);
 	
-	bool identifier_skipped = false;
-	bool reading_name = true;
-	bool reading_value = false;
+	char padded[STRUCTURAL_BLOCK_SIZE];
+	memset(padded, 0, sizeof(padded));
+	memcpy(padded, scanner->buffer + block, scanner->length - block);
+	return scanner->kernel(padded);
+}
+
+// Positions the scanner so that the next structural character returned is the
+// first one at or after `position`.
+static void structural_scanner_seek(struct structural_scanner *scanner, int position) {
+	scanner->block = position & ~(STRUCTURAL_BLOCK_SIZE - 1);
+	scanner->mask = structural_scanner_load(scanner, scanner->block) & (~(uint64_t)0 << (position - scanner->block));
+}
+
+static struct structural_scanner structural_scanner_create(const char *buffer, int length) {
+	struct structural_scanner scanner;
+	const char *name;
+	scanner.buffer = buffer;
+	scanner.length = length;
+	scanner.kernel = structural_kernel_select(&name);
+	structural_scanner_seek(&scanner, 0);
+	return scanner;
+}
+
+// Returns the position of the next structural character, or -1 at the end.
+static int structural_scanner_next(struct structural_scanner *scanner) {
+	while (scanner->mask == 0) {
+		scanner->block += STRUCTURAL_BLOCK_SIZE;
+		if (scanner->block >= scanner->length) return -1;
+		scanner->mask = structural_scanner_load(scanner, scanner->block);
+	}
 	
-	bool in_quotes = false;
+	int position = scanner->block + lowest_bit(scanner->mask);
+	scanner->mask &= scanner->mask - 1;
+	return position;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Tokenizer
+////////////////////////////////////////////////////////////////////////////////
+static bool is_whitespace(char c) {
+	return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+// Returns the index just past the '>' that ends the tag starting at `i`,
+// or -1 when the buffer ends first. Quoted '>' characters are skipped.
+static int skip_tag(const char *buffer, int length, int i) {
+	char quote = '\0';
 	
-	for (int i = 0; i < string_length(&line); i++) {
-		char c = string_at(&line, i);
+	for (; i < length; i++) {
+		char c = buffer[i];
 		
-		if (!past_whitespace) {
-			if (c == ' ') {
-				continue;
-			} else {
-				past_whitespace = true;
-			}
+		if (quote != '\0') {
+			if (c == quote) quote = '\0';
+		} else if ((c == '"') || (c == '\'')) {
+			quote = c;
+		} else if (c == '>') {
+			return i + 1;
 		}
-		
-		if (!identifier_skipped) {
-			if (c == ' ') { identifier_skipped = true; }
-			continue;
+	}
+	
+	return -1;
+}
+
+static int skip_comment(const char *buffer, int length, int i) {
+	for (; i + 2 < length; i++) {
+		if ((buffer[i] == '-') && (buffer[i + 1] == '-') && (buffer[i + 2] == '>')) {
+			return i + 3;
 		}
+	}
+	
+	return -1;
+}
+
+// Structural characters of one tag kept for tokenize_tag_indexed: its '=' and
+// quotes. Longer tags go through tokenize_tag.
+#define TAG_STRUCTURAL_CAPACITY 96
+
+static int identifier_end(const char *buffer, int i, int last) {
+	while ((i < last) && !is_whitespace(buffer[i]) && (buffer[i] != '/') && (buffer[i] != '?')) {
+		i++;
+	}
+	return i;
+}
+
+// Emits a closing tag, or the start of an opening one, from the identifier at
+// `buffer[start]`. Returns where the attributes begin, or -1 when the tag was
+// a closing one.
+static int tokenize_identifier(const char *buffer, int start, int last, struct xml_handler *handler, enum tag_types *tag_type, struct string_view *identifier) {
+	int i = start;
+	
+	if (buffer[i] == '/') {
+		i++;
+		int identifier_start = i;
+		while ((i < last) && !is_whitespace(buffer[i])) i++;
 		
-		if (reading_name) {
-			if (c == ' ') continue;
-			
-			if (c == '=') {
-				reading_name = false;
-				reading_value = true;
-			} else {
-				string_append_char(&name_str, c);
-			}
-		} else if (reading_value) {
-			if (c == '"') {
-				in_quotes = !in_quotes;
-				
-				if (!in_quotes) {
-					struct name name = name_create(name_str);
-					struct value value = value_create(value_str);
-					
-					struct attribute attribute = attribute_create(value, name);
-					attribute_list_append(&attribute_list, attribute);
-					
-					name_str = string_create("");
-					value_str = string_create("");
-					
-					reading_name = true;
-					reading_value = false;
-					in_quotes = false;
-				}
-			} else if (in_quotes) {
-				string_append_char(&value_str, c);
-			}
-		} else {
-			continue;
+		if (handler->on_close_tag != NULL) {
+			struct string_view text = string_view_create(buffer + identifier_start, i - identifier_start);
+			handler->on_close_tag(handler->user_data, tag_type_from_identifier(text), text);
 		}
+		return -1;
 	}
 	
-	string_destroy(&name_str);
-	string_destroy(&value_str);
+	if (buffer[i] == '?') i++; // a declaration
 	
-	return attribute_list;
+	int identifier_start = i;
+	i = identifier_end(buffer, i, last);
+	*identifier = string_view_create(buffer + identifier_start, i - identifier_start);
+	*tag_type = tag_type_from_identifier(*identifier);
+	
+	if (handler->on_open_tag != NULL) {
+		handler->on_open_tag(handler->user_data, *tag_type, *identifier);
+	}
+	
+	return i;
+}
+
+static void tokenize_tag_end(const char *buffer, int start, int last, struct xml_handler *handler, enum tag_types tag_type, struct string_view identifier) {
+	if (handler->on_open_tag_end != NULL) {
+		handler->on_open_tag_end(handler->user_data);
+	}
+	
+	bool is_self_closing = (buffer[start] == '?') || (buffer[last - 1] == '/');
+	if (is_self_closing && (handler->on_close_tag != NULL)) {
+		handler->on_close_tag(handler->user_data, tag_type, identifier);
+	}
 }
 
-struct identifier parse_identifier(struct string line) {
-	struct string identifier_str = string_create("");
-	bool whitespace_ended = false;
+// Emits the events for one complete tag: `buffer[start]` follows the '<' and
+// `buffer[end - 1]` is its '>'.
+static void tokenize_tag(const char *buffer, int start, int end, struct xml_handler *handler) {
+	int last = end - 1;
+	
+	enum tag_types tag_type;
+	struct string_view identifier;
+	int i = tokenize_identifier(buffer, start, last, handler, &tag_type, &identifier);
+	if (i < 0) return;
 	
-	for (int i = 0; i < string_length(&line); i++) {
-		char c = string_at(&line, i);
+	while (i < last) {
+		char c = buffer[i];
 		
-		if (!whitespace_ended) {
-			if (c == ' ') {
-				continue;
-			} else {
-				whitespace_ended = true;
-			}
+		if (is_whitespace(c) || (c == '/') || (c == '?')) {
+			i++;
+			continue;
 		}
 		
-		if (c == '<') continue;
-		if (c == '/') continue;
-		if (c == '>') continue;
-		if (c == '?') continue;
-		if (c == ' ') break;
+		int name_start = i;
+		while ((i < last) && (buffer[i] != '=') && !is_whitespace(buffer[i])) {
+			i++;
+		}
+		int name_end = i;
 		
-		string_append_char(&identifier_str, c);
+		while ((i < last) && is_whitespace(buffer[i])) i++;
+		if ((i >= last) || (buffer[i] != '=')) continue; // attribute without a value
+		i++;
+		while ((i < last) && is_whitespace(buffer[i])) i++;
+		if ((i >= last) || ((buffer[i] != '"') && (buffer[i] != '\''))) continue;
+		
+		char quote = buffer[i];
+		int value_start = i + 1;
+		const char *value_end = memchr(buffer + value_start, quote, last - value_start);
+		if (value_end == NULL) break;
+		i = (value_end - buffer) + 1;
+		
+		if (handler->on_attribute != NULL) {
+			struct string_view name = string_view_create(buffer + name_start, name_end - name_start);
+			struct string_view value = string_view_create(buffer + value_start, (value_end - buffer) - value_start);
+			handler->on_attribute(handler->user_data, attribute_type_from_name(name), name, value);
+		}
 	}
 	
-	struct identifier identifier = identifier_create(identifier_str);
-	return identifier;
+	tokenize_tag_end(buffer, start, last, handler, tag_type, identifier);
 }
 
-struct tag parse_tag(struct string line) {
-	struct identifier identifier = parse_identifier(line);
-	struct attribute_list attribute_list = parse_attributes(line);
+// Same events as tokenize_tag, with the attributes read off the structural
+// characters of the tag: every attribute is an '=', an opening quote and a
+// closing one, and its name ends just before the '='. Tags that do not follow
+// that pattern are left to tokenize_tag.
+static void tokenize_tag_indexed(const char *buffer, int start, int end, const int *positions, int count, struct xml_handler *handler) {
+	int last = end - 1;
 	
-	struct tag tag = tag_create(identifier, attribute_list);
-	return tag;
-}
-
-enum tag_types identify_tag(struct string line) {
-	enum tag_types tag_type = tag_type_opening;
+	// An '=' or a quote within the identifier makes it part of the identifier.
+	bool is_indexed = (count <= TAG_STRUCTURAL_CAPACITY) && (count % 3 == 0);
+	if (is_indexed && (count > 0) && (buffer[start] != '/')) {
+		is_indexed = positions[0] >= identifier_end(buffer, start + (buffer[start] == '?'), last);
+	}
 	
-	bool found_less_than = false;
-	int found_less_than_at = 0;
+	if (!is_indexed) {
+		tokenize_tag(buffer, start, end, handler);
+		return;
+	}
 	
-	for (int i = 0; i < string_length(&line); i++) { // searching for '</'
-		char c = string_at(&line, i);
+	for (int k = 0; k < count; k += 3) {
+		int equals = positions[k];
+		int opening = positions[k + 1];
+		bool is_attribute = (buffer[equals] == '=') && (buffer[opening] != '=') && (buffer[positions[k + 2]] == buffer[opening]);
 		
-		if (c == '<') {
-			found_less_than = true;
-			found_less_than_at = i;
+		for (int i = equals + 1; is_attribute && (i < opening); i++) {
+			if (!is_whitespace(buffer[i])) is_attribute = false;
 		}
-		if (c == '/') {
-			if (found_less_than_at == (i-1)) { // is less than index 1 before?
-				tag_type = tag_type_closing;
-				break;
-			}
+		
+		if (!is_attribute) {
+			tokenize_tag(buffer, start, end, handler);
+			return;
 		}
 	}
 	
-	return tag_type;
+	enum tag_types tag_type;
+	struct string_view identifier;
+	int i = tokenize_identifier(buffer, start, last, handler, &tag_type, &identifier);
+	if (i < 0) return;
+	
+	for (int k = 0; k < count; k += 3) {
+		int name_end = positions[k];
+		while ((name_end > i) && is_whitespace(buffer[name_end - 1])) name_end--;
+		
+		int name_start = name_end;
+		while ((name_start > i) && !is_whitespace(buffer[name_start - 1])) name_start--;
+		while ((name_start < name_end) && ((buffer[name_start] == '/') || (buffer[name_start] == '?'))) name_start++;
+		
+		int value_start = positions[k + 1] + 1;
+		int value_end = positions[k + 2];
+		i = value_end + 1;
+		
+		if (handler->on_attribute != NULL) {
+			struct string_view name = string_view_create(buffer + name_start, name_end - name_start);
+			struct string_view value = string_view_create(buffer + value_start, value_end - value_start);
+			handler->on_attribute(handler->user_data, attribute_type_from_name(name), name, value);
+		}
+	}
+	
+	tokenize_tag_end(buffer, start, last, handler, tag_type, identifier);
 }
 
-struct tag_list parse_file(char *filepath) {
-	FILE *f;
-	f = fopen(filepath, "r");
-	
-	struct tag_list tag_list = tag_list_create();
+////////////////////////////////////////////////////////////////////////////////
+// Procedures
+////////////////////////////////////////////////////////////////////////////////
+// Raises the events of every complete tag and returns where the first tag
+// cut short by the end of the buffer starts, or `length` when none is.
+int parse_buffer_stream_partial(const char *buffer, int length, struct xml_handler *handler) {
+	assert(buffer != NULL || length == 0);
+	assert(handler != NULL);
 	
-	struct string line = string_create("");
+	struct structural_scanner scanner = structural_scanner_create(buffer, length);
+	int positions[TAG_STRUCTURAL_CAPACITY];
 	
-	bool line_ended = false;
-	while (!feof(f)) {
-		char c = getc(f);
+	for (;;) {
+		int less_than = structural_scanner_next(&scanner);
+		if (less_than < 0) break;
+		if (buffer[less_than] != '<') continue; // in text
 		
-		if (!line_ended) {
-			if ((c == '\r') || (c == '\n')) {
-				line_ended = true;
+		int i = less_than + 1;
+		if (i >= length) return less_than;
+		
+		if (buffer[i] == '!') { // comments and declarations
+			int end;
+			if ((i + 2 < length) && (buffer[i + 1] == '-') && (buffer[i + 2] == '-')) {
+				end = skip_comment(buffer, length, i + 3);
 			} else {
-				string_append_char(&line, c);
+				end = skip_tag(buffer, length, i);
 			}
-		} else {
-			if ((c != '\r') && (c != '\n')) {
-				line_ended = false;
-				
-				if (identify_tag(line) == tag_type_opening) {
-					struct tag tag = parse_tag(line);
-					tag_list_append(&tag_list, tag);
-				}
-				
-				line = string_create("");
-				if (c != ' ') {
-					string_append_char(&line, c);
-				}
+			
+			if (end < 0) return less_than;
+			structural_scanner_seek(&scanner, end);
+			continue;
+		}
+		
+		// Up to the '>' outside quotes, keeping the '=' and quotes on the way.
+		int count = 0;
+		int end = -1;
+		char quote = '\0';
+		for (;;) {
+			int position = structural_scanner_next(&scanner);
+			if (position < 0) break;
+			
+			char c = buffer[position];
+			if (quote != '\0') {
+				if (c != quote) continue;
+				quote = '\0';
+			} else if (c == '>') {
+				end = position + 1;
+				break;
+			} else if ((c == '"') || (c == '\'')) {
+				quote = c;
+			} else if (c == '<') {
+				continue;
 			}
+			
+			if (count < TAG_STRUCTURAL_CAPACITY) positions[count] = position;
+			count++;
+		}
+		
+		if (end < 0) return less_than;
+		tokenize_tag_indexed(buffer, i, end, positions, count, handler);
+	}
+	
+	return length;
+}
+
+// A truncated last tag is dropped.
+void parse_buffer_stream(const char *buffer, int length, struct xml_handler *handler) {
+	parse_buffer_stream_partial(buffer, length, handler);
+}
+
+// Returns the index of the next '<' at or after `i` that is followed by
+// `next`, or -1. Comments are skipped. The SSE2 path tests 16 positions at a
+// time for '<' followed by `next` or '!'.
+static int find_markup(const char *buffer, int length, int i, char next) {
+	while (i + 1 < length) {
+		int found = -1;
+
+#ifdef __SSE2__
+		__m128i less_than = _mm_set1_epi8('<');
+		__m128i wanted = _mm_set1_epi8(next);
+		__m128i bang = _mm_set1_epi8('!');
+		for (; i + 17 <= length; i += 16) {
+			__m128i current = _mm_loadu_si128((const __m128i *)(buffer + i));
+			__m128i following = _mm_loadu_si128((const __m128i *)(buffer + i + 1));
+			__m128i is_next = _mm_or_si128(_mm_cmpeq_epi8(following, wanted), _mm_cmpeq_epi8(following, bang));
+			int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(current, less_than), is_next));
+			if (mask != 0) {
+				found = i + __builtin_ctz(mask);
+				break;
+			}
+		}
+#endif
+
+		while ((found < 0) && (i + 1 < length)) {
+			const char *less_than_at = memchr(buffer + i, '<', length - 1 - i);
+			if (less_than_at == NULL) return -1;
+			
+			i = less_than_at - buffer;
+			if ((buffer[i + 1] == next) || (buffer[i + 1] == '!')) found = i;
+			else i++;
+		}
+		
+		if (found < 0) return -1;
+		if (buffer[found + 1] == next) return found;
+		
+		if ((found + 3 < length) && (buffer[found + 2] == '-') && (buffer[found + 3] == '-')) {
+			i = skip_comment(buffer, length, found + 4);
+			if (i < 0) return -1;
+		} else {
+			i = found + 2; // a declaration
 		}
 	}
 	
-	string_destroy(&line);
+	return -1;
+}
+
+static bool is_identifier_at(const char *buffer, int length, int i, const char *identifier, int identifier_length) {
+	if (i + identifier_length >= length) return false;
+	if (memcmp(buffer + i, identifier, identifier_length) != 0) return false;
 	
-	fclose(f);
+	char c = buffer[i + identifier_length];
+	return is_whitespace(c) || (c == '>') || (c == '/');
+}
+
+// Finds the next element named `identifier` at or after `from`. On success
+// buffer[*start] is its '<' and *end is just past its closing tag. Elements of
+// that name must not nest. '<' may not appear in attribute values, so only
+// comments can hide a match. Returns false when there is none, or when the
+// buffer ends inside the element.
+bool find_element(const char *buffer, int length, int from, const char *identifier, int *start, int *end) {
+	assert(buffer != NULL || length == 0);
+	assert(identifier != NULL && identifier[0] != '\0');
+	assert(start != NULL && end != NULL);
+	
+	int identifier_length = (int)strlen(identifier);
+	
+	int i = from;
+	for (;;) {
+		i = find_markup(buffer, length, i, identifier[0]);
+		if (i < 0) return false;
+		if (is_identifier_at(buffer, length, i + 1, identifier, identifier_length)) break;
+		i++;
+	}
+	
+	int open_end = skip_tag(buffer, length, i + 1);
+	if (open_end < 0) return false;
+	*start = i;
+	
+	if (buffer[open_end - 2] == '/') { // self-closing
+		*end = open_end;
+		return true;
+	}
+	
+	i = open_end;
+	for (;;) {
+		i = find_markup(buffer, length, i, '/');
+		if (i < 0) return false;
+		if (is_identifier_at(buffer, length, i + 2, identifier, identifier_length)) break;
+		i++;
+	}
+	
+	int close_end = skip_tag(buffer, length, i + 1);
+	if (close_end < 0) return false;
+	*end = close_end;
+	return true;
+}
+
+bool parse_file_stream(char *filepath, struct xml_handler *handler) {
+	struct mapped_file mapped_file = mapped_file_open(filepath);
+	if (!mapped_file.is_open) return false;
+	
+	parse_buffer_stream(mapped_file.data, mapped_file.length, handler);
+	
+	mapped_file_close(&mapped_file);
+	return true;
+}
+
+// The list being filled by parse_buffer, and how many tags are open.
+struct tag_list_builder {
+	struct tag_list *tag_list;
+	int depth;
+};
+
+static void tag_list_on_open_tag(void *user_data, enum tag_types tag_type, struct string_view identifier) {
+	struct tag_list_builder *builder = user_data;
+	
+	struct tag tag = tag_create(identifier_create(identifier, tag_type), attribute_list_create(builder->tag_list->arena));
+	tag.depth = builder->depth++;
+	tag_list_append(builder->tag_list, tag);
+}
+
+static void tag_list_on_attribute(void *user_data, enum attribute_types attribute_type, struct string_view name, struct string_view value) {
+	struct tag_list_builder *builder = user_data;
+	
+	struct tag *tag = tag_list_top(builder->tag_list);
+	attribute_list_append(&tag->attributes, attribute_create(value_create(value), name_create(name, attribute_type)));
+}
+
+static void tag_list_on_close_tag(void *user_data, enum tag_types tag_type, struct string_view identifier) {
+	struct tag_list_builder *builder = user_data;
+	(void)tag_type;
+	(void)identifier;
+	
+	if (builder->depth > 0) builder->depth--;
+}
+
+// The returned tags view into `buffer`, which must outlive the tag list.
+// Closing tags carry no data and are not kept; each tag's depth tells where
+// it sits instead.
+struct tag_list parse_buffer(const char *buffer, int length, struct arena *arena) {
+	struct tag_list tag_list = tag_list_create(arena);
+	struct tag_list_builder builder = { &tag_list, 0 };
+	
+	struct xml_handler handler;
+	handler.user_data = &builder;
+	handler.on_open_tag = tag_list_on_open_tag;
+	handler.on_attribute = tag_list_on_attribute;
+	handler.on_open_tag_end = NULL;
+	handler.on_close_tag = tag_list_on_close_tag;
+	
+	parse_buffer_stream(buffer, length, &handler);
 	
 	return tag_list;
 }
+
+struct tag_list parse_file(char *filepath, struct arena *arena) {
+	struct mapped_file mapped_file = mapped_file_open(filepath);
+	assert(mapped_file.is_open);
+	
+	struct tag_list tag_list = parse_buffer(mapped_file.data, mapped_file.length, arena);
+	tag_list.source = mapped_file;
+	
+	return tag_list;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Push parser
+////////////////////////////////////////////////////////////////////////////////
+struct xml_push_parser xml_push_parser_create(void) {
+	struct xml_push_parser parser;
+	parser.carry = NULL;
+	parser.carry_length = 0;
+	parser.carry_capacity = 0;
+	parser.bytes_fed = 0;
+	return parser;
+}
+
+void xml_push_parser_destroy(struct xml_push_parser *parser) {
+	assert(parser != NULL);
+	
+	free(parser->carry);
+	parser->carry = NULL;
+	parser->carry_length = 0;
+	parser->carry_capacity = 0;
+}
+
+static void xml_push_parser_carry(struct xml_push_parser *parser, const char *data, int length) {
+	if (parser->carry_length + length > parser->carry_capacity) {
+		int capacity = (parser->carry_capacity == 0) ? 256 : parser->carry_capacity;
+		while (capacity < parser->carry_length + length) capacity *= 2;
+		
+		parser->carry = realloc(parser->carry, capacity);
+		assert(parser->carry != NULL);
+		parser->carry_capacity = capacity;
+	}
+	
+	memcpy(parser->carry + parser->carry_length, data, length);
+	parser->carry_length += length;
+}
+
+// Tokenizes the carry and keeps only what is still cut short.
+static void xml_push_parser_drain(struct xml_push_parser *parser, struct xml_handler *handler) {
+	int consumed = parse_buffer_stream_partial(parser->carry, parser->carry_length, handler);
+	
+	parser->carry_length -= consumed;
+	memmove(parser->carry, parser->carry + consumed, parser->carry_length);
+}
+
+// Raises the events of every tag completed by `data`. Without a carry the
+// chunk is tokenized where it lies. A carried tag is completed one '>' at a
+// time, since the first '>' may be inside a quoted value or a comment, and
+// then the rest of the chunk is tokenized in place again.
+void xml_push_parser_feed(struct xml_push_parser *parser, const char *data, int length, struct xml_handler *handler) {
+	assert(parser != NULL);
+	assert((data != NULL) || (length == 0));
+	assert(handler != NULL);
+	
+	parser->bytes_fed += length;
+	
+	int i = 0;
+	while ((parser->carry_length > 0) && (i < length)) {
+		const char *greater_than = memchr(data + i, '>', length - i);
+		int end = (greater_than != NULL) ? (int)(greater_than - data) + 1 : length;
+		
+		xml_push_parser_carry(parser, data + i, end - i);
+		i = end;
+		
+		if (greater_than != NULL) xml_push_parser_drain(parser, handler);
+	}
+	
+	if (i == length) return;
+	
+	int consumed = i + parse_buffer_stream_partial(data + i, length - i, handler);
+	if (consumed < length) xml_push_parser_carry(parser, data + consumed, length - consumed);
+}
+
+// Ends the input. Returns false when it stopped inside a tag, which is then
+// dropped like a truncated tag at the end of a buffer.
+bool xml_push_parser_finish(struct xml_push_parser *parser) {
+	assert(parser != NULL);
+	
+	bool complete = parser->carry_length == 0;
+	parser->carry_length = 0;
+	return complete;
+}
\ No newline at end of file
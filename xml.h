@@ -1,9 +1,12 @@
 #pragma once
 
+#include "arena.h"
+#include "array.h"
 #include "string.h"
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -12,24 +15,85 @@
 // 								XML
 ////////////////////////////////////////////////////////////////////////////////
 
+////////////////////////////////////////////////////////////////////////////////
+// Mapped file
+////////////////////////////////////////////////////////////////////////////////
+struct mapped_file {
+	char *data;
+	int length;
+	bool is_open;
+	bool is_mapped; // false when the contents were read into a heap buffer
+};
+
+struct mapped_file mapped_file_open(const char *filepath);
+void mapped_file_close(struct mapped_file *mapped_file);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Value
 ////////////////////////////////////////////////////////////////////////////////
 struct value {
-	struct string text;
+	struct string_view text;
 };
 
-struct value value_create(struct string text);
+struct value value_create(struct string_view text);
 void value_destroy(struct value *value);
 
+////////////////////////////////////////////////////////////////////////////////
+// Attribute type
+////////////////////////////////////////////////////////////////////////////////
+// Attribute names of the SCML vocabulary, interned like tag identifiers.
+enum attribute_types {
+	attribute_type_unknown,
+	attribute_type_id,
+	attribute_type_name,
+	attribute_type_width,
+	attribute_type_height,
+	attribute_type_pivot_x,
+	attribute_type_pivot_y,
+	attribute_type_timeline,
+	attribute_type_key,
+	attribute_type_z_index,
+	attribute_type_parent,
+	attribute_type_time,
+	attribute_type_spin,
+	attribute_type_folder,
+	attribute_type_file,
+	attribute_type_x,
+	attribute_type_y,
+	attribute_type_angle,
+	attribute_type_scale_x,
+	attribute_type_scale_y,
+	attribute_type_a,
+	attribute_type_length,
+	attribute_type_interval,
+	attribute_type_looping,
+	attribute_type_object_type,
+	attribute_type_scml_version,
+	attribute_type_generator,
+	attribute_type_generator_version,
+	attribute_type_version,
+	attribute_type_encoding,
+	attribute_type_curve_type,
+	attribute_type_c1,
+	attribute_type_c2,
+	attribute_type_c3,
+	attribute_type_c4,
+	attribute_type_w,
+	attribute_type_h,
+	attribute_type_count
+};
+
+enum attribute_types attribute_type_from_name(struct string_view name);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Name
 ////////////////////////////////////////////////////////////////////////////////
 struct name {
-	struct string text;
+	struct string_view text;
+	enum attribute_types type;
 };
 
-struct name name_create(struct string text);
+struct name name_create(struct string_view text, enum attribute_types type);
 void name_destroy(struct name *name);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -49,25 +113,71 @@ void attribute_reset(struct attribute *attr);
 ////////////////////////////////////////////////////////////////////////////////
 struct attribute_list {
 	int length;
+	int capacity;
 	struct attribute *items;
+	struct arena *arena;
 };
 
-struct attribute_list attribute_list_create();
+struct attribute_list attribute_list_create(struct arena *arena);
 void attribute_list_destroy(struct attribute_list *attr_list);
 void attribute_list_append(struct attribute_list *attr_list, struct attribute attr);
+void attribute_list_reserve(struct attribute_list *attr_list, int capacity);
+void attribute_list_shrink_to_fit(struct attribute_list *attr_list);
 struct attribute attribute_list_find_by_name(struct attribute_list *attr_list, const char *name);
 bool attribute_list_contains_name(struct attribute_list *attr_list, const char *name);
 int attribute_list_length(struct attribute_list *attribute_list);
 struct attribute attribute_list_at(struct attribute_list *attribute_list, int index);
 
+////////////////////////////////////////////////////////////////////////////////
+// Tag type
+////////////////////////////////////////////////////////////////////////////////
+// The SCML vocabulary. Identifiers are interned to one of these while they are
+// tokenized; anything outside the vocabulary is tag_type_unknown.
+enum tag_types {
+	tag_type_unknown,
+	tag_type_xml,
+	tag_type_spriter_data,
+	tag_type_folder,
+	tag_type_file,
+	tag_type_atlas,
+	tag_type_entity,
+	tag_type_obj_info,
+	tag_type_frames,
+	tag_type_i,
+	tag_type_character_map,
+	tag_type_map,
+	tag_type_tag_list,
+	tag_type_var_defs,
+	tag_type_animation,
+	tag_type_mainline,
+	tag_type_key,
+	tag_type_object_ref,
+	tag_type_bone_ref,
+	tag_type_timeline,
+	tag_type_object,
+	tag_type_bone,
+	tag_type_eventline,
+	tag_type_soundline,
+	tag_type_meta,
+	tag_type_varline,
+	tag_type_tagline,
+	tag_type_valline,
+	tag_type_tag,
+	tag_type_count
+};
+
+enum tag_types tag_type_from_identifier(struct string_view identifier);
+const char *tag_type_name(enum tag_types tag_type);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Identifier
 ////////////////////////////////////////////////////////////////////////////////
 struct identifier {
-	struct string text;
+	struct string_view text;
+	enum tag_types type;
 };
 
-struct identifier identifier_create(struct string text);
+struct identifier identifier_create(struct string_view text, enum tag_types type);
 void identifier_destroy(struct identifier *identifier);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -76,6 +186,7 @@ void identifier_destroy(struct identifier *identifier);
 struct tag {
 	struct identifier identifier;
 	struct attribute_list attributes;
+	int depth; // how many tags enclose it
 };
 
 struct tag tag_create(struct identifier identifier, struct attribute_list attributes);
@@ -86,25 +197,64 @@ void tag_destroy(struct tag *tag);
 ////////////////////////////////////////////////////////////////////////////////
 struct tag_list {
 	int length;
+	int capacity;
 	struct tag *items;
+	struct arena *arena;
+	struct mapped_file source; // backs every string view in the list when loaded by parse_file
 };
 
-struct tag_list tag_list_create();
+struct tag_list tag_list_create(struct arena *arena);
 void tag_list_destroy(struct tag_list *tag_list);
 void tag_list_append(struct tag_list *tag_list, struct tag tag);
+void tag_list_reserve(struct tag_list *tag_list, int capacity);
+void tag_list_shrink_to_fit(struct tag_list *tag_list);
 struct tag* tag_list_top(struct tag_list *tag_list);
 int tag_list_length(struct tag_list *tag_list);
 struct tag tag_list_at(struct tag_list *tag_list, int index);
 
 ////////////////////////////////////////////////////////////////////////////////
-// Procedures
+// Handler
 ////////////////////////////////////////////////////////////////////////////////
-struct attribute_list parse_attributes(struct string line);
-struct identifier parse_identifier(struct string line);
-struct tag parse_tag(struct string line);
-enum tag_types {
-	tag_type_opening,
-	tag_type_closing
+// Events raised while a buffer is tokenized. Each open tag is followed by its
+// attributes and then on_open_tag_end; self-closing tags and declarations also
+// get on_close_tag. Views point into the buffer being parsed. Any callback
+// may be NULL.
+struct xml_handler {
+	void *user_data;
+	void (*on_open_tag)(void *user_data, enum tag_types tag_type, struct string_view identifier);
+	void (*on_attribute)(void *user_data, enum attribute_types attribute_type, struct string_view name, struct string_view value);
+	void (*on_open_tag_end)(void *user_data);
+	void (*on_close_tag)(void *user_data, enum tag_types tag_type, struct string_view identifier);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Push parser
+////////////////////////////////////////////////////////////////////////////////
+// Tokenizes input that arrives in chunks of any size, from an archive or a
+// decompressor. Tags are tokenized in the chunk they arrive in; only a tag cut
+// by the end of a chunk is copied, to the carry, until the chunks that
+// complete it arrive. The carry grows to the largest such tag, not to the
+// file. Views passed to the handler stay valid only until the tag's last
+// event, so handlers that keep them, like parse_buffer's, cannot be used.
+struct xml_push_parser {
+	char *carry;
+	int carry_length;
+	int carry_capacity;
+	long bytes_fed;
 };
-enum tag_types identify_tag(struct string line);
-struct tag_list parse_file(char *filepath);
\ No newline at end of file
+
+struct xml_push_parser xml_push_parser_create(void);
+void xml_push_parser_destroy(struct xml_push_parser *parser);
+void xml_push_parser_feed(struct xml_push_parser *parser, const char *data, int length, struct xml_handler *handler);
+bool xml_push_parser_finish(struct xml_push_parser *parser);
+
+////////////////////////////////////////////////////////////////////////////////
+// Procedures
+////////////////////////////////////////////////////////////////////////////////
+void parse_buffer_stream(const char *buffer, int length, struct xml_handler *handler);
+int parse_buffer_stream_partial(const char *buffer, int length, struct xml_handler *handler);
+bool parse_file_stream(char *filepath, struct xml_handler *handler);
+const char *structural_kernel_name(void);
+bool find_element(const char *buffer, int length, int from, const char *identifier, int *start, int *end);
+struct tag_list parse_buffer(const char *buffer, int length, struct arena *arena);
+struct tag_list parse_file(char *filepath, struct arena *arena);
\ No newline at end of file